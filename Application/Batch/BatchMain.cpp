@@ -0,0 +1,143 @@
+// Headless entry point: evaluates a .nom file and exports the merged scene, no Qt involved
+
+#include <Parsing/SourceManager.h>
+#include <Scene/ASTSceneAdapter.h>
+#include <Scene/Environment.h>
+#include <Scene/MeshExporter.h>
+#include <Scene/MeshMerger.h>
+#include <Scene/Scene.h>
+#include <Scene/SceneCache.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Nome;
+
+static void PrintUsage(const char* program)
+{
+    printf("Usage: %s <file.nom> -o <output.obj|.ply|.stl> [-s bank.slider=value]... [--cache]\n",
+           program);
+    printf("  -o, --output   Where to write the merged world space mesh\n");
+    printf("  -s, --set      Override a bank slider before the scene is evaluated\n");
+    printf("      --cache    Read and write <file.nom>.nomcache next to the input\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::string inputPath;
+    std::string outputPath;
+    std::vector<std::pair<std::string, float>> sliderValues;
+    bool bUseCache = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else if ((arg == "-s" || arg == "--set") && i + 1 < argc)
+        {
+            std::string assignment = argv[++i];
+            auto eq = assignment.find('=');
+            char* end = nullptr;
+            float value = eq == std::string::npos
+                ? 0.0f
+                : std::strtof(assignment.c_str() + eq + 1, &end);
+            if (eq == std::string::npos || end == assignment.c_str() + eq + 1 || *end != '\0')
+            {
+                fprintf(stderr, "Malformed slider assignment %s\n", assignment.c_str());
+                return 1;
+            }
+            sliderValues.emplace_back(assignment.substr(0, eq), value);
+        }
+        else if (arg == "--cache")
+            bUseCache = true;
+        else if (arg == "-h" || arg == "--help")
+        {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+        else if (inputPath.empty() && arg[0] != '-')
+            inputPath = arg;
+        else
+        {
+            fprintf(stderr, "Unexpected argument %s\n", arg.c_str());
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (inputPath.empty() || outputPath.empty())
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    CSourceManager sourceMgr(inputPath);
+    sourceMgr.SetUseCache(bUseCache);
+    if (!sourceMgr.ParseMainSource())
+    {
+        fprintf(stderr, "Failed to parse %s\n", inputPath.c_str());
+        return 1;
+    }
+
+    tc::TAutoPtr<Scene::CScene> scene = new Scene::CScene();
+    Scene::GEnv.Scene = scene.Get();
+    try
+    {
+        Scene::CASTSceneAdapter adapter;
+        adapter.TraverseFile(sourceMgr.GetASTContext().GetAstRoot(), *scene);
+    }
+    catch (const AST::CSemanticError& e)
+    {
+        fprintf(stderr, "Error encountered during scene generation:\n%s\n", e.what());
+        return 1;
+    }
+    // Before the overrides, which dirty whatever depends on them again
+    if (sourceMgr.WasLoadedFromCache())
+        printf("Restored %zu meshes from the cache\n",
+               Scene::CSceneCache::RestoreMeshes(sourceMgr, *scene));
+    else if (bUseCache)
+    {
+        // The cache holds the file as written, so that overrides of one run never leak into the
+        //  next. Only what the overrides dirty gets generated a second time below.
+        scene->Update();
+        Scene::CSceneCache::Save(sourceMgr, *scene);
+    }
+
+    for (const auto& [name, value] : sliderValues)
+    {
+        auto* slider = scene->GetBankAndSet().GetSlider(name);
+        if (!slider)
+        {
+            fprintf(stderr, "No slider named %s\n", name.c_str());
+            return 1;
+        }
+        if (value < slider->GetMin() || value > slider->GetMax())
+            printf("Warning: %s=%g is outside of [%g, %g]\n", name.c_str(), value,
+                   slider->GetMin(), slider->GetMax());
+        slider->SetValue(value);
+    }
+
+    scene->Update();
+
+    // Same as the Merge action of the main window
+    tc::TAutoPtr<Scene::CMeshMerger> merger = new Scene::CMeshMerger("globalMerge");
+    scene->ForEachSceneTreeNode([&](Scene::CSceneTreeNode* node) {
+        auto* entity = node->GetInstanceEntity();
+        if (!entity)
+            entity = node->GetOwner()->GetEntity();
+        if (auto* mesh = dynamic_cast<Scene::CMeshInstance*>(entity))
+            merger->MergeIn(*mesh);
+    });
+
+    if (!Scene::CMeshExporter::Export(merger->GetMeshImpl(), outputPath))
+    {
+        fprintf(stderr, "Could not write %s\n", outputPath.c_str());
+        return 1;
+    }
+    printf("Wrote %zu vertices and %zu faces to %s\n", merger->GetMeshImpl().n_vertices(),
+           merger->GetMeshImpl().n_faces(), outputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,371 @@
+// Loads .nom files through every stage of the pipeline and writes per-stage timings as JSON
+
+#include <Parsing/SourceManager.h>
+#include <Qt3DCore/QNode>
+#include <QtFrontend/MeshToQGeometry.h>
+#include <Scene/ASTSceneAdapter.h>
+#include <Scene/EntityUpdateGraph.h>
+#include <Scene/Environment.h>
+#include <Scene/Mesh.h>
+#include <Scene/Scene.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Nome;
+namespace fs = std::filesystem;
+
+// Every allocation of the process goes through here, worker threads included
+static std::atomic<uint64_t> GAllocCount { 0 };
+static std::atomic<uint64_t> GAllocBytes { 0 };
+
+void* operator new(std::size_t size)
+{
+    GAllocCount.fetch_add(1, std::memory_order_relaxed);
+    GAllocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+
+struct FStageResult
+{
+    std::string Name;
+    double Seconds;
+    uint64_t Allocs;
+    uint64_t Bytes;
+};
+
+class CStageTimer
+{
+public:
+    void Begin(const char* name)
+    {
+        Name = name;
+        StartAllocs = GAllocCount.load();
+        StartBytes = GAllocBytes.load();
+        Start = std::chrono::steady_clock::now();
+    }
+
+    void End()
+    {
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start);
+        Results.push_back({ Name, elapsed.count(), GAllocCount.load() - StartAllocs,
+                            GAllocBytes.load() - StartBytes });
+    }
+
+    std::vector<FStageResult> Results;
+
+private:
+    std::string Name;
+    uint64_t StartAllocs = 0;
+    uint64_t StartBytes = 0;
+    std::chrono::steady_clock::time_point Start;
+};
+
+struct FFileResult
+{
+    std::string Name;
+    bool bSucceeded = true;
+    std::string Error;
+    size_t NumInstances = 0;
+    size_t NumVertices = 0;
+    size_t NumFaces = 0;
+    // Best run of each stage
+    std::vector<FStageResult> Stages;
+};
+
+// Runs one file through parsing, AST building, scene adaptation, entity updates, instancing and
+//  geometry conversion
+bool RunOnce(const std::string& path, FFileResult& result, std::vector<FStageResult>& stages)
+{
+    CStageTimer timer;
+    CSourceManager sourceMgr(path);
+    sourceMgr.SetPrintAST(false);
+    sourceMgr.SetStageCallback([&timer](const char* stage) {
+        std::string name = stage;
+        if (name == "parse")
+            timer.Begin("parse");
+        else if (name == "build")
+        {
+            timer.End();
+            timer.Begin("ast_build");
+        }
+        else
+            timer.End();
+    });
+    if (!sourceMgr.ParseMainSource())
+    {
+        result.Error = "parse error";
+        return false;
+    }
+
+    tc::TAutoPtr<Scene::CScene> scene = new Scene::CScene();
+    Scene::GEnv.Scene = scene.Get();
+    timer.Begin("scene_adapt");
+    try
+    {
+        Scene::CASTSceneAdapter adapter;
+        adapter.TraverseFile(sourceMgr.GetASTContext().GetAstRoot(), *scene);
+    }
+    catch (const AST::CSemanticError& e)
+    {
+        result.Error = e.what();
+        return false;
+    }
+    timer.End();
+
+    // CScene::Update regenerates the generators and then copies them into their instances. Doing
+    //  the generators first, through the same update graph, lets the two halves be told apart.
+    timer.Begin("scene_update");
+    Scene::CEntityUpdateGraph generators;
+    scene->ForEachSceneTreeNode([&](Scene::CSceneTreeNode* node) {
+        if (auto* entity = node->GetOwner()->GetEntity())
+            generators.AddEntity(entity);
+    });
+    generators.Run(tc::FThreadPool::Get());
+    timer.End();
+
+    timer.Begin("instancing");
+    scene->Update();
+    timer.End();
+
+    std::vector<Scene::CMeshInstance*> instances;
+    scene->ForEachSceneTreeNode([&](Scene::CSceneTreeNode* node) {
+        if (auto* mesh = dynamic_cast<Scene::CMeshInstance*>(node->GetInstanceEntity()))
+            instances.push_back(mesh);
+    });
+    result.NumInstances = instances.size();
+    result.NumVertices = result.NumFaces = 0;
+    for (auto* instance : instances)
+    {
+        result.NumVertices += instance->GetMeshImpl().n_vertices();
+        result.NumFaces += instance->GetMeshImpl().n_faces();
+    }
+
+    timer.Begin("qgeometry");
+    for (auto* instance : instances)
+    {
+        // Parented like the viewer does it, the owner deletes them after the converter is gone
+        Qt3DCore::QNode owner;
+        CMeshToQGeometry converter(instance->GetMeshImpl(), true);
+        converter.GetGeometry()->setParent(&owner);
+        converter.GetPointGeometry()->setParent(&owner);
+    }
+    timer.End();
+
+    stages = std::move(timer.Results);
+    return true;
+}
+
+FFileResult RunFile(const std::string& name, const std::string& path, int runs)
+{
+    FFileResult result;
+    result.Name = name;
+    for (int run = 0; run < runs; run++)
+    {
+        std::vector<FStageResult> stages;
+        if (!RunOnce(path, result, stages))
+        {
+            result.bSucceeded = false;
+            result.Stages.clear();
+            break;
+        }
+        if (result.Stages.empty())
+            result.Stages = std::move(stages);
+        else
+            for (size_t i = 0; i < stages.size() && i < result.Stages.size(); i++)
+                if (stages[i].Seconds < result.Stages[i].Seconds)
+                    result.Stages[i] = stages[i];
+    }
+    return result;
+}
+
+// Scaled up inputs that the examples are too small to stress, scale 1 is roughly a second total
+std::vector<std::pair<std::string, std::string>> MakeSyntheticSources(int scale)
+{
+    std::vector<std::pair<std::string, std::string>> sources;
+
+    // One dense generator, mostly generation and conversion
+    {
+        int segs = 256 * scale;
+        std::ostringstream ss;
+        ss << "torus dense (10 2 360 0 360 " << segs << " " << segs << ") endtorus\n";
+        ss << "instance dense1 dense endinstance\n";
+        sources.emplace_back("synthetic_dense_torus", ss.str());
+    }
+    // Many instances of a small generator, mostly adaptation and instancing
+    {
+        int side = 10 * scale;
+        std::ostringstream ss;
+        ss << "torus small (1 0.25 360 0 360 32 16) endtorus\n";
+        for (int i = 0; i < side; i++)
+            for (int j = 0; j < side; j++)
+                ss << "instance small" << i << "_" << j << " small translate (" << i * 3 << " "
+                   << j * 3 << " 0) endinstance\n";
+        sources.emplace_back("synthetic_many_instances", ss.str());
+    }
+    // A large hand written mesh, mostly parsing and AST building
+    {
+        int side = 100 * scale;
+        std::ostringstream ss;
+        for (int i = 0; i < side; i++)
+            for (int j = 0; j < side; j++)
+                ss << "point p" << i << "_" << j << " (" << i << " " << j << " 0) endpoint\n";
+        ss << "mesh sheet\n";
+        for (int i = 0; i + 1 < side; i++)
+            for (int j = 0; j + 1 < side; j++)
+                ss << "    face f" << i << "_" << j << " (p" << i << "_" << j << " p" << i + 1
+                   << "_" << j << " p" << i + 1 << "_" << j + 1 << " p" << i << "_" << j + 1
+                   << ") endface\n";
+        ss << "endmesh\n";
+        ss << "instance sheet1 sheet endinstance\n";
+        sources.emplace_back("synthetic_point_sheet", ss.str());
+    }
+    return sources;
+}
+
+std::string EscapeJson(const std::string& str)
+{
+    std::string result;
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            result += buf;
+        }
+        else
+            result += c;
+    }
+    return result;
+}
+
+void WriteJson(std::ostream& os, const std::vector<FFileResult>& results, int runs)
+{
+    os << "{\n  \"runs\": " << runs << ",\n  \"files\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& file = results[i];
+        os << "    {\n      \"name\": \"" << EscapeJson(file.Name) << "\",\n";
+        os << "      \"succeeded\": " << (file.bSucceeded ? "true" : "false") << ",\n";
+        if (!file.bSucceeded)
+            os << "      \"error\": \"" << EscapeJson(file.Error) << "\",\n";
+        os << "      \"instances\": " << file.NumInstances << ",\n";
+        os << "      \"vertices\": " << file.NumVertices << ",\n";
+        os << "      \"faces\": " << file.NumFaces << ",\n";
+        os << "      \"stages\": {";
+        for (size_t j = 0; j < file.Stages.size(); j++)
+        {
+            const auto& stage = file.Stages[j];
+            char buf[64];
+            snprintf(buf, sizeof(buf), "%.6f", stage.Seconds);
+            os << (j ? ",\n" : "\n") << "        \"" << stage.Name << "\": { \"seconds\": " << buf
+               << ", \"allocs\": " << stage.Allocs << ", \"bytes\": " << stage.Bytes << " }";
+        }
+        os << (file.Stages.empty() ? "}\n" : "\n      }\n");
+        os << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+void PrintUsage(const char* program)
+{
+    printf("Usage: %s [ExampleNOMEFiles dir] [-o results.json] [-n runs] [--scale N]\n", program);
+    printf("  -o, --output   Where to write the JSON results, nome-bench.json by default\n");
+    printf("  -n, --runs     Runs per file, the fastest time of each stage is kept\n");
+    printf("  --scale        Size of the synthetic inputs, 0 skips them\n");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string exampleDir = "ExampleNOMEFiles";
+    std::string outputPath = "nome-bench.json";
+    int runs = 3;
+    int scale = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else if ((arg == "-n" || arg == "--runs") && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--scale" && i + 1 < argc)
+            scale = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help")
+        {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+        else if (arg[0] != '-')
+            exampleDir = arg;
+        else
+        {
+            fprintf(stderr, "Unexpected argument %s\n", arg.c_str());
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(exampleDir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".nom")
+            files.push_back(entry.path());
+    if (ec)
+        fprintf(stderr, "Could not list %s: %s\n", exampleDir.c_str(), ec.message().c_str());
+    std::sort(files.begin(), files.end());
+
+    std::vector<FFileResult> results;
+    for (const auto& file : files)
+    {
+        fprintf(stderr, "%s\n", file.filename().string().c_str());
+        results.push_back(RunFile(file.filename().string(), file.string(), runs));
+    }
+
+    if (scale > 0)
+    {
+        for (const auto& [name, source] : MakeSyntheticSources(scale))
+        {
+            fprintf(stderr, "%s\n", name.c_str());
+            fs::path path = fs::temp_directory_path() / (name + ".nom");
+            std::ofstream(path) << source;
+            results.push_back(RunFile(name, path.string(), runs));
+            fs::remove(path, ec);
+        }
+    }
+
+    std::ofstream ofs(outputPath);
+    if (!ofs)
+    {
+        fprintf(stderr, "Could not write %s\n", outputPath.c_str());
+        return 1;
+    }
+    WriteJson(ofs, results, runs);
+    fprintf(stderr, "Wrote %zu results to %s\n", results.size(), outputPath.c_str());
+    return 0;
+}
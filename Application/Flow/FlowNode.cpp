@@ -3,6 +3,48 @@
 namespace Flow
 {
 
+namespace
+{
+
+struct FDirtyQueueState
+{
+    std::vector<TInlineCallback<>> Pending;
+    bool bDraining = false;
+};
+
+// Entities are updated on several threads, each propagates its own notifications
+thread_local FDirtyQueueState GDirtyQueue;
+
+}
+
+void CDirtyQueue::Push(const TInlineCallback<>& notify) { GDirtyQueue.Pending.push_back(notify); }
+
+void CDirtyQueue::Drain()
+{
+    auto& queue = GDirtyQueue;
+    if (queue.bDraining)
+        return;
+
+    // Keep the queue usable even if a notification throws
+    struct FDrainGuard
+    {
+        FDirtyQueueState& Queue;
+        ~FDrainGuard()
+        {
+            Queue.Pending.clear();
+            Queue.bDraining = false;
+        }
+    } guard { queue };
+
+    queue.bDraining = true;
+    // Notifications append to the queue as they mark their own outputs dirty
+    for (size_t i = 0; i < queue.Pending.size(); i++)
+    {
+        TInlineCallback<> notify = queue.Pending[i];
+        notify();
+    }
+}
+
 void TOutput<void>::MarkDirty()
 {
     // Don't mark dirty if already dirty. Safe to do?
@@ -10,10 +52,9 @@ void TOutput<void>::MarkDirty()
         return;
 
     Dirty = true;
-    for (auto& conn : ConnectedInputs)
-    {
-        conn->NotifyDirty();
-    }
+    for (TInput<void>* input : ConnectedInputs)
+        CDirtyQueue::Push(input->DirtyNotifyRoutine);
+    CDirtyQueue::Drain();
 }
 
 void TOutput<void>::Connect(TInput<void>& input) { input.Connect(*this); }
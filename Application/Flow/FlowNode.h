@@ -1,40 +1,94 @@
 #pragma once
 
+#include "InlineCallback.h"
 #include <AutoPtr.h>
 
-#include <functional>
-#include <unordered_set>
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 namespace Flow
 {
 
+class CFlowNode;
+
+// Type-erased views of the slots, so that the graph can be walked without knowing value types
+class IInputSlot
+{
+public:
+    virtual ~IInputSlot() = default;
+    // The node owning the connected output, or null if unconnected
+    virtual CFlowNode* GetUpstreamNode() const = 0;
+};
+
+class IOutputSlot
+{
+public:
+    virtual ~IOutputSlot() = default;
+    virtual bool IsDirty() const = 0;
+    virtual bool Update() const = 0;
+};
+
 class CFlowNode : public tc::FRefCounted
 {
 public:
     ~CFlowNode() override = default;
+
+    // Inputs and outputs register themselves with their owner on construction
+    const std::vector<IInputSlot*>& GetInputSlots() const { return InputSlots; }
+    const std::vector<IOutputSlot*>& GetOutputSlots() const { return OutputSlots; }
+
+    void RegisterSlot(IInputSlot* slot) { InputSlots.push_back(slot); }
+    void RegisterSlot(IOutputSlot* slot) { OutputSlots.push_back(slot); }
+    void UnregisterSlot(IInputSlot* slot) { EraseSlot(InputSlots, slot); }
+    void UnregisterSlot(IOutputSlot* slot) { EraseSlot(OutputSlots, slot); }
+
+private:
+    template <typename TSlot> static void EraseSlot(std::vector<TSlot*>& slots, TSlot* slot)
+    {
+        // Slots tend to go away in reverse order of creation, e.g. when an input array is cleared
+        auto iter = std::find(slots.rbegin(), slots.rend(), slot);
+        if (iter != slots.rend())
+            slots.erase(std::next(iter).base());
+    }
+
+    std::vector<IInputSlot*> InputSlots;
+    std::vector<IOutputSlot*> OutputSlots;
+};
+
+// Dirty notifications are queued and run in a loop instead of recursing from node to node, so
+//  marking a long chain of expressions dirty is one linear sweep and cannot overflow the stack
+class CDirtyQueue
+{
+public:
+    static void Push(const TInlineCallback<>& notify);
+    // Runs everything queued, unless a call further up the stack is already doing so
+    static void Drain();
 };
 
 // Forward declaration
 template <typename T> class TOutput;
 template <typename T> class TInput;
 
-template <typename T> class TOutput
+template <typename T> class TOutput : public IOutputSlot
 {
 public:
-    TOutput(CFlowNode* owner, std::function<void()> updateRoutine)
+    TOutput(CFlowNode* owner, TInlineCallback<> updateRoutine)
         : Owner(owner)
-        , UpdateRoutine(std::move(updateRoutine))
+        , UpdateRoutine(updateRoutine)
     {
+        Owner->RegisterSlot(this);
     }
 
+    ~TOutput() override { Owner->UnregisterSlot(this); }
+
     // Mark this output dirty, and notify all connected inputs
     void MarkDirty();
 
     // Unmark dirty
     void UnmarkDirty() { Dirty = false; }
 
-    [[nodiscard]] bool IsDirty() const { return Dirty; }
+    [[nodiscard]] bool IsDirty() const override { return Dirty; }
 
     // Set a new value, and unmark dirty
     void UpdateValue(T val)
@@ -53,7 +107,7 @@ public:
     [[nodiscard]] size_t CountConnections() const { return ConnectedInputs.size(); }
 
     // Trigger an update to the value, returns whether the update was successful
-    bool Update() const
+    bool Update() const override
     {
         if (!IsDirty())
             return true;
@@ -68,26 +122,32 @@ public:
 
 private:
     CFlowNode* Owner;
-    std::function<void()> UpdateRoutine;
+    TInlineCallback<> UpdateRoutine;
 
     T Value;
     bool Dirty = true;
 
     // Friend the corresponding input so that they can access our connections
     friend class TInput<T>;
-    std::unordered_set<TInput<T>*> ConnectedInputs;
+    // Unordered, each input remembers its position so that disconnecting is a swap and pop
+    std::vector<TInput<T>*> ConnectedInputs;
 };
 
-template <typename T> class TInput
+template <typename T> class TInput : public IInputSlot
 {
 public:
-    TInput(CFlowNode* owner, std::function<void()> dirtyNotifyRoutine)
+    TInput(CFlowNode* owner, TInlineCallback<> dirtyNotifyRoutine)
         : Owner(owner)
-        , DirtyNotifyRoutine(std::move(dirtyNotifyRoutine))
+        , DirtyNotifyRoutine(dirtyNotifyRoutine)
     {
+        Owner->RegisterSlot(this);
     }
 
-    ~TInput() { Disconnect(); }
+    ~TInput() override
+    {
+        Disconnect();
+        Owner->UnregisterSlot(this);
+    }
 
     void NotifyDirty() { DirtyNotifyRoutine(); }
 
@@ -102,10 +162,8 @@ public:
         Disconnect();
 
         ConnectedOutput = pOut;
-        if (ConnectedOutput)
-        {
-            ConnectedOutput->ConnectedInputs.insert(this);
-        }
+        ConnectionIndex = ConnectedOutput->ConnectedInputs.size();
+        ConnectedOutput->ConnectedInputs.push_back(this);
         ConnectedOutput->Owner->AddRef();
 
         NotifyDirty();
@@ -120,9 +178,10 @@ public:
     {
         if (ConnectedOutput)
         {
-            auto iter = ConnectedOutput->ConnectedInputs.find(this);
-            if (iter != ConnectedOutput->ConnectedInputs.end())
-                ConnectedOutput->ConnectedInputs.erase(iter);
+            auto& inputs = ConnectedOutput->ConnectedInputs;
+            inputs[ConnectionIndex] = inputs.back();
+            inputs[ConnectionIndex]->ConnectionIndex = ConnectionIndex;
+            inputs.pop_back();
             ConnectedOutput->Owner->Release();
         }
         ConnectedOutput = nullptr;
@@ -130,6 +189,11 @@ public:
 
     [[nodiscard]] bool IsConnected() const { return ConnectedOutput; }
 
+    CFlowNode* GetUpstreamNode() const override
+    {
+        return ConnectedOutput ? ConnectedOutput->GetOwner() : nullptr;
+    }
+
     T GetValue(const T& defaultValue) const
     {
         if (ConnectedOutput)
@@ -139,16 +203,15 @@ public:
 
 private:
     CFlowNode* Owner;
-    std::function<void()> DirtyNotifyRoutine;
+    TInlineCallback<> DirtyNotifyRoutine;
 
     TOutput<T>* ConnectedOutput = nullptr;
+    size_t ConnectionIndex = 0;
 
+    friend class TOutput<T>;
     // Only used by InputArray
     template <typename TT> friend class TInputArray;
-    void SetDirtyNotifyRoutine(std::function<void()> routine)
-    {
-        DirtyNotifyRoutine = std::move(routine);
-    }
+    void SetDirtyNotifyRoutine(TInlineCallback<> routine) { DirtyNotifyRoutine = routine; }
 };
 
 template <typename T> void TOutput<T>::MarkDirty()
@@ -158,30 +221,29 @@ template <typename T> void TOutput<T>::MarkDirty()
         return;
 
     Dirty = true;
-    for (auto& conn : ConnectedInputs)
-    {
-        conn->NotifyDirty();
-    }
+    for (TInput<T>* input : ConnectedInputs)
+        CDirtyQueue::Push(input->DirtyNotifyRoutine);
+    CDirtyQueue::Drain();
 }
 
 template <typename T> void TOutput<T>::Connect(TInput<T>& input) { input.Connect(*this); }
 
 template <> class TInput<void>;
 
-template <> class TOutput<void>
+template <> class TOutput<void> : public IOutputSlot
 {
 public:
-    TOutput(CFlowNode* owner, std::function<void()> updateRoutine)
+    TOutput(CFlowNode* owner, TInlineCallback<> updateRoutine)
         : Owner(owner)
-        , UpdateRoutine(std::move(updateRoutine))
+        , UpdateRoutine(updateRoutine)
     {
+        Owner->RegisterSlot(this);
     }
 
+    ~TOutput() override { Owner->UnregisterSlot(this); }
+
     // Workaround for lambda chicken egg problem
-    void SetUpdateRoutine(std::function<void()> updateRoutine)
-    {
-        UpdateRoutine = std::move(updateRoutine);
-    }
+    void SetUpdateRoutine(TInlineCallback<> updateRoutine) { UpdateRoutine = updateRoutine; }
 
     // Mark this output dirty, and notify all connected inputs
     void MarkDirty();
@@ -189,12 +251,12 @@ public:
     // Unmark dirty
     void UnmarkDirty() { Dirty = false; }
 
-    bool IsDirty() const { return Dirty; }
+    bool IsDirty() const override { return Dirty; }
 
     size_t CountConnections() const { return ConnectedInputs.size(); }
 
     // Trigger an update to the value, returns whether the update was successful
-    bool Update() const
+    bool Update() const override
     {
         if (!IsDirty())
             return true;
@@ -205,27 +267,34 @@ public:
 
     void Connect(TInput<void>& input);
 
+    CFlowNode* GetOwner() const { return Owner; }
+
 private:
     CFlowNode* Owner;
-    std::function<void()> UpdateRoutine;
+    TInlineCallback<> UpdateRoutine;
 
     bool Dirty = true;
 
     // Friend the corresponding input so that they can access our connections
     friend class TInput<void>;
-    std::unordered_set<TInput<void>*> ConnectedInputs;
+    std::vector<TInput<void>*> ConnectedInputs;
 };
 
-template <> class TInput<void>
+template <> class TInput<void> : public IInputSlot
 {
 public:
-    TInput(CFlowNode* owner, std::function<void()> dirtyNotifyRoutine)
+    TInput(CFlowNode* owner, TInlineCallback<> dirtyNotifyRoutine)
         : Owner(owner)
-        , DirtyNotifyRoutine(std::move(dirtyNotifyRoutine))
+        , DirtyNotifyRoutine(dirtyNotifyRoutine)
     {
+        Owner->RegisterSlot(this);
     }
 
-    ~TInput() { Disconnect(); }
+    ~TInput() override
+    {
+        Disconnect();
+        Owner->UnregisterSlot(this);
+    }
 
     void NotifyDirty() { DirtyNotifyRoutine(); }
 
@@ -240,7 +309,8 @@ public:
         Disconnect();
 
         ConnectedOutput = pOut;
-        ConnectedOutput->ConnectedInputs.insert(this);
+        ConnectionIndex = ConnectedOutput->ConnectedInputs.size();
+        ConnectedOutput->ConnectedInputs.push_back(this);
         ConnectedOutput->Owner->AddRef();
 
         NotifyDirty();
@@ -250,18 +320,28 @@ public:
     {
         if (ConnectedOutput)
         {
-            auto iter = ConnectedOutput->ConnectedInputs.find(this);
-            if (iter != ConnectedOutput->ConnectedInputs.end())
-                ConnectedOutput->ConnectedInputs.erase(iter);
+            auto& inputs = ConnectedOutput->ConnectedInputs;
+            inputs[ConnectionIndex] = inputs.back();
+            inputs[ConnectionIndex]->ConnectionIndex = ConnectionIndex;
+            inputs.pop_back();
             ConnectedOutput->Owner->Release();
         }
+        ConnectedOutput = nullptr;
+    }
+
+    CFlowNode* GetUpstreamNode() const override
+    {
+        return ConnectedOutput ? ConnectedOutput->GetOwner() : nullptr;
     }
 
 private:
     CFlowNode* Owner;
-    std::function<void()> DirtyNotifyRoutine;
+    TInlineCallback<> DirtyNotifyRoutine;
 
     TOutput<void>* ConnectedOutput = nullptr;
+    size_t ConnectionIndex = 0;
+
+    friend class TOutput<void>;
 };
 
 } /* namespace Flow */
@@ -1,5 +1,7 @@
 #pragma once
 #include "FlowNode.h"
+#include <deque>
+#include <functional>
 #include <vector>
 
 namespace Flow
@@ -8,9 +10,9 @@ namespace Flow
 template <typename T> class TInputArray
 {
 public:
-    TInputArray(CFlowNode* owner, std::function<void(TInput<T>*)> dirtyNotifyRoutine)
+    TInputArray(CFlowNode* owner, TInlineCallback<TInput<T>*> dirtyNotifyRoutine)
         : Owner(owner)
-        , DirtyNotifyRoutine(std::move(dirtyNotifyRoutine))
+        , DirtyNotifyRoutine(dirtyNotifyRoutine)
     {
     }
 
@@ -18,19 +20,16 @@ public:
 
     void Connect(TOutput<T>& output)
     {
-        TInput<T>* input = new TInput<T>(Owner, std::function<void()>());
+        TInput<T>* input = &InputArray.emplace_back(Owner, TInlineCallback<>());
         input->SetDirtyNotifyRoutine([this, input]() { DirtyNotifyRoutine(input); });
         input->Connect(output);
-        InputArray.push_back(input);
     }
 
     void DisconnectAll()
     {
-        for (TInput<T>* input : InputArray)
-        {
-            delete input;
-        }
-        InputArray.clear();
+        // Newest first, the owner finds those at the back of its slot list
+        while (!InputArray.empty())
+            InputArray.pop_back();
     }
 
     bool IsConnected() const { return !InputArray.empty(); }
@@ -40,7 +39,7 @@ public:
     T GetValue(size_t index, const T& defaultValue) const
     {
         if (index < InputArray.size())
-            return InputArray[index]->GetValue(defaultValue);
+            return InputArray[index].GetValue(defaultValue);
         return defaultValue;
     }
 
@@ -48,19 +47,21 @@ public:
     std::vector<U> MapOutput(std::function<U(const TOutput<T>&)> f) const
     {
         std::vector<U> result;
-        for (TInput<T>* input : InputArray)
+        result.reserve(InputArray.size());
+        for (const TInput<T>& input : InputArray)
         {
             // Assuming ConnectedOutput is not nullptr
-            result.push_back(f(*input->ConnectedOutput));
+            result.push_back(f(*input.ConnectedOutput));
         }
         return result;
     }
 
 private:
     CFlowNode* Owner;
-    std::function<void(TInput<T>*)> DirtyNotifyRoutine;
+    TInlineCallback<TInput<T>*> DirtyNotifyRoutine;
 
-    std::vector<TInput<T>*> InputArray;
+    // Inputs are allocated in chunks and never move, outputs keep pointers to them
+    std::deque<TInput<T>> InputArray;
 };
 
 }
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace Flow
+{
+
+// Stores a small callable, such as a lambda capturing a pointer or two, inside the callback
+//  itself instead of on the heap like std::function. Calling an empty callback does nothing.
+template <typename... TArgs> class TInlineCallback
+{
+public:
+    static constexpr size_t Capacity = 2 * sizeof(void*);
+
+    TInlineCallback() = default;
+
+    template <typename TFunc, typename = std::enable_if_t<
+                                  !std::is_same_v<std::decay_t<TFunc>, TInlineCallback>>>
+    TInlineCallback(TFunc func)
+    {
+        static_assert(sizeof(TFunc) <= Capacity, "Capture a pointer to the state instead");
+        static_assert(std::is_trivially_copyable_v<TFunc>
+                          && std::is_trivially_destructible_v<TFunc>,
+                      "Only trivially copyable callables can be stored inline");
+        new (Storage) TFunc(func);
+        Invoker = [](void* storage, TArgs... args) { (*static_cast<TFunc*>(storage))(args...); };
+    }
+
+    void operator()(TArgs... args) const
+    {
+        if (Invoker)
+            Invoker(const_cast<unsigned char*>(Storage), args...);
+    }
+
+    explicit operator bool() const { return Invoker != nullptr; }
+
+private:
+    alignas(void*) unsigned char Storage[Capacity] {};
+    void (*Invoker)(void*, TArgs...) = nullptr;
+};
+
+}
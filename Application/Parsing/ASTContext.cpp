@@ -3,22 +3,14 @@
 namespace Nome::AST
 {
 
-CASTContext::CASTContext()
+CToken* CASTContext::MakeToken(std::string_view identifier)
 {
-    Slabs.push_back(std::make_unique<char[]>(InitialSize));
-    SlabLeft.push_back(InitialSize);
-    SlabUsedCount.push_back(0);
-    InitialSize *= 2;
+    return Make<CToken>(Arena.CopyString(identifier), -1, 0);
 }
 
-CToken* CASTContext::MakeToken(std::string identifier)
+AIdent* CASTContext::MakeIdent(std::string_view identifier)
 {
-    return Make<CToken>(std::move(identifier), -1, 0);
-}
-
-AIdent* CASTContext::MakeIdent(std::string identifier)
-{
-    return Make<AIdent>(MakeToken(std::move(identifier)));
+    return Make<AIdent>(MakeToken(identifier));
 }
 
 AVector* CASTContext::MakeVector(const std::vector<AExpr*>& children)
@@ -29,4 +21,24 @@ AVector* CASTContext::MakeVector(const std::vector<AExpr*>& children)
     return vec;
 }
 
+CASTContext& CASTContext::AddSubContext()
+{
+    return *SubContexts.emplace_back(std::make_unique<CASTContext>());
+}
+
+void CASTContext::Reset()
+{
+    ASTRoot = nullptr;
+    Arena.Reset();
+    SubContexts.clear();
+}
+
+size_t CASTContext::GetBytesReserved() const
+{
+    size_t bytes = Arena.GetBytesReserved();
+    for (const auto& subContext : SubContexts)
+        bytes += subContext->GetBytesReserved();
+    return bytes;
+}
+
 }
@@ -1,62 +1,53 @@
 #pragma once
+#include "Arena.h"
 #include "SyntaxTree.h"
 #include <memory>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace Nome::AST
 {
 
+// Owns every node and token of one parse. Nothing is freed piecemeal, Reset drops it all at once.
 class CASTContext
 {
 public:
-    CASTContext();
+    CASTContext() = default;
+    CASTContext(const CASTContext&) = delete;
+    CASTContext& operator=(const CASTContext&) = delete;
 
     template <typename T, typename... Args> T* Make(Args&&... args)
     {
-        size_t i = 0;
-        bool found = false;
-        for (i = 0; i < Slabs.size(); ++i)
-        {
-            if (SlabLeft[i] > sizeof(T) * 2)
-            {
-                found = true;
-                break;
-            }
-        }
-        if (!found)
-        {
-            Slabs.push_back(std::make_unique<char[]>(InitialSize));
-            SlabLeft.push_back(InitialSize);
-            SlabUsedCount.push_back(0);
-            InitialSize *= 2;
-        }
-        void* p = Slabs[i].get() + SlabUsedCount[i];
-        size_t size = SlabLeft[i];
-        if (std::align(alignof(T), sizeof(T), p, size))
-        {
-            T* result = new (p) T(std::forward<Args>(args)...);
-            size -= sizeof(T);
-            SlabUsedCount[i] += SlabLeft[i] - size;
-            SlabLeft[i] = size;
-            return result;
-        }
-        return nullptr;
+        void* p = Arena.Allocate(sizeof(T), alignof(T));
+        if constexpr (std::is_base_of_v<ANode, T>)
+            return new (p) T(Arena, std::forward<Args>(args)...);
+        else
+            return new (p) T(std::forward<Args>(args)...);
     }
 
-    CToken* MakeToken(std::string identifier);
-    AIdent* MakeIdent(std::string identifier);
+    // Token text made up after parsing has no source to view into, so it is copied in
+    CToken* MakeToken(std::string_view identifier);
+    AIdent* MakeIdent(std::string_view identifier);
     AVector* MakeVector(const std::vector<AExpr*>& children);
+    std::string_view CopyString(std::string_view str) { return Arena.CopyString(str); }
+
+    // A context for another thread to build part of this AST in. It lives until this one is reset,
+    //  so its nodes may be linked into the tree here.
+    CASTContext& AddSubContext();
 
     [[nodiscard]] AFile* GetAstRoot() const { return ASTRoot; }
     void SetAstRoot(AFile* astRoot) { ASTRoot = astRoot; }
 
+    // Invalidates every node, token and string handed out so far
+    void Reset();
+    [[nodiscard]] size_t GetBytesReserved() const;
+
 private:
-    size_t InitialSize = 1024 * 32;
-    std::vector<std::unique_ptr<char[]>> Slabs;
-    std::vector<size_t> SlabUsedCount;
-    std::vector<size_t> SlabLeft;
+    CArena Arena;
     AST::AFile* ASTRoot {};
+    std::vector<std::unique_ptr<CASTContext>> SubContexts;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,237 @@
+#include "ASTSnapshot.h"
+#include "BinaryStream.h"
+
+namespace Nome
+{
+
+namespace
+{
+
+enum ETokenTag : uint8_t
+{
+    NullToken,
+    SourceToken,
+    InlineToken
+};
+
+class CSnapshotWriter
+{
+public:
+    explicit CSnapshotWriter(std::string_view source)
+        : Source(source)
+    {
+    }
+
+    void WriteToken(const AST::CToken* token)
+    {
+        if (!token)
+        {
+            Out.Write(NullToken);
+            return;
+        }
+        auto text = token->GetText();
+        const char* sourceEnd = Source.data() + Source.size();
+        if (text.data() >= Source.data() && text.data() + text.size() <= sourceEnd)
+        {
+            Out.Write(SourceToken);
+            Out.Write(static_cast<uint32_t>(text.data() - Source.data()));
+            Out.Write(static_cast<uint32_t>(text.size()));
+        }
+        else
+        {
+            Out.Write(InlineToken);
+            Out.WriteString(text);
+        }
+        Out.Write(token->GetLocation());
+    }
+
+    void WriteExpr(const AST::AExpr* expr)
+    {
+        Out.Write(expr->GetKind());
+        WriteToken(expr->GetOpenToken());
+        switch (expr->GetKind())
+        {
+        case AST::EKind::UnaryOp:
+            WriteExpr(static_cast<const AST::AUnaryOp*>(expr)->GetOperand());
+            break;
+        case AST::EKind::BinaryOp:
+            WriteExpr(static_cast<const AST::ABinaryOp*>(expr)->GetLeft());
+            WriteExpr(static_cast<const AST::ABinaryOp*>(expr)->GetRight());
+            break;
+        case AST::EKind::Vector:
+            WriteToken(expr->GetCloseToken());
+            WriteList(static_cast<const AST::AVector*>(expr)->GetItems(),
+                      [this](auto* item) { WriteExpr(item); });
+            break;
+        case AST::EKind::Call:
+            WriteExpr(static_cast<const AST::ACall*>(expr)->GetOperandList());
+            break;
+        case AST::EKind::WrappedExpr:
+            WriteToken(expr->GetCloseToken());
+            WriteToken(static_cast<const AST::AWrappedExpr*>(expr)->GetSecondToken());
+            WriteExpr(static_cast<const AST::AWrappedExpr*>(expr)->GetExpr());
+            break;
+        default:
+            break;
+        }
+    }
+
+    void WriteNamedArgument(const AST::ANamedArgument* arg)
+    {
+        WriteToken(arg->GetOpenToken());
+        WriteList(arg->GetArguments(), [this](auto* expr) { WriteExpr(expr); });
+    }
+
+    void WriteCommand(const AST::ACommand* cmd)
+    {
+        WriteToken(cmd->GetOpenToken());
+        WriteToken(cmd->GetCloseToken());
+        Out.Write(static_cast<uint8_t>(cmd->IsPendingSave()));
+        WriteList(cmd->GetPositionalArguments(), [this](auto* expr) { WriteExpr(expr); });
+        WriteList(cmd->GetNamedArguments(), [this](auto* arg) { WriteNamedArgument(arg); });
+        WriteList(cmd->GetTransforms(), [this](auto* arg) { WriteNamedArgument(arg); });
+        WriteList(cmd->GetSubCommands(), [this](auto* sub) { WriteCommand(sub); });
+    }
+
+    template <typename TList, typename TFunc> void WriteList(const TList& list, TFunc&& write)
+    {
+        Out.Write(static_cast<uint32_t>(list.size()));
+        for (auto* item : list)
+            write(item);
+    }
+
+    CBinaryWriter Out;
+
+private:
+    std::string_view Source;
+};
+
+class CSnapshotReader
+{
+public:
+    CSnapshotReader(std::string_view data, AST::CASTContext& ctx, std::string_view source)
+        : In(data)
+        , Ctx(ctx)
+        , Source(source)
+    {
+    }
+
+    AST::CToken* ReadToken()
+    {
+        auto tag = In.Read<uint8_t>();
+        std::string_view text;
+        if (tag == NullToken)
+            return nullptr;
+        else if (tag == SourceToken)
+        {
+            auto offset = In.Read<uint32_t>();
+            auto length = In.Read<uint32_t>();
+            if (offset > Source.size() || length > Source.size() - offset)
+                throw std::runtime_error("Token out of source range");
+            text = Source.substr(offset, length);
+        }
+        else if (tag == InlineToken)
+            text = Ctx.CopyString(In.ReadString());
+        else
+            throw std::runtime_error("Unknown token tag");
+        auto loc = In.Read<AST::CBufLoc>();
+        return Ctx.Make<AST::CToken>(text, loc.BufId, loc.Start);
+    }
+
+    AST::AExpr* ReadExpr()
+    {
+        auto kind = In.Read<AST::EKind>();
+        auto* token = ReadToken();
+        switch (kind)
+        {
+        case AST::EKind::Ident:
+            return Ctx.Make<AST::AIdent>(token);
+        case AST::EKind::Number:
+            return Ctx.Make<AST::ANumber>(token);
+        case AST::EKind::UnaryOp:
+            return Ctx.Make<AST::AUnaryOp>(token, ReadExpr());
+        case AST::EKind::BinaryOp:
+        {
+            auto* left = ReadExpr();
+            auto* right = ReadExpr();
+            return Ctx.Make<AST::ABinaryOp>(token, left, right);
+        }
+        case AST::EKind::Vector:
+        {
+            auto* vector = Ctx.Make<AST::AVector>(token, ReadToken());
+            ReadList([&] { vector->AddChild(ReadExpr()); });
+            return vector;
+        }
+        case AST::EKind::Call:
+        {
+            auto* args = ReadExpr();
+            if (args->GetKind() != AST::EKind::Vector)
+                throw std::runtime_error("Call without an argument list");
+            return Ctx.Make<AST::ACall>(token, static_cast<AST::AVector*>(args));
+        }
+        case AST::EKind::WrappedExpr:
+        {
+            auto* close = ReadToken();
+            auto* second = ReadToken();
+            return Ctx.Make<AST::AWrappedExpr>(token, close, second, ReadExpr());
+        }
+        default:
+            throw std::runtime_error("Unknown expression kind");
+        }
+    }
+
+    AST::ANamedArgument* ReadNamedArgument()
+    {
+        auto* arg = Ctx.Make<AST::ANamedArgument>(ReadToken());
+        ReadList([&] { arg->AddChild(ReadExpr()); });
+        return arg;
+    }
+
+    AST::ACommand* ReadCommand()
+    {
+        auto* open = ReadToken();
+        auto* close = ReadToken();
+        auto* cmd = Ctx.Make<AST::ACommand>(open, close);
+        cmd->SetPendingSave(In.Read<uint8_t>() != 0);
+        ReadList([&] { cmd->PushPositionalArgument(ReadExpr()); });
+        ReadList([&] { cmd->AddNamedArgument(ReadNamedArgument()); });
+        ReadList([&] { cmd->AddTransform(ReadNamedArgument()); });
+        ReadList([&] { cmd->AddSubCommand(ReadCommand()); });
+        return cmd;
+    }
+
+    template <typename TFunc> void ReadList(TFunc&& read)
+    {
+        auto count = In.Read<uint32_t>();
+        for (uint32_t i = 0; i < count; i++)
+            read();
+    }
+
+    CBinaryReader In;
+
+private:
+    AST::CASTContext& Ctx;
+    std::string_view Source;
+};
+
+}
+
+std::string CASTSnapshot::Write(const AST::AFile& file, std::string_view source)
+{
+    CSnapshotWriter writer(source);
+    writer.WriteList(file.GetCommands(), [&](auto* cmd) { writer.WriteCommand(cmd); });
+    return writer.Out.TakeBuffer();
+}
+
+AST::AFile* CASTSnapshot::Read(std::string_view data, AST::CASTContext& ctx,
+                               std::string_view source)
+{
+    CSnapshotReader reader(data, ctx, source);
+    auto* file = ctx.Make<AST::AFile>();
+    reader.ReadList([&] { file->AddChild(reader.ReadCommand()); });
+    if (!reader.In.IsAtEnd())
+        throw std::runtime_error("Trailing data after the AST");
+    return file;
+}
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "ASTContext.h"
+#include "SyntaxTree.h"
+#include <string>
+#include <string_view>
+
+namespace Nome
+{
+
+// Flattens an AST into bytes and back, so that an unchanged file can skip the parser. Tokens that
+//  view the source are stored as offsets into it and view the same source again when read back.
+class CASTSnapshot
+{
+public:
+    static std::string Write(const AST::AFile& file, std::string_view source);
+    // Throws std::runtime_error if data is damaged
+    static AST::AFile* Read(std::string_view data, AST::CASTContext& ctx, std::string_view source);
+};
+
+}
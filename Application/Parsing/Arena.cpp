@@ -0,0 +1,31 @@
+#include "Arena.h"
+
+namespace Nome::AST
+{
+
+void CArena::Reset()
+{
+    if (Slabs.size() > 1)
+    {
+        auto newest = std::move(Slabs.back());
+        Slabs.clear();
+        Slabs.push_back(std::move(newest));
+        BytesReserved = Capacity;
+    }
+    Used = 0;
+}
+
+void CArena::Grow(size_t minSize)
+{
+    // Doubling keeps the number of slabs logarithmic, so a reset costs next to nothing
+    size_t size = std::max(NextSlabSize, minSize);
+    NextSlabSize = size * 2;
+    // Not value initialized, slabs can be megabytes
+    Slabs.emplace_back(new char[size]);
+    Current = Slabs.back().get();
+    Used = 0;
+    Capacity = size;
+    BytesReserved += size;
+}
+
+}
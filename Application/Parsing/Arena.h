@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace Nome::AST
+{
+
+// Bump allocator behind the AST. Nothing is freed on its own, everything goes at once when the
+//  arena is reset or destroyed, so objects placed here must not rely on their destructors.
+class CArena
+{
+public:
+    CArena() = default;
+    CArena(const CArena&) = delete;
+    CArena& operator=(const CArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment)
+    {
+        size_t offset = (Used + alignment - 1) & ~(alignment - 1);
+        if (offset + size > Capacity)
+        {
+            Grow(size + alignment);
+            offset = (Used + alignment - 1) & ~(alignment - 1);
+        }
+        Used = offset + size;
+        return Current + offset;
+    }
+
+    std::string_view CopyString(std::string_view str)
+    {
+        if (str.empty())
+            return {};
+        auto* dest = static_cast<char*>(Allocate(str.size(), 1));
+        std::copy(str.begin(), str.end(), dest);
+        return { dest, str.size() };
+    }
+
+    // Releases everything but the newest slab, which is kept for reuse
+    void Reset();
+
+    [[nodiscard]] size_t GetBytesReserved() const { return BytesReserved; }
+
+private:
+    void Grow(size_t minSize);
+
+    std::vector<std::unique_ptr<char[]>> Slabs;
+    char* Current = nullptr;
+    size_t Used = 0;
+    size_t Capacity = 0;
+    size_t NextSlabSize = 32 * 1024;
+    size_t BytesReserved = 0;
+};
+
+// Lets standard containers inside AST nodes take their storage from the arena as well
+template <typename T> class TArenaAllocator
+{
+public:
+    using value_type = T;
+
+    TArenaAllocator(CArena& arena)
+        : Arena(&arena)
+    {
+    }
+
+    template <typename U>
+    TArenaAllocator(const TArenaAllocator<U>& other)
+        : Arena(other.Arena)
+    {
+    }
+
+    T* allocate(size_t n) { return static_cast<T*>(Arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) { }
+
+    friend bool operator==(const TArenaAllocator& lhs, const TArenaAllocator& rhs)
+    {
+        return lhs.Arena == rhs.Arena;
+    }
+    friend bool operator!=(const TArenaAllocator& lhs, const TArenaAllocator& rhs)
+    {
+        return lhs.Arena != rhs.Arena;
+    }
+
+private:
+    template <typename U> friend class TArenaAllocator;
+    CArena* Arena;
+};
+
+template <typename T> using TArenaVector = std::vector<T, TArenaAllocator<T>>;
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Nome
+{
+
+// Appends plain values to a byte string in host byte order, for caches that are only ever read
+//  back on the machine that wrote them
+class CBinaryWriter
+{
+public:
+    template <typename T> void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void WriteString(std::string_view text)
+    {
+        Write(static_cast<uint32_t>(text.size()));
+        Buffer.append(text);
+    }
+
+    [[nodiscard]] const std::string& GetBuffer() const { return Buffer; }
+    std::string TakeBuffer() { return std::move(Buffer); }
+
+private:
+    std::string Buffer;
+};
+
+// Reads back what CBinaryWriter wrote, throws std::runtime_error on running past the end
+class CBinaryReader
+{
+public:
+    explicit CBinaryReader(std::string_view data)
+        : Data(data)
+    {
+    }
+
+    template <typename T> T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // Views the data, no copy is made
+    std::string_view ReadString()
+    {
+        auto size = Read<uint32_t>();
+        return { Take(size), size };
+    }
+
+    [[nodiscard]] bool IsAtEnd() const { return Pos == Data.size(); }
+
+private:
+    const char* Take(size_t size)
+    {
+        if (size > Data.size() - Pos)
+            throw std::runtime_error("Truncated binary data");
+        const char* ptr = Data.data() + Pos;
+        Pos += size;
+        return ptr;
+    }
+
+    std::string_view Data;
+    size_t Pos = 0;
+};
+
+}
@@ -0,0 +1,108 @@
+#include "CacheFile.h"
+#include "BinaryStream.h"
+#include <picosha2.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace Nome
+{
+
+namespace
+{
+
+constexpr uint32_t Magic = CCacheFile::MakeTag("NOMC");
+
+}
+
+std::string CCacheFile::GetPathFor(const std::string& sourcePath)
+{
+    return sourcePath + "cache";
+}
+
+CCacheFile::THash CCacheFile::HashSource(std::string_view source)
+{
+    THash hash;
+    picosha2::hash256(source.begin(), source.end(), hash.begin(), hash.end());
+    return hash;
+}
+
+bool CCacheFile::Load(const std::string& path, const THash& hash)
+{
+    Clear();
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+        return false;
+    std::ostringstream contents;
+    contents << ifs.rdbuf();
+    Buffer = contents.str();
+
+    try
+    {
+        CBinaryReader reader(Buffer);
+        if (reader.Read<uint32_t>() != Magic || reader.Read<uint32_t>() != FormatVersion
+            || reader.Read<THash>() != hash)
+        {
+            Clear();
+            return false;
+        }
+        auto numSections = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < numSections; i++)
+        {
+            auto tag = reader.Read<uint32_t>();
+            Sections[tag] = reader.ReadString();
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "Ignoring damaged cache " << path << ": " << e.what() << std::endl;
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+void CCacheFile::Clear()
+{
+    Sections.clear();
+    Buffer.clear();
+    Buffer.shrink_to_fit();
+}
+
+std::optional<std::string_view> CCacheFile::FindSection(uint32_t tag) const
+{
+    auto iter = Sections.find(tag);
+    if (iter == Sections.end())
+        return {};
+    return iter->second;
+}
+
+bool CCacheFile::Save(const std::string& path, const THash& hash, const TSections& sections)
+{
+    CBinaryWriter writer;
+    writer.Write(Magic);
+    writer.Write(FormatVersion);
+    writer.Write(hash);
+    writer.Write(static_cast<uint32_t>(sections.size()));
+    for (const auto& [tag, data] : sections)
+    {
+        writer.Write(tag);
+        writer.WriteString(data);
+    }
+
+    // Written aside and moved over, so that a reader never sees half a file. Concurrent writers of
+    //  the same cache each get their own temporary, the last rename wins.
+    std::string tempPath = path + "." + std::to_string(std::random_device {}()) + ".tmp";
+    {
+        std::ofstream ofs(tempPath, std::ios::binary | std::ios::trunc);
+        ofs << writer.GetBuffer();
+        if (!ofs)
+            return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+}
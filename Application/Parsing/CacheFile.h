@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Nome
+{
+
+// Snapshot stored next to a .nom file as <file>.nomcache. It starts with the SHA-256 of the source
+//  it was made from, followed by tagged sections, one per layer with something to cache. The file
+//  is read in one go and the sections are views into that buffer.
+class CCacheFile
+{
+public:
+    using THash = std::array<uint8_t, 32>;
+    using TSections = std::vector<std::pair<uint32_t, std::string>>;
+
+    // Bump whenever a section layout changes. Changes to what generators output are covered by
+    //  CSceneCache, which only throws away the meshes.
+    static constexpr uint32_t FormatVersion = 3;
+
+    static std::string GetPathFor(const std::string& sourcePath);
+    static THash HashSource(std::string_view source);
+    static constexpr uint32_t MakeTag(const char (&name)[5])
+    {
+        return uint32_t(uint8_t(name[0])) | uint32_t(uint8_t(name[1])) << 8
+            | uint32_t(uint8_t(name[2])) << 16 | uint32_t(uint8_t(name[3])) << 24;
+    }
+
+    // False if the file is missing, damaged or made from some other source
+    bool Load(const std::string& path, const THash& hash);
+    void Clear();
+    [[nodiscard]] bool IsLoaded() const { return !Buffer.empty(); }
+    [[nodiscard]] std::optional<std::string_view> FindSection(uint32_t tag) const;
+
+    static bool Save(const std::string& path, const THash& hash, const TSections& sections);
+
+private:
+    std::string Buffer;
+    std::map<uint32_t, std::string_view> Sections;
+};
+
+}
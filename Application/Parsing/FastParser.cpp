@@ -0,0 +1,870 @@
+#include "FastParser.h"
+#include <ThreadPool.h>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+namespace Nome
+{
+
+namespace
+{
+
+// Every literal of Nom.g4 that looks like an identifier. The lexer gives literals priority over
+//  IDENT, so none of these can be used as a name.
+enum EKeyword : uint8_t
+{
+    KwNone,
+    KwPoint, KwEndPoint, KwPolyline, KwEndPolyline, KwSweep, KwEndSweep, KwSweepControl,
+    KwEndSweepControl, KwFace, KwEndFace, KwObject, KwEndObject, KwMesh, KwEndMesh, KwGroup,
+    KwEndGroup, KwCircle, KwEndCircle, KwSphere, KwEndSphere, KwCylinder, KwEndCylinder,
+    KwHyperboloid, KwEndHyperboloid, KwDupin, KwEndDupin, KwMobiusStrip, KwEndMobiusStrip,
+    KwHelix, KwEndHelix, KwFunnel, KwEndFunnel, KwTunnel, KwEndTunnel, KwTorusKnot,
+    KwEndTorusKnot, KwTorus, KwEndTorus, KwBezierCurve, KwEndBezierCurve, KwBSpline,
+    KwEndBSpline, KwInstance, KwEndInstance, KwSurface, KwEndSurface, KwBackground,
+    KwEndBackground, KwForeground, KwEndForeground, KwInsideFaces, KwEndInsideFaces,
+    KwOutsideFaces, KwEndOutsideFaces, KwOffsetFaces, KwEndOffsetFaces, KwFrontFaces,
+    KwEndFrontFaces, KwBackFaces, KwEndBackFaces, KwRimFaces, KwEndRimFaces, KwBank, KwEndBank,
+    KwDelete, KwEndDelete, KwSubdivision, KwEndSubdivision, KwOffset, KwEndOffset, KwSet, KwExpr,
+    KwClosed, KwHidden, KwSlices, KwOrder, KwRotate, KwScale, KwTranslate, KwColor, KwType,
+    KwSubdivisions, KwMin, KwMax, KwStep,
+    KwCount
+};
+
+const std::pair<EKeyword, std::string_view> KeywordSpellings[] = {
+    { KwPoint, "point" }, { KwEndPoint, "endpoint" }, { KwPolyline, "polyline" },
+    { KwEndPolyline, "endpolyline" }, { KwSweep, "sweep" }, { KwEndSweep, "endsweep" },
+    { KwSweepControl, "sweepcontrol" }, { KwEndSweepControl, "endsweepcontrol" },
+    { KwFace, "face" }, { KwEndFace, "endface" }, { KwObject, "object" },
+    { KwEndObject, "endobject" }, { KwMesh, "mesh" }, { KwEndMesh, "endmesh" },
+    { KwGroup, "group" }, { KwEndGroup, "endgroup" }, { KwCircle, "circle" },
+    { KwEndCircle, "endcircle" }, { KwSphere, "sphere" }, { KwEndSphere, "endsphere" },
+    { KwCylinder, "cylinder" }, { KwEndCylinder, "endcylinder" },
+    { KwHyperboloid, "hyperboloid" }, { KwEndHyperboloid, "endhyperboloid" },
+    { KwDupin, "dupin" }, { KwEndDupin, "enddupin" }, { KwMobiusStrip, "mobiusstrip" },
+    { KwEndMobiusStrip, "endmobiusstrip" }, { KwHelix, "helix" }, { KwEndHelix, "endhelix" },
+    { KwFunnel, "funnel" }, { KwEndFunnel, "endfunnel" }, { KwTunnel, "tunnel" },
+    { KwEndTunnel, "endtunnel" }, { KwTorusKnot, "torusknot" },
+    { KwEndTorusKnot, "endtorusknot" }, { KwTorus, "torus" }, { KwEndTorus, "endtorus" },
+    { KwBezierCurve, "beziercurve" }, { KwEndBezierCurve, "endbeziercurve" },
+    { KwBSpline, "bspline" }, { KwEndBSpline, "endbspline" }, { KwInstance, "instance" },
+    { KwEndInstance, "endinstance" }, { KwSurface, "surface" }, { KwEndSurface, "endsurface" },
+    { KwBackground, "background" }, { KwEndBackground, "endbackground" },
+    { KwForeground, "foreground" }, { KwEndForeground, "endforeground" },
+    { KwInsideFaces, "insidefaces" }, { KwEndInsideFaces, "endinsidefaces" },
+    { KwOutsideFaces, "outsidefaces" }, { KwEndOutsideFaces, "endoutsidefaces" },
+    { KwOffsetFaces, "offsetfaces" }, { KwEndOffsetFaces, "endoffsetfaces" },
+    { KwFrontFaces, "frontfaces" }, { KwEndFrontFaces, "endfrontfaces" },
+    { KwBackFaces, "backfaces" }, { KwEndBackFaces, "endbackfaces" },
+    { KwRimFaces, "rimfaces" }, { KwEndRimFaces, "endrimfaces" }, { KwBank, "bank" },
+    { KwEndBank, "endbank" }, { KwDelete, "delete" }, { KwEndDelete, "enddelete" },
+    { KwSubdivision, "subdivision" }, { KwEndSubdivision, "endsubdivision" },
+    { KwOffset, "offset" }, { KwEndOffset, "endoffset" }, { KwSet, "set" }, { KwExpr, "expr" },
+    { KwClosed, "closed" }, { KwHidden, "hidden" }, { KwSlices, "slices" },
+    { KwOrder, "order" }, { KwRotate, "rotate" }, { KwScale, "scale" },
+    { KwTranslate, "translate" }, { KwColor, "color" }, { KwType, "type" },
+    { KwSubdivisions, "subdivisions" }, { KwMin, "min" }, { KwMax, "max" }, { KwStep, "step" },
+};
+
+uint8_t FindKeyword(std::string_view text)
+{
+    static const auto keywords = [] {
+        std::unordered_map<std::string_view, uint8_t> map;
+        for (const auto& [keyword, spelling] : KeywordSpellings)
+            map.emplace(spelling, keyword);
+        return map;
+    }();
+    auto iter = keywords.find(text);
+    return iter == keywords.end() ? static_cast<uint8_t>(KwNone) : iter->second;
+}
+
+std::string_view KeywordSpelling(uint8_t keyword)
+{
+    for (const auto& [kw, spelling] : KeywordSpellings)
+        if (kw == keyword)
+            return spelling;
+    return {};
+}
+
+enum class ECommandForm : uint8_t
+{
+    ExprList,
+    Polyline,
+    Face,
+    Object,
+    BezierCurve,
+    BSpline,
+    SubCommands,
+    Instance,
+    Surface,
+    ArgSurface,
+    Bank,
+    Delete,
+    Subdivision,
+    Offset
+};
+
+struct CCommandSyntax
+{
+    EKeyword Open;
+    EKeyword End;
+    ECommandForm Form;
+    // Length of the expression list, if the form has one
+    uint8_t NumExprs;
+};
+
+const CCommandSyntax CommandSyntaxes[] = {
+    { KwPoint, KwEndPoint, ECommandForm::ExprList, 3 },
+    { KwPolyline, KwEndPolyline, ECommandForm::Polyline, 0 },
+    { KwSweep, KwEndSweep, ECommandForm::ExprList, 4 },
+    { KwSweepControl, KwEndSweepControl, ECommandForm::ExprList, 4 },
+    { KwFace, KwEndFace, ECommandForm::Face, 0 },
+    { KwObject, KwEndObject, ECommandForm::Object, 0 },
+    { KwMesh, KwEndMesh, ECommandForm::SubCommands, 0 },
+    { KwGroup, KwEndGroup, ECommandForm::SubCommands, 0 },
+    { KwCircle, KwEndCircle, ECommandForm::ExprList, 2 },
+    { KwSphere, KwEndSphere, ECommandForm::ExprList, 6 },
+    { KwCylinder, KwEndCylinder, ECommandForm::ExprList, 4 },
+    { KwHyperboloid, KwEndHyperboloid, ECommandForm::ExprList, 6 },
+    { KwDupin, KwEndDupin, ECommandForm::ExprList, 7 },
+    { KwMobiusStrip, KwEndMobiusStrip, ECommandForm::ExprList, 4 },
+    { KwHelix, KwEndHelix, ECommandForm::ExprList, 4 },
+    { KwFunnel, KwEndFunnel, ECommandForm::ExprList, 4 },
+    { KwTunnel, KwEndTunnel, ECommandForm::ExprList, 4 },
+    { KwTorusKnot, KwEndTorusKnot, ECommandForm::ExprList, 7 },
+    { KwTorus, KwEndTorus, ECommandForm::ExprList, 7 },
+    { KwBezierCurve, KwEndBezierCurve, ECommandForm::BezierCurve, 0 },
+    { KwBSpline, KwEndBSpline, ECommandForm::BSpline, 0 },
+    { KwInstance, KwEndInstance, ECommandForm::Instance, 0 },
+    { KwSurface, KwEndSurface, ECommandForm::Surface, 0 },
+    { KwBackground, KwEndBackground, ECommandForm::ArgSurface, 0 },
+    { KwForeground, KwEndForeground, ECommandForm::ArgSurface, 0 },
+    { KwInsideFaces, KwEndInsideFaces, ECommandForm::ArgSurface, 0 },
+    { KwOutsideFaces, KwEndOutsideFaces, ECommandForm::ArgSurface, 0 },
+    { KwOffsetFaces, KwEndOffsetFaces, ECommandForm::ArgSurface, 0 },
+    { KwFrontFaces, KwEndFrontFaces, ECommandForm::ArgSurface, 0 },
+    { KwBackFaces, KwEndBackFaces, ECommandForm::ArgSurface, 0 },
+    { KwRimFaces, KwEndRimFaces, ECommandForm::ArgSurface, 0 },
+    { KwBank, KwEndBank, ECommandForm::Bank, 0 },
+    { KwDelete, KwEndDelete, ECommandForm::Delete, 0 },
+    { KwSubdivision, KwEndSubdivision, ECommandForm::Subdivision, 0 },
+    { KwOffset, KwEndOffset, ECommandForm::Offset, 0 },
+};
+
+const CCommandSyntax* FindCommand(uint8_t keyword)
+{
+    static const auto commands = [] {
+        std::array<const CCommandSyntax*, KwCount> table {};
+        for (const auto& syntax : CommandSyntaxes)
+            table[syntax.Open] = &syntax;
+        return table;
+    }();
+    return keyword < KwCount ? commands[keyword] : nullptr;
+}
+
+// Operator precedences as ANTLR derives them from the order of the alternatives in Nom.g4. The
+//  unary operators come after the binary ones there, so their operand takes in any binary
+//  operator, -a + b is -(a + b).
+constexpr int PowPrecedence = 7;
+constexpr int MulPrecedence = 6;
+constexpr int AddPrecedence = 5;
+constexpr int UnaryOperandPrecedence = 3;
+
+// Only reached when backtracking a list with a genuine error in it
+constexpr size_t MaxListAttempts = 256;
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool IsIdentStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '.';
+}
+
+bool IsIdentChar(char c) { return IsIdentStart(c) || IsDigit(c); }
+
+}
+
+CFastParser::CFastParser(AST::CASTContext& ctx, std::string_view source, unsigned int bufId,
+                         unsigned int baseOffset)
+    : Ctx(ctx)
+    , Source(source)
+    , BufId(bufId)
+    , BaseOffset(baseOffset)
+{
+}
+
+void CFastParser::Tokenize()
+{
+    Tokens.clear();
+    Tokens.reserve(Source.size() / 4 + 1);
+    const size_t size = Source.size();
+    auto push = [this](ETokenKind kind, size_t begin, size_t end, uint8_t keyword = KwNone) {
+        Tokens.push_back({ kind, keyword, static_cast<uint32_t>(begin),
+                           static_cast<uint32_t>(end - begin) });
+    };
+
+    size_t i = 0;
+    while (i < size)
+    {
+        char c = Source[i];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            i++;
+            continue;
+        }
+        if (IsIdentStart(c))
+        {
+            size_t end = i + 1;
+            while (end < size && IsIdentChar(Source[end]))
+                end++;
+            uint8_t keyword = FindKeyword(Source.substr(i, end - i));
+            push(keyword == KwNone ? ETokenKind::Ident : ETokenKind::Keyword, i, end, keyword);
+            i = end;
+            continue;
+        }
+        if (IsDigit(c))
+        {
+            // Longest match, an incomplete fraction or exponent is left for the next token
+            size_t end = i + 1;
+            while (end < size && IsDigit(Source[end]))
+                end++;
+            if (end + 1 < size && Source[end] == '.' && IsDigit(Source[end + 1]))
+            {
+                end += 2;
+                while (end < size && IsDigit(Source[end]))
+                    end++;
+            }
+            if (end < size && (Source[end] == 'e' || Source[end] == 'E'))
+            {
+                size_t exp = end + 1;
+                if (exp < size && (Source[exp] == '+' || Source[exp] == '-'))
+                    exp++;
+                if (exp < size && IsDigit(Source[exp]))
+                {
+                    end = exp + 1;
+                    while (end < size && IsDigit(Source[end]))
+                        end++;
+                }
+            }
+            push(ETokenKind::Number, i, end);
+            i = end;
+            continue;
+        }
+        switch (c)
+        {
+        case '(':
+            if (i + 1 < size && Source[i + 1] == '*')
+            {
+                // An unterminated comment is just a parenthesis and an asterisk
+                size_t close = Source.find("*)", i + 2);
+                if (close != std::string_view::npos)
+                {
+                    i = close + 2;
+                    continue;
+                }
+            }
+            push(ETokenKind::LParen, i, i + 1);
+            break;
+        case '#':
+            while (i < size && Source[i] != '\n' && Source[i] != '\r')
+                i++;
+            continue;
+        case ')':
+            push(ETokenKind::RParen, i, i + 1);
+            break;
+        case '+':
+            push(ETokenKind::Plus, i, i + 1);
+            break;
+        case '-':
+            push(ETokenKind::Minus, i, i + 1);
+            break;
+        case '*':
+            push(ETokenKind::Times, i, i + 1);
+            break;
+        case '/':
+            push(ETokenKind::Div, i, i + 1);
+            break;
+        case '^':
+            push(ETokenKind::Pow, i, i + 1);
+            break;
+        case '$':
+            push(ETokenKind::Dollar, i, i + 1);
+            break;
+        case '{':
+            push(ETokenKind::LCurly, i, i + 1);
+            break;
+        case '}':
+            push(ETokenKind::RCurly, i, i + 1);
+            break;
+        case '<':
+        case '>':
+        case '=':
+            push(ETokenKind::Other, i, i + 1);
+            break;
+        default:
+        {
+            // Skip the whole UTF-8 sequence
+            size_t end = i + 1;
+            while (end < size && (static_cast<unsigned char>(Source[end]) & 0xC0) == 0x80)
+                end++;
+            auto [line, column] = GetLineAndColumn(i);
+            // Same message and stream as ANTLR's console listener
+            std::cerr << "line " << line << ":" << column << " token recognition error at: '"
+                      << Source.substr(i, end - i) << "'" << std::endl;
+            bLexerErrors = true;
+            i = end;
+            continue;
+        }
+        }
+        i++;
+    }
+    push(ETokenKind::End, size, size);
+}
+
+const CFastParser::CLexToken& CFastParser::Peek(size_t ahead) const
+{
+    return Tokens[std::min(Pos + ahead, Tokens.size() - 1)];
+}
+
+bool CFastParser::IsKeyword(size_t token, uint8_t keyword) const
+{
+    return Tokens[token].Kind == ETokenKind::Keyword && Tokens[token].Keyword == keyword;
+}
+
+bool CFastParser::IsCommandStart(size_t token) const
+{
+    return Tokens[token].Kind == ETokenKind::Keyword && FindCommand(Tokens[token].Keyword);
+}
+
+size_t CFastParser::Expect(ETokenKind kind, const char* what)
+{
+    if (Peek().Kind != kind)
+        throw Mismatch(Pos, what);
+    return Pos++;
+}
+
+size_t CFastParser::ExpectKeyword(uint8_t keyword)
+{
+    if (!IsKeyword(Pos, keyword))
+        throw Mismatch(Pos, "'" + std::string(KeywordSpelling(keyword)) + "'");
+    return Pos++;
+}
+
+AST::CToken* CFastParser::MakeToken(size_t token)
+{
+    const CLexToken& lexToken = Tokens[token];
+    return Ctx.Make<AST::CToken>(Source.substr(lexToken.Offset, lexToken.Length), BufId,
+                                 BaseOffset + lexToken.Offset);
+}
+
+CFastParser::CSyntaxError CFastParser::Mismatch(size_t token, const std::string& expecting) const
+{
+    const CLexToken& lexToken = Tokens[token];
+    std::string text = lexToken.Kind == ETokenKind::End
+        ? "<EOF>"
+        : std::string(Source.substr(lexToken.Offset, lexToken.Length));
+    return { token, "mismatched input '" + text + "' expecting " + expecting };
+}
+
+void CFastParser::Report(const CSyntaxError& error)
+{
+    bSyntaxErrors = true;
+    if (!bPrintErrors)
+        return;
+    auto [line, column] = GetLineAndColumn(Tokens[error.Token].Offset);
+    std::cout << "line " << line << ":" << column << " " << error.Message << std::endl;
+}
+
+std::vector<size_t> CFastParser::FindTopLevelCommands() const
+{
+    // A command ends at the end keyword that balances its own keyword, whatever else it contains.
+    //  Other keywords cannot be told apart from commands without parsing, 'surface' for one is
+    //  also an argument.
+    std::vector<size_t> starts;
+    size_t pos = 0;
+    while (Tokens[pos].Kind != ETokenKind::End)
+    {
+        const CCommandSyntax* syntax =
+            Tokens[pos].Kind == ETokenKind::Keyword ? FindCommand(Tokens[pos].Keyword) : nullptr;
+        if (!syntax)
+            return {};
+        starts.push_back(pos);
+        int depth = 1;
+        while (depth > 0)
+        {
+            if (Tokens[++pos].Kind == ETokenKind::End)
+                return {};
+            if (IsKeyword(pos, syntax->Open))
+                depth++;
+            else if (IsKeyword(pos, syntax->End))
+                depth--;
+        }
+        pos++;
+    }
+    return starts;
+}
+
+std::pair<size_t, size_t> CFastParser::GetLineAndColumn(size_t offset) const
+{
+    size_t line = 1;
+    size_t column = 0;
+    for (size_t i = 0; i < offset && i < Source.size(); i++)
+    {
+        if (Source[i] == '\n')
+        {
+            line++;
+            column = 0;
+        }
+        else if ((static_cast<unsigned char>(Source[i]) & 0xC0) != 0x80)
+            column++;
+    }
+    return { line, column };
+}
+
+AST::AFile* CFastParser::ParseFile()
+{
+    if (Tokens.empty())
+        Tokenize();
+
+    auto* file = Ctx.Make<AST::AFile>();
+    Pos = 0;
+    while (Peek().Kind != ETokenKind::End)
+    {
+        size_t start = Pos;
+        try
+        {
+            file->AddChild(ParseCommand());
+        }
+        catch (const CSyntaxError& error)
+        {
+            Report(error);
+            bInList = false;
+            NestDepth = 0;
+            // Resume at the next command, skipping at least the one that failed
+            Pos = std::max(error.Token, start + 1);
+            while (Peek().Kind != ETokenKind::End && !IsCommandStart(Pos))
+                Pos++;
+        }
+    }
+    return file;
+}
+
+AST::AFile* CFastParser::ParseFileParallel(tc::FThreadPool& pool)
+{
+    if (Tokens.empty())
+        Tokenize();
+
+    // A few chunks per thread evens out commands of very different sizes
+    constexpr size_t MinChunkTokens = 2048;
+    size_t chunkTokens =
+        std::max(MinChunkTokens, Tokens.size() / (4 * (pool.GetNumWorkers() + 1)) + 1);
+    std::vector<size_t> chunkStarts;
+    for (size_t start : FindTopLevelCommands())
+        if (chunkStarts.empty() || start - chunkStarts.back() >= chunkTokens)
+            chunkStarts.push_back(start);
+    if (chunkStarts.size() < 2)
+        return ParseFile();
+    chunkStarts.push_back(Tokens.size() - 1);
+
+    std::vector<std::unique_ptr<CFastParser>> chunks;
+    std::vector<AST::AFile*> chunkFiles(chunkStarts.size() - 1);
+    for (size_t i = 0; i + 1 < chunkStarts.size(); i++)
+    {
+        auto& chunk = *chunks.emplace_back(
+            std::make_unique<CFastParser>(Ctx.AddSubContext(), Source, BufId, BaseOffset));
+        chunk.Tokens.assign(Tokens.begin() + chunkStarts[i], Tokens.begin() + chunkStarts[i + 1]);
+        chunk.Tokens.push_back({ ETokenKind::End, KwNone, Tokens[chunkStarts[i + 1]].Offset, 0 });
+        chunk.bPrintErrors = false;
+        pool.Submit([&chunk, file = &chunkFiles[i]] { *file = chunk.ParseFile(); });
+    }
+    pool.WaitIdle();
+
+    for (const auto& chunk : chunks)
+        if (chunk->HasSyntaxErrors())
+            return ParseFile();
+    auto* file = Ctx.Make<AST::AFile>();
+    for (auto* chunkFile : chunkFiles)
+        for (auto* cmd : chunkFile->GetCommands())
+            file->AddChild(cmd);
+    return file;
+}
+
+AST::ACommand* CFastParser::ParseCommand()
+{
+    const CCommandSyntax* syntax =
+        Peek().Kind == ETokenKind::Keyword ? FindCommand(Peek().Keyword) : nullptr;
+    if (!syntax)
+        throw Mismatch(Pos, "a command");
+    size_t open = Pos++;
+
+    std::vector<AST::AExpr*> positional;
+    std::vector<AST::ANamedArgument*> named;
+    std::vector<AST::ANamedArgument*> transforms;
+    std::vector<AST::ACommand*> subCommands;
+    // For subdivision and offset, whose arguments are keyword and value pairs
+    auto parseKeyed = [&](uint8_t keyword, bool bIdent) {
+        auto* arg = Ctx.Make<AST::ANamedArgument>(MakeToken(ExpectKeyword(keyword)));
+        arg->AddChild(bIdent ? ParseIdent() : ParseExpr(0));
+        named.push_back(arg);
+    };
+    switch (syntax->Form)
+    {
+    case ECommandForm::ExprList:
+        positional.push_back(ParseIdent());
+        positional.push_back(ParseExprVector(syntax->NumExprs));
+        if (syntax->Open == KwPoint)
+            while (Peek().Kind == ETokenKind::LParen)
+                positional.push_back(ParseIdList());
+        break;
+    case ECommandForm::Polyline:
+        positional.push_back(ParseIdent());
+        positional.push_back(ParseIdList());
+        while (IsKeyword(Pos, KwClosed))
+            named.push_back(ParseFlagArg());
+        break;
+    case ECommandForm::Face:
+        positional.push_back(ParseIdent());
+        positional.push_back(ParseIdList());
+        while (IsKeyword(Pos, KwSurface))
+            named.push_back(ParseSurfaceArg());
+        break;
+    case ECommandForm::Object:
+        positional.push_back(ParseIdent());
+        positional.push_back(ParseIdList());
+        break;
+    case ECommandForm::BezierCurve:
+        positional.push_back(ParseIdent());
+        positional.push_back(ParseIdList());
+        while (IsKeyword(Pos, KwSlices))
+            named.push_back(ParseExprArg());
+        break;
+    case ECommandForm::BSpline:
+        positional.push_back(ParseIdent());
+        while (IsKeyword(Pos, KwOrder))
+            named.push_back(ParseExprArg());
+        positional.push_back(ParseIdList());
+        while (IsKeyword(Pos, KwSlices))
+            named.push_back(ParseExprArg());
+        break;
+    case ECommandForm::SubCommands:
+        positional.push_back(ParseIdent());
+        while (IsCommandStart(Pos))
+            subCommands.push_back(ParseCommand());
+        break;
+    case ECommandForm::Instance:
+        positional.push_back(ParseIdent());
+        positional.push_back(ParseIdent());
+        while (true)
+        {
+            if (IsKeyword(Pos, KwSurface))
+                named.push_back(ParseSurfaceArg());
+            else if (IsKeyword(Pos, KwHidden))
+                named.push_back(ParseFlagArg());
+            else if (IsKeyword(Pos, KwRotate) || IsKeyword(Pos, KwScale)
+                     || IsKeyword(Pos, KwTranslate))
+                transforms.push_back(ParseTransformArg());
+            else
+                break;
+        }
+        break;
+    case ECommandForm::Surface:
+        positional.push_back(ParseIdent());
+        named.push_back(ParseColorArg());
+        break;
+    case ECommandForm::ArgSurface:
+        named.push_back(ParseSurfaceArg());
+        break;
+    case ECommandForm::Bank:
+        positional.push_back(ParseIdent());
+        while (IsKeyword(Pos, KwSet))
+            subCommands.push_back(ParseSet());
+        break;
+    case ECommandForm::Delete:
+        while (IsKeyword(Pos, KwFace))
+            subCommands.push_back(ParseDeleteFace());
+        break;
+    case ECommandForm::Subdivision:
+        positional.push_back(ParseIdent());
+        parseKeyed(KwType, true);
+        parseKeyed(KwSubdivisions, false);
+        while (IsCommandStart(Pos))
+            subCommands.push_back(ParseCommand());
+        break;
+    case ECommandForm::Offset:
+        positional.push_back(ParseIdent());
+        parseKeyed(KwType, true);
+        parseKeyed(KwMin, false);
+        parseKeyed(KwMax, false);
+        parseKeyed(KwStep, false);
+        break;
+    }
+    size_t end = ExpectKeyword(syntax->End);
+
+    auto* cmd = Ctx.Make<AST::ACommand>(MakeToken(open), MakeToken(end));
+    for (auto* expr : positional)
+        cmd->PushPositionalArgument(expr);
+    for (auto* arg : named)
+        cmd->AddNamedArgument(arg);
+    for (auto* arg : transforms)
+        cmd->AddTransform(arg);
+    for (auto* sub : subCommands)
+        cmd->AddSubCommand(sub);
+    return cmd;
+}
+
+AST::ACommand* CFastParser::ParseSet()
+{
+    size_t open = ExpectKeyword(KwSet);
+    auto* ident = ParseIdent();
+    std::vector<AST::AExpr*> exprs;
+    auto isStop = [this](size_t token) {
+        return IsKeyword(token, KwSet) || IsKeyword(token, KwEndBank);
+    };
+    ParseExprs(4, exprs, isStop, "'set' or 'endbank'");
+
+    auto* cmd = Ctx.Make<AST::ACommand>(MakeToken(open), nullptr);
+    cmd->PushPositionalArgument(ident);
+    for (auto* expr : exprs)
+        cmd->PushPositionalArgument(expr);
+    return cmd;
+}
+
+AST::ACommand* CFastParser::ParseDeleteFace()
+{
+    size_t open = ExpectKeyword(KwFace);
+    auto* ident = ParseIdent();
+    size_t end = ExpectKeyword(KwEndFace);
+    auto* cmd = Ctx.Make<AST::ACommand>(MakeToken(open), MakeToken(end));
+    cmd->PushPositionalArgument(ident);
+    return cmd;
+}
+
+AST::AExpr* CFastParser::ParseIdent()
+{
+    if (Peek().Kind == ETokenKind::Dollar)
+        Pos++;
+    return Ctx.Make<AST::AIdent>(MakeToken(Expect(ETokenKind::Ident, "IDENT")));
+}
+
+AST::AExpr* CFastParser::ParseIdList()
+{
+    size_t open = Expect(ETokenKind::LParen, "'('");
+    std::vector<AST::AExpr*> idents;
+    while (Peek().Kind == ETokenKind::Ident || Peek().Kind == ETokenKind::Dollar)
+        idents.push_back(ParseIdent());
+    size_t close = Expect(ETokenKind::RParen, "')'");
+    auto* list = Ctx.Make<AST::AVector>(MakeToken(open), MakeToken(close));
+    for (auto* ident : idents)
+        list->AddChild(ident);
+    return list;
+}
+
+AST::ANamedArgument* CFastParser::ParseFlagArg()
+{
+    return Ctx.Make<AST::ANamedArgument>(MakeToken(Pos++));
+}
+
+AST::ANamedArgument* CFastParser::ParseSurfaceArg()
+{
+    auto* arg = Ctx.Make<AST::ANamedArgument>(MakeToken(ExpectKeyword(KwSurface)));
+    arg->AddChild(ParseIdent());
+    return arg;
+}
+
+AST::ANamedArgument* CFastParser::ParseExprArg()
+{
+    auto* arg = Ctx.Make<AST::ANamedArgument>(MakeToken(Pos++));
+    arg->AddChild(ParseExpr(0));
+    return arg;
+}
+
+AST::ANamedArgument* CFastParser::ParseTransformArg()
+{
+    bool bRotate = IsKeyword(Pos, KwRotate);
+    auto* arg = Ctx.Make<AST::ANamedArgument>(MakeToken(Pos++));
+    arg->AddChild(ParseExprVector(3));
+    // The angle
+    if (bRotate)
+        arg->AddChild(ParseExprVector(1));
+    return arg;
+}
+
+AST::ANamedArgument* CFastParser::ParseColorArg()
+{
+    auto* arg = Ctx.Make<AST::ANamedArgument>(MakeToken(ExpectKeyword(KwColor)));
+    arg->AddChild(ParseExprVector(3));
+    return arg;
+}
+
+AST::AVector* CFastParser::ParseExprVector(size_t count)
+{
+    size_t open = Expect(ETokenKind::LParen, "'('");
+    std::vector<AST::AExpr*> exprs;
+    auto isStop = [this](size_t token) { return Tokens[token].Kind == ETokenKind::RParen; };
+    ParseExprs(count, exprs, isStop, "')'");
+    size_t close = Pos++;
+    auto* list = Ctx.Make<AST::AVector>(MakeToken(open), MakeToken(close));
+    for (auto* expr : exprs)
+        list->AddChild(expr);
+    return list;
+}
+
+template <typename TStop>
+void CFastParser::ParseExprs(size_t count, std::vector<AST::AExpr*>& exprs, TStop isStop,
+                             const char* expecting)
+{
+    size_t start = Pos;
+    SplitPlan.clear();
+    std::optional<CSyntaxError> firstError;
+    for (size_t attempt = 0;; attempt++)
+    {
+        Pos = start;
+        bInList = true;
+        NestDepth = 0;
+        NextDecision = 0;
+        LastSplit = SIZE_MAX;
+        exprs.clear();
+        try
+        {
+            // Wrong splits mostly show as the list ending early or late, which are checked here
+            //  rather than thrown since most lists with a '-' in them take a few attempts
+            while (exprs.size() < count && !isStop(Pos))
+                exprs.push_back(ParseExpr(0));
+            if (exprs.size() == count && isStop(Pos))
+            {
+                bInList = false;
+                return;
+            }
+            if (!firstError)
+                firstError = Mismatch(Pos, exprs.size() < count ? "an expression" : expecting);
+        }
+        catch (const CSyntaxError& error)
+        {
+            if (!firstError)
+                firstError = error;
+        }
+
+        // Depth first in ANTLR's order of preference: the last item that took in an ambiguous
+        //  token ends there instead, and everything after it is decided afresh
+        SplitPlan.resize(NextDecision);
+        while (!SplitPlan.empty() && SplitPlan.back())
+            SplitPlan.pop_back();
+        if (SplitPlan.empty() || attempt + 1 >= MaxListAttempts)
+        {
+            bInList = false;
+            throw *firstError;
+        }
+        SplitPlan.back() = true;
+    }
+}
+
+AST::AExpr* CFastParser::ParseExpr(int minPrecedence)
+{
+    AST::AExpr* left = ParsePrimary();
+    while (true)
+    {
+        ETokenKind kind = Peek().Kind;
+        int precedence;
+        if (kind == ETokenKind::Pow)
+            precedence = PowPrecedence;
+        else if (kind == ETokenKind::Times || kind == ETokenKind::Div)
+            precedence = MulPrecedence;
+        else if (kind == ETokenKind::Plus || kind == ETokenKind::Minus)
+            precedence = AddPrecedence;
+        else
+            return left;
+        if (precedence < minPrecedence)
+            return left;
+        if (precedence == AddPrecedence && DecideSplit(Pos))
+            return left;
+
+        size_t op = Pos++;
+        // Left associative, the right side only takes tighter operators
+        AST::AExpr* right = ParseExpr(precedence + 1);
+        left = Ctx.Make<AST::ABinaryOp>(MakeToken(op), left, right);
+    }
+}
+
+AST::AExpr* CFastParser::ParsePrimary()
+{
+    size_t first = Pos;
+    switch (Peek().Kind)
+    {
+    case ETokenKind::Number:
+        Pos++;
+        return Ctx.Make<AST::ANumber>(MakeToken(first));
+    case ETokenKind::Ident:
+    case ETokenKind::Dollar:
+    {
+        size_t ident = Peek().Kind == ETokenKind::Dollar ? first + 1 : first;
+        if (Tokens[ident].Kind != ETokenKind::Ident)
+            throw Mismatch(ident, "IDENT");
+        size_t open = ident + 1;
+        if (Tokens[open].Kind == ETokenKind::LParen && !DecideSplit(open))
+        {
+            Pos = open + 1;
+            NestDepth++;
+            AST::AExpr* expr = ParseExpr(0);
+            size_t close = Expect(ETokenKind::RParen, "')'");
+            NestDepth--;
+            auto* argList = Ctx.Make<AST::AVector>(MakeToken(open), MakeToken(close));
+            argList->AddChild(expr);
+            return Ctx.Make<AST::ACall>(MakeToken(ident), argList);
+        }
+        Pos = ident + 1;
+        return Ctx.Make<AST::AIdent>(MakeToken(ident));
+    }
+    case ETokenKind::LParen:
+    {
+        Pos++;
+        NestDepth++;
+        AST::AExpr* expr = ParseExpr(0);
+        size_t close = Expect(ETokenKind::RParen, "')'");
+        NestDepth--;
+        return Ctx.Make<AST::AWrappedExpr>(MakeToken(first), MakeToken(close), nullptr, expr);
+    }
+    case ETokenKind::Plus:
+    case ETokenKind::Minus:
+    {
+        Pos++;
+        AST::AExpr* operand = ParseExpr(UnaryOperandPrecedence);
+        return Ctx.Make<AST::AUnaryOp>(MakeToken(first), operand);
+    }
+    case ETokenKind::LCurly:
+    {
+        Pos++;
+        size_t second = ExpectKeyword(KwExpr);
+        NestDepth++;
+        AST::AExpr* expr = ParseExpr(0);
+        size_t close = Expect(ETokenKind::RCurly, "'}'");
+        NestDepth--;
+        return Ctx.Make<AST::AWrappedExpr>(MakeToken(first), MakeToken(close), MakeToken(second),
+                                           expr);
+    }
+    default:
+        break;
+    }
+    throw Mismatch(first, "an expression");
+}
+
+bool CFastParser::DecideSplit(size_t token)
+{
+    // Outside of lists, and inside parentheses within them, the longest expression is the only
+    //  one that can parse
+    if (!bInList || NestDepth > 0)
+        return false;
+    // The enclosing expressions see the token again once an inner one ended before it
+    if (token == LastSplit)
+        return true;
+    if (NextDecision == SplitPlan.size())
+        SplitPlan.push_back(false);
+    bool bSplit = SplitPlan[NextDecision++];
+    if (bSplit)
+        LastSplit = token;
+    return bSplit;
+}
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "ASTContext.h"
+#include "SyntaxTree.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tc
+{
+class FThreadPool;
+}
+
+namespace Nome
+{
+
+// Hand written alternative to the ANTLR generated parser that builds the same AST as CFileBuilder.
+//  Nom.g4 is LL(1) apart from lists of expressions, where a '+' or '-' may either continue an
+//  expression or start the next one. Those are settled the way ANTLR settles them: the longer
+//  expression wins unless the list would then not have the right number of items.
+class CFastParser
+{
+public:
+    // Token text views into source, which must outlive the AST. Tokens are placed at baseOffset in
+    //  buffer bufId, just like with CFileBuilder.
+    CFastParser(AST::CASTContext& ctx, std::string_view source, unsigned int bufId = 0,
+                unsigned int baseOffset = 0);
+
+    // Characters the grammar does not know are reported and skipped, as the ANTLR lexer does
+    void Tokenize();
+    // Commands that fail to parse are reported and left out, so this always returns a file
+    AST::AFile* ParseFile();
+    // Same result as ParseFile, but runs of top level commands are parsed on the pool, each into a
+    //  sub-context of the AST context. Falls back to ParseFile for files with syntax errors, so
+    //  that those are reported and recovered from exactly the same way.
+    AST::AFile* ParseFileParallel(tc::FThreadPool& pool);
+
+    [[nodiscard]] bool HasLexerErrors() const { return bLexerErrors; }
+    [[nodiscard]] bool HasSyntaxErrors() const { return bSyntaxErrors; }
+
+private:
+    enum class ETokenKind : uint8_t
+    {
+        Ident,
+        Number,
+        Keyword,
+        LParen,
+        RParen,
+        Plus,
+        Minus,
+        Times,
+        Div,
+        Pow,
+        Dollar,
+        LCurly,
+        RCurly,
+        // Comparison tokens the lexer knows but no rule uses
+        Other,
+        End
+    };
+
+    struct CLexToken
+    {
+        ETokenKind Kind;
+        // One of the keywords listed in FastParser.cpp, 0 for anything else
+        uint8_t Keyword;
+        uint32_t Offset;
+        uint32_t Length;
+    };
+
+    struct CSyntaxError
+    {
+        size_t Token;
+        std::string Message;
+    };
+
+    const CLexToken& Peek(size_t ahead = 0) const;
+    bool IsKeyword(size_t token, uint8_t keyword) const;
+    bool IsCommandStart(size_t token) const;
+    size_t Expect(ETokenKind kind, const char* what);
+    size_t ExpectKeyword(uint8_t keyword);
+    AST::CToken* MakeToken(size_t token);
+    CSyntaxError Mismatch(size_t token, const std::string& expecting) const;
+    // One based line and zero based column in code points, as ANTLR reports them
+    std::pair<size_t, size_t> GetLineAndColumn(size_t offset) const;
+    void Report(const CSyntaxError& error);
+    // Token index of every top level command, empty if the commands do not balance
+    std::vector<size_t> FindTopLevelCommands() const;
+
+    AST::ACommand* ParseCommand();
+    AST::ACommand* ParseSet();
+    AST::ACommand* ParseDeleteFace();
+    AST::AExpr* ParseIdent();
+    AST::AExpr* ParseIdList();
+    AST::ANamedArgument* ParseFlagArg();
+    AST::ANamedArgument* ParseSurfaceArg();
+    AST::ANamedArgument* ParseExprArg();
+    AST::ANamedArgument* ParseTransformArg();
+    AST::ANamedArgument* ParseColorArg();
+    // Parenthesized list of count expressions
+    AST::AVector* ParseExprVector(size_t count);
+
+    // Parses exactly count expressions followed by a token isStop accepts, backtracking over the
+    //  ambiguous '+' and '-' tokens and calls in between
+    template <typename TStop>
+    void ParseExprs(size_t count, std::vector<AST::AExpr*>& exprs, TStop isStop,
+                    const char* expecting);
+    AST::AExpr* ParseExpr(int minPrecedence);
+    AST::AExpr* ParsePrimary();
+    // Whether to end the current list item at an ambiguous token instead of taking it in
+    bool DecideSplit(size_t token);
+
+    AST::CASTContext& Ctx;
+    std::string_view Source;
+    unsigned int BufId;
+    unsigned int BaseOffset;
+
+    std::vector<CLexToken> Tokens;
+    size_t Pos = 0;
+    bool bLexerErrors = false;
+    bool bSyntaxErrors = false;
+    // Off while parsing part of a file in parallel, whose errors ParseFile reports again
+    bool bPrintErrors = true;
+
+    // State of the list currently being parsed
+    bool bInList = false;
+    int NestDepth = 0;
+    std::vector<bool> SplitPlan;
+    size_t NextDecision = 0;
+    size_t LastSplit = SIZE_MAX;
+};
+
+}
@@ -0,0 +1,214 @@
+#include "PieceTree.h"
+#include <stdexcept>
+
+namespace Nome
+{
+
+CPieceTree::~CPieceTree() { DeleteTree(Root); }
+
+void CPieceTree::Clear()
+{
+    DeleteTree(Root);
+    Root = nullptr;
+    BufIndex.clear();
+}
+
+void CPieceTree::Insert(size_t offset, const CPiece& piece)
+{
+    if (offset > GetLength())
+        throw std::runtime_error("Could not insert text because global offset is out of range");
+    if (piece.Length == 0)
+        return;
+
+    // Typing and appending keep extending the same piece of the add buffer
+    if (offset > 0)
+    {
+        size_t prevStart;
+        CNode* prev = FindNode(offset - 1, prevStart);
+        const CPiece& prevPiece = prev->Piece;
+        if (prevStart + prevPiece.Length == offset && prevPiece.BufId == piece.BufId
+            && prevPiece.Start + prevPiece.Length == piece.Start)
+        {
+            prev->Piece.Length += piece.Length;
+            for (CNode* node = prev; node; node = node->Parent)
+                Update(node);
+            return;
+        }
+    }
+
+    MakeBoundary(offset);
+    auto [left, right] = Split(Root, offset);
+    Root = Merge(Merge(left, NewNode(piece)), right);
+    Root->Parent = nullptr;
+}
+
+void CPieceTree::Remove(size_t offset, size_t length)
+{
+    if (offset + length > GetLength())
+        throw std::runtime_error("Could not remove text because range is out of bounds");
+    if (length == 0)
+        return;
+
+    MakeBoundary(offset);
+    MakeBoundary(offset + length);
+    auto [left, rest] = Split(Root, offset);
+    auto [removed, right] = Split(rest, length);
+    UnindexTree(removed);
+    DeleteTree(removed);
+    Root = Merge(left, right);
+    if (Root)
+        Root->Parent = nullptr;
+}
+
+std::pair<CPiece, size_t> CPieceTree::FindPiece(size_t offset) const
+{
+    size_t nodeStart;
+    const CNode* node = FindNode(offset, nodeStart);
+    if (!node)
+        throw std::runtime_error("Global offset is out of range of the piece table");
+    return { node->Piece, nodeStart };
+}
+
+std::optional<size_t> CPieceTree::BufOffsetToGlobal(int bufId, size_t bufOffset) const
+{
+    auto iter = BufIndex.upper_bound({ bufId, bufOffset });
+    if (iter == BufIndex.begin())
+        return {};
+    --iter;
+    const CNode* node = iter->second;
+    if (node->Piece.BufId != bufId || bufOffset >= node->Piece.Start + node->Piece.Length)
+        return {};
+    return GlobalOffsetOf(node) + bufOffset - node->Piece.Start;
+}
+
+void CPieceTree::Update(CNode* node)
+{
+    node->SubtreeLength = LengthOf(node->Left) + node->Piece.Length + LengthOf(node->Right);
+    if (node->Left)
+        node->Left->Parent = node;
+    if (node->Right)
+        node->Right->Parent = node;
+}
+
+CPieceTree::CNode* CPieceTree::Merge(CNode* left, CNode* right)
+{
+    if (!left)
+        return right;
+    if (!right)
+        return left;
+    if (left->Priority > right->Priority)
+    {
+        left->Right = Merge(left->Right, right);
+        Update(left);
+        return left;
+    }
+    right->Left = Merge(left, right->Left);
+    Update(right);
+    return right;
+}
+
+std::pair<CPieceTree::CNode*, CPieceTree::CNode*> CPieceTree::Split(CNode* node, size_t offset)
+{
+    if (!node)
+        return { nullptr, nullptr };
+    size_t leftLength = LengthOf(node->Left);
+    if (offset <= leftLength)
+    {
+        auto [left, right] = Split(node->Left, offset);
+        node->Left = right;
+        Update(node);
+        if (left)
+            left->Parent = nullptr;
+        return { left, node };
+    }
+    auto [left, right] = Split(node->Right, offset - leftLength - node->Piece.Length);
+    node->Right = left;
+    Update(node);
+    if (right)
+        right->Parent = nullptr;
+    return { node, right };
+}
+
+void CPieceTree::DeleteTree(CNode* node)
+{
+    if (!node)
+        return;
+    DeleteTree(node->Left);
+    DeleteTree(node->Right);
+    delete node;
+}
+
+CPieceTree::CNode* CPieceTree::FindNode(size_t offset, size_t& nodeStart) const
+{
+    CNode* node = Root;
+    size_t base = 0;
+    while (node)
+    {
+        size_t leftEnd = base + LengthOf(node->Left);
+        if (offset < leftEnd)
+            node = node->Left;
+        else if (offset < leftEnd + node->Piece.Length)
+        {
+            nodeStart = leftEnd;
+            return node;
+        }
+        else
+        {
+            base = leftEnd + node->Piece.Length;
+            node = node->Right;
+        }
+    }
+    return nullptr;
+}
+
+size_t CPieceTree::GlobalOffsetOf(const CNode* node)
+{
+    size_t offset = LengthOf(node->Left);
+    for (; node->Parent; node = node->Parent)
+    {
+        if (node == node->Parent->Right)
+            offset += LengthOf(node->Parent->Left) + node->Parent->Piece.Length;
+    }
+    return offset;
+}
+
+void CPieceTree::MakeBoundary(size_t offset)
+{
+    size_t nodeStart;
+    CNode* node = FindNode(offset, nodeStart);
+    if (!node || nodeStart == offset)
+        return;
+
+    size_t headLength = offset - nodeStart;
+    CPiece tail { node->Piece.BufId, node->Piece.Start + headLength,
+                  node->Piece.Length - headLength };
+    node->Piece.Length = headLength;
+    for (CNode* n = node; n; n = n->Parent)
+        Update(n);
+
+    auto [left, right] = Split(Root, offset);
+    Root = Merge(Merge(left, NewNode(tail)), right);
+    Root->Parent = nullptr;
+}
+
+CPieceTree::CNode* CPieceTree::NewNode(const CPiece& piece)
+{
+    // xorshift, the priorities only need to look random
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 17;
+    Seed ^= Seed << 5;
+    auto* node = new CNode { piece, piece.Length, Seed };
+    BufIndex[{ piece.BufId, piece.Start }] = node;
+    return node;
+}
+
+void CPieceTree::UnindexTree(CNode* node)
+{
+    if (!node)
+        return;
+    BufIndex.erase({ node->Piece.BufId, node->Piece.Start });
+    UnindexTree(node->Left);
+    UnindexTree(node->Right);
+}
+
+}
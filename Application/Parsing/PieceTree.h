@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <utility>
+
+namespace Nome
+{
+
+struct CPiece
+{
+    int BufId;
+    size_t Start;
+    size_t Length;
+};
+
+// Pieces of a piece table kept in a treap ordered by text position. Every node caches the length
+//  of its subtree, so going from a global offset to a piece and back is O(log n), as are edits.
+//  Pieces never overlap within a buffer, which lets them be looked up by buffer offset as well.
+class CPieceTree
+{
+public:
+    CPieceTree() = default;
+    CPieceTree(const CPieceTree&) = delete;
+    CPieceTree& operator=(const CPieceTree&) = delete;
+    ~CPieceTree();
+
+    void Clear();
+    [[nodiscard]] size_t GetLength() const { return Root ? Root->SubtreeLength : 0; }
+    [[nodiscard]] size_t GetPieceCount() const { return BufIndex.size(); }
+
+    // Pieces continuing the one right before offset in the same buffer are merged into it
+    void Insert(size_t offset, const CPiece& piece);
+    void Remove(size_t offset, size_t length);
+
+    // Piece containing offset and the global offset it starts at, throws if out of range
+    [[nodiscard]] std::pair<CPiece, size_t> FindPiece(size_t offset) const;
+    [[nodiscard]] std::optional<size_t> BufOffsetToGlobal(int bufId, size_t bufOffset) const;
+
+    template <typename TFunc> void ForEachPiece(TFunc&& func) const
+    {
+        ForEachPiece(Root, func);
+    }
+
+private:
+    struct CNode
+    {
+        CPiece Piece;
+        size_t SubtreeLength;
+        uint32_t Priority;
+        CNode* Left = nullptr;
+        CNode* Right = nullptr;
+        CNode* Parent = nullptr;
+    };
+
+    static size_t LengthOf(const CNode* node) { return node ? node->SubtreeLength : 0; }
+    static void Update(CNode* node);
+    static CNode* Merge(CNode* left, CNode* right);
+    // The first offset characters go left, offset must fall on a piece boundary
+    static std::pair<CNode*, CNode*> Split(CNode* node, size_t offset);
+    static void DeleteTree(CNode* node);
+
+    template <typename TFunc> static void ForEachPiece(const CNode* node, TFunc& func)
+    {
+        if (!node)
+            return;
+        ForEachPiece(node->Left, func);
+        func(node->Piece);
+        ForEachPiece(node->Right, func);
+    }
+
+    CNode* FindNode(size_t offset, size_t& nodeStart) const;
+    static size_t GlobalOffsetOf(const CNode* node);
+    // Splits the piece straddling offset in two
+    void MakeBoundary(size_t offset);
+    CNode* NewNode(const CPiece& piece);
+    void UnindexTree(CNode* node);
+
+    CNode* Root = nullptr;
+    std::map<std::pair<int, size_t>, CNode*> BufIndex;
+    uint32_t Seed = 2463534242u;
+};
+
+}
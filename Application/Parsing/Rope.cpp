@@ -1,136 +1,406 @@
 #include "Rope.h"
+#include <algorithm>
+#include <stdexcept>
 
 namespace Nome
 {
 
-CRope::CRope() {}
+namespace
+{
+
+constexpr size_t MaxLeafLength = 2048;
+constexpr size_t MaxChildren = 16;
 
-CRope::CRope(std::string content) { Content.push_back(content); }
+// Number of parts to cut size items into so that none exceeds maxPart, and their size
+size_t PartCount(size_t size, size_t maxPart) { return (size + maxPart - 1) / maxPart; }
+size_t PartSize(size_t size, size_t count) { return (size + count - 1) / count; }
+
+}
 
-std::string CRope::Assemble() const
+struct CRope::CNode
 {
-    std::string result;
-    for (const auto& str : Content)
+    using CSiblings = std::vector<std::unique_ptr<CNode>>;
+
+    bool bLeaf = true;
+    size_t Length = 0;
+    size_t Lines = 0;
+    // Only used by leaves
+    std::string Text;
+    // Only used by inner nodes, all leaves are at the same depth
+    CSiblings Children;
+
+    static std::unique_ptr<CNode> MakeLeaf(std::string text)
     {
-        result.append(str);
+        auto node = std::make_unique<CNode>();
+        node->Text = std::move(text);
+        node->Recount();
+        return node;
     }
-    return result;
-}
 
-size_t CRope::GetSize() const
-{
-    size_t result = 0;
-    for (const auto& str : Content)
+    static std::unique_ptr<CNode> MakeInner(CSiblings children)
     {
-        result += str.size();
+        auto node = std::make_unique<CNode>();
+        node->bLeaf = false;
+        node->Children = std::move(children);
+        node->Recount();
+        return node;
     }
-    return result;
-}
 
-CRope::CLocation CRope::GetLoc(size_t index, size_t offset) const
-{
-    auto indexIter = LocationMap.find(index);
-    if (indexIter != LocationMap.end())
+    void Recount()
     {
-        auto offsetIter = indexIter->second.find(offset);
-        if (offsetIter != indexIter->second.end())
+        if (bLeaf)
         {
-            // Such location already exists
-            return CLocation(offsetIter->second);
+            Length = Text.size();
+            Lines = std::count(Text.begin(), Text.end(), '\n');
+            return;
+        }
+        Length = 0;
+        Lines = 0;
+        for (const auto& child : Children)
+        {
+            Length += child->Length;
+            Lines += child->Lines;
         }
     }
 
-    RealLocRef ref = LocationPool.GetNewElement(tc::kAddToFront);
-    ref->Index = index;
-    ref->Offset = offset;
-    ref->RefCount = 0;
+    // Returns the nodes this one overflowed into, they belong right after it in its parent
+    CSiblings Insert(size_t offset, std::string_view text)
+    {
+        CSiblings overflow;
+        if (bLeaf)
+        {
+            Text.insert(offset, text);
+            if (Text.size() > MaxLeafLength)
+            {
+                size_t partSize = PartSize(Text.size(), PartCount(Text.size(), MaxLeafLength));
+                for (size_t start = partSize; start < Text.size(); start += partSize)
+                    overflow.push_back(MakeLeaf(Text.substr(start, partSize)));
+                Text.resize(partSize);
+                Text.shrink_to_fit();
+            }
+            Recount();
+            return overflow;
+        }
 
-    LocationMap[index][offset] = ref;
+        // At a boundary the text goes to the end of the earlier child
+        size_t i = 0;
+        for (; i + 1 < Children.size() && offset > Children[i]->Length; i++)
+            offset -= Children[i]->Length;
+        auto childOverflow = Children[i]->Insert(offset, text);
+        Children.insert(Children.begin() + i + 1, std::make_move_iterator(childOverflow.begin()),
+                        std::make_move_iterator(childOverflow.end()));
+        if (Children.size() > MaxChildren)
+            overflow = SplitChildren();
+        Recount();
+        return overflow;
+    }
 
-    return CLocation(ref);
-}
+    // Keeps the first group of children and hands the rest out as new siblings
+    CSiblings SplitChildren()
+    {
+        CSiblings overflow;
+        size_t partSize = PartSize(Children.size(), PartCount(Children.size(), MaxChildren));
+        for (size_t start = partSize; start < Children.size(); start += partSize)
+        {
+            size_t end = std::min(start + partSize, Children.size());
+            CSiblings group(std::make_move_iterator(Children.begin() + start),
+                            std::make_move_iterator(Children.begin() + end));
+            overflow.push_back(MakeInner(std::move(group)));
+        }
+        Children.resize(partSize);
+        Recount();
+        return overflow;
+    }
 
-CRope::CLocation CRope::GetLocFromOffset(size_t offset) const
-{
-    size_t prefixLen = 0;
-    for (size_t currIndex = 0; currIndex < Content.size(); currIndex++)
+    void Erase(size_t offset, size_t length)
     {
-        if (prefixLen <= offset && offset < prefixLen + Content[currIndex].size())
+        if (bLeaf)
         {
-            return GetLoc(currIndex, offset - prefixLen);
+            Text.erase(offset, length);
+            Recount();
+            return;
         }
-        prefixLen += Content[currIndex].size();
+
+        size_t end = offset + length;
+        size_t childStart = 0;
+        for (auto& child : Children)
+        {
+            size_t childLength = child->Length;
+            size_t from = std::max(offset, childStart);
+            size_t to = std::min(end, childStart + childLength);
+            if (from < to)
+                child->Erase(from - childStart, to - from);
+            childStart += childLength;
+            if (childStart >= end)
+                break;
+        }
+
+        Children.erase(std::remove_if(Children.begin(), Children.end(),
+                                      [](const auto& child) { return child->Length == 0; }),
+                       Children.end());
+        // Merge neighbours that fit in one node so erasing does not leave a trail of slivers
+        for (size_t i = 0; i + 1 < Children.size();)
+        {
+            CNode& left = *Children[i];
+            CNode& right = *Children[i + 1];
+            bool bFits = left.bLeaf ? left.Length + right.Length <= MaxLeafLength
+                                    : left.Children.size() + right.Children.size() <= MaxChildren;
+            if (!bFits)
+            {
+                i++;
+                continue;
+            }
+            if (left.bLeaf)
+                left.Text += right.Text;
+            else
+                std::move(right.Children.begin(), right.Children.end(),
+                          std::back_inserter(left.Children));
+            left.Recount();
+            Children.erase(Children.begin() + i + 1);
+        }
+        Recount();
     }
-    throw "Offset out of range";
-}
 
-CRope::CLocation CRope::AdvanceLoc(CLocation loc, size_t offset) const
-{
-    size_t newIndex = loc.Reference->Index, newOffset = loc.Reference->Offset;
-    while (offset)
+    void AppendTo(std::string& out, size_t offset, size_t length) const
+    {
+        if (bLeaf)
+        {
+            out.append(Text, offset, length);
+            return;
+        }
+        size_t end = offset + length;
+        size_t childStart = 0;
+        for (const auto& child : Children)
+        {
+            size_t from = std::max(offset, childStart);
+            size_t to = std::min(end, childStart + child->Length);
+            if (from < to)
+                child->AppendTo(out, from - childStart, to - from);
+            childStart += child->Length;
+            if (childStart >= end)
+                break;
+        }
+    }
+
+    // Number of newlines before offset
+    size_t CountLines(size_t offset) const
     {
-        if (newIndex >= Content.size())
-            throw "Index out of range";
+        const CNode* node = this;
+        size_t lines = 0;
+        while (!node->bLeaf)
+        {
+            size_t i = 0;
+            for (; i + 1 < node->Children.size() && offset >= node->Children[i]->Length; i++)
+            {
+                offset -= node->Children[i]->Length;
+                lines += node->Children[i]->Lines;
+            }
+            node = node->Children[i].get();
+        }
+        return lines + std::count(node->Text.begin(), node->Text.begin() + offset, '\n');
+    }
 
-        size_t rowLeft = Content[newIndex].size() - 1 - newOffset;
-        if (offset <= rowLeft)
+    // Offset right after the line-th newline, line must be between 1 and Lines
+    size_t FindLineStart(size_t line) const
+    {
+        const CNode* node = this;
+        size_t offset = 0;
+        while (!node->bLeaf)
         {
-            newOffset += offset;
-            offset = 0;
+            size_t i = 0;
+            for (; line > node->Children[i]->Lines; i++)
+            {
+                line -= node->Children[i]->Lines;
+                offset += node->Children[i]->Length;
+            }
+            node = node->Children[i].get();
         }
-        else
+        size_t pos = 0;
+        for (; line > 0; line--)
+            pos = node->Text.find('\n', pos) + 1;
+        return offset + pos;
+    }
+
+    char At(size_t offset) const
+    {
+        const CNode* node = this;
+        while (!node->bLeaf)
         {
-            newIndex++;
-            offset -= rowLeft;
+            size_t i = 0;
+            for (; offset >= node->Children[i]->Length; i++)
+                offset -= node->Children[i]->Length;
+            node = node->Children[i].get();
         }
+        return node->Text[offset];
     }
-    return GetLoc(newIndex, newOffset);
+};
+
+CRope::CRope()
+    : Root(CNode::MakeLeaf({}))
+{
 }
 
-void CRope::InsertAt(CRope::CLocation loc, const std::string& text)
+CRope::CRope(std::string_view content)
+    : CRope()
 {
-    RealLocRef realLoc = loc.Reference;
+    Insert(0, content);
+}
+
+CRope::CRope(CRope&&) noexcept = default;
+CRope& CRope::operator=(CRope&&) noexcept = default;
+CRope::~CRope() = default;
+
+std::string CRope::Assemble() const { return Substr(0, GetSize()); }
+
+std::string CRope::Substr(size_t offset, size_t length) const
+{
+    std::string result;
+    AppendTo(result, offset, length);
+    return result;
+}
+
+void CRope::AppendTo(std::string& out, size_t offset, size_t length) const
+{
+    if (offset > GetSize())
+        throw std::out_of_range("Rope offset out of range");
+    length = std::min(length, GetSize() - offset);
+    out.reserve(out.size() + length);
+    Root->AppendTo(out, offset, length);
+}
+
+size_t CRope::GetSize() const { return Root->Length; }
+
+size_t CRope::GetLineCount() const { return Root->Lines + 1; }
+
+char CRope::At(size_t offset) const
+{
+    if (offset >= GetSize())
+        throw std::out_of_range("Rope offset out of range");
+    return Root->At(offset);
+}
+
+size_t CRope::OffsetToLine(size_t offset) const
+{
+    return Root->CountLines(std::min(offset, GetSize()));
+}
+
+size_t CRope::LineToOffset(size_t line) const
+{
+    if (line == 0)
+        return 0;
+    if (line > Root->Lines)
+        return GetSize();
+    return Root->FindLineStart(line);
+}
+
+void CRope::Insert(size_t offset, std::string_view text) { Replace(offset, 0, text); }
+
+void CRope::Erase(size_t offset, size_t length) { Replace(offset, length, {}); }
 
-    size_t textLen = text.size();
+void CRope::Replace(size_t offset, size_t length, std::string_view text)
+{
+    if (offset > GetSize() || length > GetSize() - offset)
+        throw std::out_of_range("Rope range out of range");
+    if (length == 0 && text.empty())
+        return;
 
-    // Move locations after loc by textLen
-    auto indexIter = LocationMap.find(realLoc->Index);
-    if (indexIter != LocationMap.end())
+    if (length > 0)
+    {
+        Root->Erase(offset, length);
+        CollapseRoot();
+    }
+    if (!text.empty())
     {
-        std::map<size_t, RealLocRef> newOffsetMap;
-        auto& offsetMap = indexIter->second;
-        for (auto offsetIter = offsetMap.begin(); offsetIter != offsetMap.end(); ++offsetIter)
+        auto overflow = Root->Insert(offset, text);
+        // Grow a level for as long as the root overflows
+        while (!overflow.empty())
         {
-            if (offsetIter->second->Offset >= realLoc->Offset)
-                offsetIter->second->Offset += textLen;
-            newOffsetMap.insert({ offsetIter->second->Offset, offsetIter->second });
+            overflow.insert(overflow.begin(), std::move(Root));
+            Root = CNode::MakeInner(std::move(overflow));
+            overflow = Root->Children.size() > MaxChildren ? Root->SplitChildren()
+                                                           : CNode::CSiblings {};
         }
-        LocationMap.insert_or_assign(realLoc->Index, newOffsetMap);
     }
+    RecordEdit(offset, length, text.size());
+}
+
+CRope::CAnchor CRope::CreateAnchor(size_t offset)
+{
+    if (offset > GetSize())
+        return {};
+    size_t id;
+    if (FreeAnchors.empty())
+    {
+        id = Anchors.size();
+        Anchors.emplace_back();
+    }
+    else
+    {
+        id = FreeAnchors.back();
+        FreeAnchors.pop_back();
+    }
+    Anchors[id] = { offset, EditBase + Edits.size(), true };
+    return CAnchor(id);
+}
+
+size_t CRope::GetAnchorOffset(CAnchor anchor) const
+{
+    auto& state = Anchors.at(anchor.Id);
+    ResolveAnchor(state);
+    return state.Offset;
+}
 
-    // Actually modify the string
-    Content[realLoc->Index].insert(realLoc->Offset, text);
+void CRope::ReleaseAnchor(CAnchor anchor)
+{
+    if (!anchor.IsValid() || !Anchors.at(anchor.Id).bLive)
+        return;
+    Anchors[anchor.Id].bLive = false;
+    FreeAnchors.push_back(anchor.Id);
 }
 
-void CRope::Replace(CRope::CLocation leftLoc, CRope::CLocation rightLoc, const std::string& text)
+void CRope::RecordEdit(size_t offset, size_t removed, size_t inserted)
 {
-    throw "Unimplemented";
+    if (Anchors.size() == FreeAnchors.size())
+    {
+        // Nobody is looking, so there is nothing to replay later
+        EditBase += Edits.size() + 1;
+        Edits.clear();
+        return;
+    }
+
+    Edits.push_back({ offset, removed, inserted });
+    // Bring every anchor up to date once the log outgrows them, which keeps both the log and the
+    //  replay cost per anchor bounded
+    if (Edits.size() > std::max<size_t>(64, Anchors.size()))
+    {
+        for (auto& state : Anchors)
+            if (state.bLive)
+                ResolveAnchor(state);
+        EditBase += Edits.size();
+        Edits.clear();
+    }
 }
 
-void CRope::GarbageCollectLocations() const
+void CRope::ResolveAnchor(CAnchorState& state) const
 {
-    for (auto iter = LocationPool.begin(); iter != LocationPool.end(); ++iter)
+    size_t version = EditBase + Edits.size();
+    for (size_t v = state.Version; v < version; v++)
     {
-        if (iter->RefCount == 0)
-        {
-            // Erase from map
-            LocationMap.at(iter->Index).erase(iter->Offset);
-            // Delete from pool
-            LocationPool.FreeElement(iter);
-        }
+        const CEdit& edit = Edits[v - EditBase];
+        if (state.Offset >= edit.Offset + edit.Removed)
+            state.Offset = state.Offset - edit.Removed + edit.Inserted;
+        else if (state.Offset > edit.Offset)
+            state.Offset = edit.Offset;
     }
+    state.Version = version;
 }
 
-void CRope::SplitRow(const CRope::CRealLocation& where) { throw "Unimplemented"; }
+void CRope::CollapseRoot()
+{
+    while (!Root->bLeaf && Root->Children.size() == 1)
+        Root = std::move(Root->Children[0]);
+    if (!Root->bLeaf && Root->Children.empty())
+        Root = CNode::MakeLeaf({});
+}
 
 }
@@ -1,77 +1,93 @@
 #pragma once
-#include <LightRefBase.h>
-#include <VectorPool.h>
-#include <map>
+#include <cstddef>
+#include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Nome
 {
 
-// A data structure that holds a list of strings to allow fast update
-// Note: this is not yet a proper implementation of the rope ADT. Will change in the future.
-class CRope : public tc::TLightRefBase<CRope>
+// Text stored as a B-tree of chunks. Every node caches the length and newline count of its
+//  subtree, so offset and line lookups as well as edits are O(log n) regardless of file size.
+class CRope
 {
-    class CRealLocation
-    {
-    public:
-        // Select which string
-        size_t Index;
-        // An offset into the string
-        size_t Offset;
-
-        int32_t RefCount = 0;
-    };
-
-    typedef tc::TVectorPool<CRealLocation>::VectorPoolReference RealLocRef;
-
 public:
-    class CLocation
+    // Stable position in the text that follows edits made elsewhere. Anchors are not touched on
+    //  every edit, instead the edit is logged and replayed when the anchor is next read.
+    class CAnchor
     {
     public:
-        CLocation() {}
-
-        CLocation(RealLocRef ref)
-            : Reference(ref)
-        {
-            if (Reference.IsValid())
-                Reference->RefCount++;
-        }
-
-        ~CLocation()
-        {
-            if (Reference.IsValid())
-                Reference->RefCount--;
-        }
-
-        bool IsValid() const { return Reference.IsValid(); }
+        CAnchor() = default;
+        [[nodiscard]] bool IsValid() const { return Id != InvalidId; }
 
     private:
         friend class CRope;
-        RealLocRef Reference;
+        static constexpr size_t InvalidId = std::numeric_limits<size_t>::max();
+        explicit CAnchor(size_t id)
+            : Id(id)
+        {
+        }
+        size_t Id = InvalidId;
     };
 
     CRope();
-    CRope(std::string content);
+    explicit CRope(std::string_view content);
+    CRope(CRope&&) noexcept;
+    CRope& operator=(CRope&&) noexcept;
+    ~CRope();
+
+    [[nodiscard]] std::string Assemble() const;
+    [[nodiscard]] std::string Substr(size_t offset, size_t length) const;
+    void AppendTo(std::string& out, size_t offset, size_t length) const;
+    [[nodiscard]] size_t GetSize() const;
+    [[nodiscard]] size_t GetLineCount() const;
+    [[nodiscard]] char At(size_t offset) const;
+
+    // Zero based line containing offset, and the offset where a line starts
+    [[nodiscard]] size_t OffsetToLine(size_t offset) const;
+    [[nodiscard]] size_t LineToOffset(size_t line) const;
+
+    void Insert(size_t offset, std::string_view text);
+    void Erase(size_t offset, size_t length);
+    void Replace(size_t offset, size_t length, std::string_view text);
+
+    // Text inserted right at an anchor goes before it, an anchor inside erased text moves to the
+    //  start of the erased range
+    CAnchor CreateAnchor(size_t offset);
+    [[nodiscard]] size_t GetAnchorOffset(CAnchor anchor) const;
+    void ReleaseAnchor(CAnchor anchor);
 
-    std::string Assemble() const;
-    size_t GetSize() const;
+private:
+    struct CNode;
 
-    CLocation GetLoc(size_t index, size_t offset) const;
-    CLocation GetLocFromOffset(size_t offset) const;
-    CLocation AdvanceLoc(CLocation loc, size_t offset) const;
+    struct CEdit
+    {
+        size_t Offset;
+        size_t Removed;
+        size_t Inserted;
+    };
 
-    void InsertAt(CLocation loc, const std::string& text);
-    void Replace(CLocation leftLoc, CLocation rightLoc, const std::string& text);
+    struct CAnchorState
+    {
+        size_t Offset;
+        // Number of edits already applied to Offset
+        size_t Version;
+        bool bLive;
+    };
 
-    void GarbageCollectLocations() const;
+    void RecordEdit(size_t offset, size_t removed, size_t inserted);
+    void ResolveAnchor(CAnchorState& anchor) const;
+    void CollapseRoot();
 
-private:
-    void SplitRow(const CRealLocation& where);
+    std::unique_ptr<CNode> Root;
 
-    std::vector<std::string> Content;
-    mutable tc::TVectorPool<CRealLocation> LocationPool;
-    mutable std::map<size_t, std::map<size_t, RealLocRef>> LocationMap;
+    mutable std::vector<CAnchorState> Anchors;
+    std::vector<size_t> FreeAnchors;
+    std::vector<CEdit> Edits;
+    // Version of the first edit still in the log
+    size_t EditBase = 0;
 };
 
 }
@@ -1,8 +1,14 @@
 #include "SourceManager.h"
+#include "ASTSnapshot.h"
+#include "FastParser.h"
 #include "NomLexer.h"
 #include "NomParser.h"
 #include "SyntaxTreeBuilder.h"
 #include "antlr4-runtime.h"
+#include <ThreadPool.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <stack>
 #include <utility>
 
@@ -15,6 +21,8 @@ using namespace antlr4;
 const int CSourceManager::OrigBuf;
 const int CSourceManager::AddBuf;
 
+static constexpr uint32_t ASTSectionTag = CCacheFile::MakeTag("AST ");
+
 class CMyErrorListener : public BaseErrorListener
 {
 public:
@@ -33,6 +41,12 @@ private:
 CSourceManager::CSourceManager(std::string mainSource)
     : MainSource(std::move(mainSource))
 {
+    const char* parser = std::getenv("NOME_PARSER");
+    ParserKind = EParserKind::Antlr;
+    if (parser && std::strcmp(parser, "fast") == 0)
+        ParserKind = EParserKind::Fast;
+    else if (parser && std::strcmp(parser, "parallel") == 0)
+        ParserKind = EParserKind::Parallel;
 }
 
 bool CSourceManager::ParseMainSource()
@@ -41,144 +55,231 @@ bool CSourceManager::ParseMainSource()
     std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
     ifs.close();
 
+    // Drops the previous AST in one go, everything handed out by the context is invalid now
+    ASTContext.Reset();
+    ASTRoot = nullptr;
     MainSourceBuffer = CStringBuffer(content);
-    PieceTable.emplace_back(OrigBuf, 0, content.length());
+    PieceTable.Clear();
+    AddBuffer.clear();
+    PieceTable.Insert(0, { OrigBuf, 0, content.length() });
+
+    MainSourceText = ASTContext.CopyString(content);
+    bLoadedFromCache = false;
+    Cache.Clear();
+    if (bUseCache)
+    {
+        SourceHash = CCacheFile::HashSource(content);
+        auto section = Cache.Load(CCacheFile::GetPathFor(MainSource), SourceHash)
+            ? Cache.FindSection(ASTSectionTag)
+            : std::nullopt;
+        try
+        {
+            if (section)
+                ASTRoot = CASTSnapshot::Read(*section, ASTContext, MainSourceText);
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "Ignoring the cached AST: " << e.what() << std::endl;
+            ASTRoot = nullptr;
+        }
+        bLoadedFromCache = ASTRoot != nullptr;
+        if (!bLoadedFromCache)
+            Cache.Clear();
+    }
+
+    bool bSucceeded = true;
+    if (!ASTRoot)
+        ASTRoot = ParseSource(MainSourceText, OrigBuf, 0, true, bSucceeded);
+    ASTContext.SetAstRoot(ASTRoot);
+    bCacheable = bUseCache && bSucceeded;
+
+    if (bPrintAST)
+    {
+        std::cout << "====== Debug Print AST ======" << std::endl;
+        std::cout << *ASTRoot;
+        std::cout << "====== End Debug Print AST ======" << std::endl;
+    }
+
+    return bSucceeded;
+}
+
+AST::AFile* CSourceManager::ParseSource(std::string_view source, unsigned int bufId,
+                                        unsigned int baseOffset, bool bMainSource,
+                                        bool& bSucceeded)
+{
+    auto reportStage = [&](const char* stage) {
+        if (bMainSource && StageCallback)
+            StageCallback(stage);
+    };
 
-    ANTLRInputStream input(content);
+    reportStage("parse");
+    if (ParserKind != EParserKind::Antlr)
+    {
+        CFastParser parser(ASTContext, source, bufId, baseOffset);
+        parser.Tokenize();
+        reportStage("build");
+        // A reparse covers a handful of commands, not worth spreading out
+        auto* file = ParserKind == EParserKind::Parallel && bMainSource
+            ? parser.ParseFileParallel(tc::FThreadPool::Get())
+            : parser.ParseFile();
+        reportStage("done");
+        bSucceeded = !parser.HasSyntaxErrors() && (bMainSource || !parser.HasLexerErrors());
+        return file;
+    }
+
+    ANTLRInputStream input(source.data(), source.size());
     NomLexer lexer(&input);
     CommonTokenStream tokens(&lexer);
-
     NomParser parser(&tokens);
     CMyErrorListener errorListener;
+    if (!bMainSource)
+        lexer.addErrorListener(&errorListener);
     parser.addErrorListener(&errorListener);
     auto* tree = parser.file();
+    bSucceeded = !errorListener.bDidErrorHappen;
+    // A reparse is thrown away on errors, so do not bother building it
+    if (!bSucceeded && !bMainSource)
+        return nullptr;
+
+    reportStage("build");
+    CFileBuilder builder(ASTContext, source, bufId, baseOffset);
+    auto* file = builder.visitFile(tree).as<AST::AFile*>();
+    reportStage("done");
+    return file;
+}
 
-    CFileBuilder builder(MainSourceBuffer);
-    ASTRoot = builder.visitFile(tree);
-    ASTContext.SetAstRoot(ASTRoot);
+bool CSourceManager::SaveCache(CCacheFile::TSections extraSections) const
+{
+    // Edits only ever add to the add buffer or remove text, either shows
+    bool bEdited = !AddBuffer.empty() || PieceTable.GetLength() != MainSourceText.size();
+    if (!bCacheable || !ASTRoot || bEdited)
+        return false;
+    extraSections.emplace_back(ASTSectionTag, CASTSnapshot::Write(*ASTRoot, MainSourceText));
+    return CCacheFile::Save(CCacheFile::GetPathFor(MainSource), SourceHash, extraSections);
+}
+
+std::optional<CReparseResult> CSourceManager::ReparseText(const std::string& newText)
+{
+    if (!ASTRoot)
+        return {};
+
+    // The edit is whatever lies between the common prefix and suffix
+    const std::string oldText = CollectText();
+    size_t commonLen = std::min(oldText.size(), newText.size());
+    size_t prefix = 0;
+    while (prefix < commonLen && oldText[prefix] == newText[prefix])
+        prefix++;
+    size_t suffix = 0;
+    while (suffix < commonLen - prefix
+           && oldText[oldText.size() - 1 - suffix] == newText[newText.size() - 1 - suffix])
+        suffix++;
+    if (prefix == oldText.size() && prefix == newText.size())
+        return CReparseResult {};
+    size_t editBegin = prefix;
+    size_t editEnd = oldText.size() - suffix;
+
+    // Reparse everything from the end of the last untouched command before the edit to the start
+    //  of the first untouched one after it, so that comments opened or closed in between are seen.
+    //  A command merely touching the edit counts as changed, the edit may extend a keyword.
+    auto commands = ASTRoot->GetCommands();
+    size_t first = 0;
+    size_t last = commands.size();
+    size_t regionBegin = 0;
+    size_t regionEnd = oldText.size();
+    for (size_t i = 0; i < commands.size(); i++)
+    {
+        auto range = GetCommandRange(commands[i]);
+        if (!range)
+            return {};
+        auto [begin, end] = *range;
+        if (end < editBegin)
+        {
+            first = i + 1;
+            regionBegin = end;
+        }
+        else if (begin > editEnd)
+        {
+            last = i;
+            regionEnd = begin;
+            break;
+        }
+    }
 
-    std::cout << "====== Debug Print AST ======" << std::endl;
-    std::cout << *ASTRoot;
-    std::cout << "====== End Debug Print AST ======" << std::endl;
+    size_t newRegionEnd = regionEnd + newText.size() - oldText.size();
+    std::string regionText = newText.substr(regionBegin, newRegionEnd - regionBegin);
+
+    // The region moves into the add buffer as a single piece, which is where its tokens point
+    size_t addBufStart = AddBuffer.length();
+    bool bSucceeded;
+    auto* regionFile = ParseSource(ASTContext.CopyString(regionText), AddBuf,
+                                   static_cast<unsigned int>(addBufStart), false, bSucceeded);
+    if (!bSucceeded)
+        return {};
+
+    if (regionEnd > regionBegin)
+        RemoveText(regionBegin, regionEnd - regionBegin);
+    if (!regionText.empty())
+        InsertText(regionBegin, regionText);
+
+    CReparseResult result;
+    result.RemovedCommands.assign(commands.begin() + first, commands.begin() + last);
+    result.AddedCommands = regionFile->GetCommands();
+    ASTRoot->ReplaceCommands(first, last - first, result.AddedCommands);
+    return result;
+}
 
-    return !errorListener.bDidErrorHappen;
+std::optional<std::pair<size_t, size_t>> CSourceManager::GetCommandRange(
+    const AST::ACommand* command) const
+{
+    auto* openToken = command->GetOpenToken();
+    auto* closeToken = command->GetCloseToken();
+    if (!openToken || !closeToken || openToken->IsLocInvalid() || closeToken->IsLocInvalid())
+        return {};
+    auto begin = BufOffsetToGlobal(openToken->GetLocation().BufId, openToken->GetLocation().Start);
+    auto end = BufOffsetToGlobal(closeToken->GetLocation().BufId, closeToken->GetLocation().Start);
+    if (!begin || !end)
+        return {};
+    return std::make_pair(*begin, *end + closeToken->ToString().length());
 }
 
 void CSourceManager::InsertText(size_t globalOffset, const std::string& text)
 {
-    auto [pieceIndex, currOff] = FindPieceIndexAndOffset(globalOffset);
-
     // Append new text into append buffer
     size_t addBufStart = AddBuffer.length();
     AddBuffer.append(text);
-
-    // Split and make 3 new pieces
-    auto [bufId, bufStart, origLen] = PieceTable[pieceIndex];
-    PieceTable.erase(PieceTable.begin() + pieceIndex);
-    std::vector<std::tuple<int, size_t, size_t>> newPieces;
-    if (globalOffset != currOff)
-        newPieces.emplace_back(bufId, bufStart, globalOffset - currOff);
-    newPieces.emplace_back(AddBuf, addBufStart, text.length());
-    newPieces.emplace_back(bufId, bufStart + globalOffset - currOff,
-                           origLen - (globalOffset - currOff));
-    PieceTable.insert(PieceTable.begin() + pieceIndex, newPieces.begin(), newPieces.end());
+    PieceTable.Insert(globalOffset, { AddBuf, addBufStart, text.length() });
 }
 
 void CSourceManager::RemoveText(size_t globalOffset, size_t length)
 {
-    auto [pieceIndex, pieceStart] = FindPieceIndexAndOffset(globalOffset);
-    auto [bufId, bufStart, pieceLen] = PieceTable[pieceIndex];
-    auto offsetInPiece = globalOffset - pieceStart;
-    if (offsetInPiece + length <= pieceLen)
-    {
-        // Removal only affects this piece, might need to split
-        // This is the base case where the removed piece does not offshoot
-        std::vector<std::tuple<int, size_t, size_t>> newPieces;
-        if (offsetInPiece != 0)
-            newPieces.emplace_back(bufId, bufStart, offsetInPiece);
-        if (offsetInPiece + length < pieceLen)
-            newPieces.emplace_back(bufId, bufStart + offsetInPiece + length,
-                                   pieceLen - offsetInPiece - length);
-
-        if (newPieces.empty())
-            PieceTable.erase(PieceTable.begin() + pieceIndex);
-        else if (newPieces.size() == 1)
-            PieceTable[pieceIndex] = newPieces[0];
-        else
-        {
-            PieceTable.erase(PieceTable.begin() + pieceIndex);
-            PieceTable.insert(PieceTable.begin() + pieceIndex, newPieces.begin(), newPieces.end());
-        }
-    }
-    else
-    {
-        auto lenWithin = pieceLen - offsetInPiece;
-        auto restLen = length - lenWithin;
-        RemoveText(globalOffset, lenWithin);
-        RemoveText(globalOffset, restLen);
-    }
+    PieceTable.Remove(globalOffset, length);
 }
 
 std::string CSourceManager::CollectText() const
 {
     std::string result;
-    const auto& origBuf = MainSourceBuffer.GetAsString();
-    for (auto [bufId, bufOffset, pieceLen] : PieceTable)
-    {
+    result.reserve(PieceTable.GetLength());
+    PieceTable.ForEachPiece([&](const CPiece& piece) {
         // GetPieceText
-        if (bufId == OrigBuf)
-        {
-            result += origBuf.substr(bufOffset, pieceLen);
-        }
-        else if (bufId == AddBuf)
-        {
-            result += AddBuffer.substr(bufOffset, pieceLen);
-        }
+        if (piece.BufId == OrigBuf)
+            MainSourceBuffer.AppendRange(result, piece.Start, piece.Length);
+        else if (piece.BufId == AddBuf)
+            result.append(AddBuffer, piece.Start, piece.Length);
         else
             throw std::runtime_error("bufId corrupted in piece table");
-    }
+    });
     return result;
 }
 
-std::pair<size_t, size_t> CSourceManager::FindPieceIndexAndOffset(size_t globalOffset) const
-{
-    // GetPieceIndex
-    size_t currOff = 0;
-    size_t pieceIndex = 0;
-    bool bFound = false;
-    for (auto [bufId, start, len] : PieceTable)
-    {
-        auto nextOff = currOff + len;
-        if (globalOffset >= currOff && globalOffset < nextOff)
-        {
-            bFound = true;
-            break;
-        }
-        currOff = nextOff;
-        pieceIndex++;
-    }
-    if (!bFound)
-        throw std::runtime_error("Could not insert text because global offset is out of range");
-    return { pieceIndex, currOff };
-}
-
 std::optional<size_t> CSourceManager::BufOffsetToGlobal(int bufId, size_t bufOffset) const
 {
-    size_t currLen = 0;
-    for (auto [pieceBuf, start, len] : PieceTable)
-    {
-        if (pieceBuf == bufId && start <= bufOffset && bufOffset < start + len)
-            return currLen + bufOffset - start;
-        currLen += len;
-    }
-    return {};
+    return PieceTable.BufOffsetToGlobal(bufId, bufOffset);
 }
 
 std::pair<int, size_t> CSourceManager::GlobalToBufOffset(size_t globalOffset) const
 {
-    auto [pieceIndex, pieceOffset] = FindPieceIndexAndOffset(globalOffset);
-    auto [bufId, bufOffset, pieceLen] = PieceTable[pieceIndex];
-    return { bufId, bufOffset + pieceOffset };
+    auto [piece, pieceStart] = PieceTable.FindPiece(globalOffset);
+    return { piece.BufId, piece.Start + globalOffset - pieceStart };
 }
 
 std::optional<size_t> CSourceManager::RemoveTokens(const std::vector<AST::CToken*>& tokenList)
@@ -250,10 +351,10 @@ bool CSourceManager::AppendCmdAfter(AST::ACommand* parent, AST::ACommand* after,
 bool Nome::CSourceManager::AppendCmdEndOfFile(Nome::AST::ACommand* newCommand)
 {
     size_t offset = 0;
-    if (!ASTRoot->GetCommands().empty())
+    if (auto* lastCommand = ASTRoot->GetLastCommand())
     {
         std::vector<AST::CToken*> tokenList;
-        ASTRoot->GetCommands().back()->CollectTokens(tokenList);
+        lastCommand->CollectTokens(tokenList);
 
         AST::CToken* afterToken = tokenList.back();
         const auto& afterLoc = afterToken->GetLocation();
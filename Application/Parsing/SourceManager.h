@@ -1,15 +1,35 @@
 #pragma once
 #include "ASTContext.h"
+#include "CacheFile.h"
+#include "PieceTree.h"
 #include "StringBuffer.h"
 #include "SyntaxTree.h"
+#include <functional>
 #include <optional>
 #include <string>
-#include <tuple>
+#include <string_view>
 #include <vector>
 
 namespace Nome
 {
 
+// Top level commands swapped by an incremental reparse, in file order
+struct CReparseResult
+{
+    std::vector<AST::ACommand*> RemovedCommands;
+    std::vector<AST::ACommand*> AddedCommands;
+};
+
+enum class EParserKind
+{
+    // The parser generated from Nom.g4
+    Antlr,
+    // CFastParser, which builds the same AST several times faster
+    Fast,
+    // CFastParser with the top level commands of the main source split over the thread pool
+    Parallel
+};
+
 // Abstracts away all the file management mess so that we can focus on
 //   the high level bits.
 class CSourceManager
@@ -22,13 +42,43 @@ public:
 
     bool ParseMainSource();
 
+    // Defaults to the generated parser, setting NOME_PARSER=fast or NOME_PARSER=parallel in the
+    //  environment picks the hand written one instead. Both build the same AST for files that
+    //  parse. After a syntax error they differ: ANTLR repairs the failed command by inserting or
+    //  dropping tokens, the hand written one drops the whole command, so the scene can differ.
+    void SetParserKind(EParserKind kind) { ParserKind = kind; }
+    [[nodiscard]] EParserKind GetParserKind() const { return ParserKind; }
+
+    // Off by default. When on, ParseMainSource reads the AST from the file's CCacheFile if the
+    //  source has not changed since SaveCache wrote it.
+    void SetUseCache(bool bUse) { bUseCache = bUse; }
+    [[nodiscard]] bool WasLoadedFromCache() const { return bLoadedFromCache; }
+    // Holds the sections other layers cached, only after a cache hit
+    [[nodiscard]] const CCacheFile& GetCache() const { return Cache; }
+    // Writes the AST together with extraSections. Does nothing unless the cache is on, the main
+    //  source parsed cleanly and its text has not been edited since.
+    bool SaveCache(CCacheFile::TSections extraSections) const;
+
+    // Brings the text up to date with newText, but only reparses the top level commands around the
+    //  changed range. If that part does not parse on its own, nothing is touched and the caller
+    //  should fall back to ParseMainSource.
+    std::optional<CReparseResult> ReparseText(const std::string& newText);
+
+    // Profiling hook, ParseMainSource reports "parse" before running the parser, "build" before
+    //  building the AST and "done" once finished
+    void SetStageCallback(std::function<void(const char*)> callback)
+    {
+        StageCallback = std::move(callback);
+    }
+    // The AST dump helps when working on the grammar, but dwarfs parsing on big files
+    void SetPrintAST(bool bPrint) { bPrintAST = bPrint; }
+
     [[nodiscard]] const std::string& GetMainSourcePath() const { return MainSource; }
     [[nodiscard]] AST::CASTContext& GetASTContext() { return ASTContext; }
 
     void InsertText(size_t globalOffset, const std::string& text);
     void RemoveText(size_t globalOffset, size_t length);
     [[nodiscard]] std::string CollectText() const;
-    [[nodiscard]] std::pair<size_t, size_t> FindPieceIndexAndOffset(size_t globalOffset) const;
 
     [[nodiscard]] std::optional<size_t> BufOffsetToGlobal(int bufId, size_t bufOffset) const;
     [[nodiscard]] std::pair<int, size_t> GlobalToBufOffset(size_t globalOffset) const;
@@ -47,13 +97,34 @@ public:
     void SaveFile() const;
 
 private:
+    // Parses source, which must live in the AST context, with its tokens placed at baseOffset in
+    //  bufId. Lexer errors only fail the main source, the generated parser has always skipped
+    //  unknown characters there.
+    AST::AFile* ParseSource(std::string_view source, unsigned int bufId, unsigned int baseOffset,
+                            bool bMainSource, bool& bSucceeded);
+
+    // Global [begin, end) of a command's text, from its open to its close token
+    [[nodiscard]] std::optional<std::pair<size_t, size_t>> GetCommandRange(
+        const AST::ACommand* command) const;
+
     std::string MainSource;
     CStringBuffer MainSourceBuffer;
-    std::vector<std::tuple<int, size_t, size_t>> PieceTable;
+    CPieceTree PieceTable;
     std::string AddBuffer;
 
     AST::CASTContext ASTContext;
     AST::AFile* ASTRoot {};
+
+    EParserKind ParserKind;
+    bool bUseCache = false;
+    bool bLoadedFromCache = false;
+    bool bCacheable = false;
+    CCacheFile Cache;
+    CCacheFile::THash SourceHash {};
+    // The arena's copy of the main source, which the tokens view
+    std::string_view MainSourceText;
+    std::function<void(const char*)> StageCallback;
+    bool bPrintAST = true;
 };
 
 }
@@ -1,4 +1,5 @@
 #include "StringBuffer.h"
+#include <cassert>
 
 namespace Nome
 {
@@ -6,66 +7,46 @@ namespace Nome
 CStringBuffer::CStringBuffer() {}
 
 CStringBuffer::CStringBuffer(const std::string& content)
-    : Buffer(content)
+    : Rope(content)
 {
 }
 
 CStringBuffer::CLocation CStringBuffer::GetLocation(size_t offset)
 {
-    if (offset > Buffer.size())
-        return {};
+    return Rope.CreateAnchor(offset);
+}
+
+size_t CStringBuffer::GetOffset(CLocation location) const
+{
+    return Rope.GetAnchorOffset(location);
+}
+
+void CStringBuffer::ReleaseLocation(CLocation location) { Rope.ReleaseAnchor(location); }
 
-    auto iter = LocationMap.find(offset);
-    if (iter != LocationMap.end())
-        return iter->second;
+std::string CStringBuffer::GetAsString() const { return Rope.Assemble(); }
 
-    CLocation loc = LocationTable.GetNewElement(tc::kAddToBack);
-    LocationMap[offset] = loc;
-    *loc = offset;
-    return loc;
+void CStringBuffer::AppendRange(std::string& out, size_t offset, size_t length) const
+{
+    Rope.AppendTo(out, offset, length);
 }
 
-const std::string& CStringBuffer::GetAsString() const { return Buffer; }
+size_t CStringBuffer::GetSize() const { return Rope.GetSize(); }
 
 void CStringBuffer::ReplaceRange(size_t begin, size_t end, const std::string& content)
 {
     assert(end >= begin);
-    size_t lenBefore = end - begin;
-    size_t lenAfter = content.size();
-    ptrdiff_t deltaLen = (ptrdiff_t)lenAfter - lenBefore;
-    // Now move all locations after end (inclusive) by deltaLen
-    if (deltaLen != 0)
-    {
-        for (auto& loc : LocationTable)
-        {
-            if (loc >= end)
-                loc += deltaLen;
-        }
-    }
-    RebuildLocationMap();
-
-    // Now replace the actual content
-    Buffer.replace(begin, lenBefore, content);
+    Rope.Replace(begin, end - begin, content);
 }
 
 void CStringBuffer::ReplaceRange(CLocation begin, CLocation end, const std::string& content)
 {
-    ReplaceRange(*begin, *end, content);
+    ReplaceRange(GetOffset(begin), GetOffset(end), content);
 }
 
 void CStringBuffer::WriteLine(const std::string& what)
 {
-    Buffer += what;
-    Buffer += '\n';
-}
-
-void CStringBuffer::RebuildLocationMap()
-{
-    LocationMap.clear();
-    for (auto iter = LocationTable.begin(); iter != LocationTable.end(); ++iter)
-    {
-        LocationMap[*iter] = iter.ToReference();
-    }
+    Rope.Insert(Rope.GetSize(), what);
+    Rope.Insert(Rope.GetSize(), "\n");
 }
 
 }
@@ -1,24 +1,26 @@
 #pragma once
-#include <VectorPool.h>
-#include <map>
-#include <set>
+#include "Rope.h"
 #include <string>
 
 namespace Nome
 {
 
-using tc::TVectorPool;
-
 class CStringBuffer
 {
 public:
-    typedef TVectorPool<size_t>::VectorPoolReference CLocation;
+    typedef CRope::CAnchor CLocation;
 
     CStringBuffer();
     CStringBuffer(const std::string& content);
 
+    // Locations keep pointing at the same text across ReplaceRange calls
     CLocation GetLocation(size_t offset);
-    const std::string& GetAsString() const;
+    size_t GetOffset(CLocation location) const;
+    void ReleaseLocation(CLocation location);
+
+    std::string GetAsString() const;
+    void AppendRange(std::string& out, size_t offset, size_t length) const;
+    size_t GetSize() const;
 
     void ReplaceRange(size_t begin, size_t end, const std::string& content);
     void ReplaceRange(CLocation begin, CLocation end, const std::string& content);
@@ -26,11 +28,7 @@ public:
     void WriteLine(const std::string& what);
 
 private:
-    void RebuildLocationMap();
-
-    std::string Buffer;
-    TVectorPool<size_t> LocationTable;
-    std::map<size_t, TVectorPool<size_t>::VectorPoolReference> LocationMap;
+    CRope Rope;
 };
 
 }
@@ -6,14 +6,12 @@
 namespace Nome::AST
 {
 
-CToken::CToken(std::string text, unsigned int bufId, unsigned int start)
-    : Text(std::move(text))
+CToken::CToken(std::string_view text, unsigned int bufId, unsigned int start)
+    : Text(text)
     , BufLoc { bufId, start }
 {
 }
 
-std::string CToken::ToString() const { return Text; }
-
 bool ANode::CanBeChild(ANode* node) const
 {
     uint32_t i = ChildKindRange & 0xFFFF;
@@ -147,8 +145,8 @@ std::vector<AExpr*> AVector::GetItems() const
     return exprs;
 }
 
-ACall::ACall(CToken* funcToken, AVector* argumentList)
-    : AExpr(EKind::Call, funcToken)
+ACall::ACall(CArena& arena, CToken* funcToken, AVector* argumentList)
+    : AExpr(arena, EKind::Call, funcToken)
 {
     // Verify that the argument list only has one member
     if (argumentList->GetItems().size() > 1)
@@ -166,6 +164,17 @@ std::vector<ACommand*> AFile::GetCommands() const
     return cmds;
 }
 
+ACommand* AFile::GetLastCommand() const
+{
+    return Children.empty() ? nullptr : static_cast<ACommand*>(Children.back());
+}
+
+void AFile::ReplaceCommands(size_t first, size_t count, const std::vector<ACommand*>& commands)
+{
+    auto iter = Children.erase(Children.begin() + first, Children.begin() + first + count);
+    Children.insert(iter, commands.begin(), commands.end());
+}
+
 void AFile::CollectTokens(std::vector<CToken*>& tokenList) const
 {
     for (auto* cmd : GetCommands())
@@ -196,18 +205,28 @@ void ANamedArgument::CollectTokens(std::vector<CToken*>& tokenList) const
         expr->CollectTokens(tokenList);
 }
 
-ACommand::ACommand(CToken* openToken, CToken* closeToken)
-    : ANode(EKind::Command, EKind::Command, EKind::CommandPost, openToken, closeToken)
+ACommand::ACommand(CArena& arena, CToken* openToken, CToken* closeToken)
+    : ANode(arena, EKind::Command, EKind::Command, EKind::CommandPost, openToken, closeToken)
+    , PositionalArguments(arena)
+    , NamedArguments(arena)
+    , Transforms(arena)
+{
+}
+
+static bool NamedArgumentLess(const ANamedArgument* arg, std::string_view name)
 {
+    return arg->GetOpenToken()->GetText() < name;
 }
 
 // Color is an example of a named argument
 void ACommand::AddNamedArgument(ANamedArgument* argument)
 {
-    auto iter = NamedArguments.find(argument->GetName());
-    if (iter != NamedArguments.end()) 
+    auto name = argument->GetOpenToken()->GetText();
+    auto iter = std::lower_bound(NamedArguments.begin(), NamedArguments.end(), name,
+                                 NamedArgumentLess);
+    if (iter != NamedArguments.end() && (*iter)->GetOpenToken()->GetText() == name)
         throw CSemanticError("Named argument is repeated.", argument);
-    NamedArguments[argument->GetName()] = argument;
+    NamedArguments.insert(iter, argument);
 }
 
 std::string ACommand::GetPositionalIdentAsString(size_t index) const
@@ -229,9 +248,10 @@ AExpr* ACommand::GetPositionalArgument(size_t index) const
 
 ANamedArgument* ACommand::GetNamedArgument(const std::string& name) const
 {
-    auto iter = NamedArguments.find(name);
-    if (iter != NamedArguments.end())
-        return iter->second;
+    auto iter = std::lower_bound(NamedArguments.begin(), NamedArguments.end(), name,
+                                 NamedArgumentLess);
+    if (iter != NamedArguments.end() && (*iter)->GetOpenToken()->GetText() == name)
+        return *iter;
     return nullptr;
 }
 
@@ -250,7 +270,7 @@ void ACommand::CollectTokens(std::vector<CToken*>& tokenList) const
         expr->CollectTokens(tokenList);
     for (auto* arg : Transforms)
         arg->CollectTokens(tokenList);
-    for (auto [name, arg] : NamedArguments)
+    for (auto* arg : NamedArguments)
         arg->CollectTokens(tokenList);
     for (auto* sub : GetSubCommands())
         sub->CollectTokens(tokenList);
@@ -284,8 +304,8 @@ std::ostream& operator<<(std::ostream& os, const ACommand& node)
     }
     for (auto* expr : node.Transforms)
         os << " " << *expr;
-    for (const auto& pair : node.NamedArguments)
-        os << " " << *pair.second;
+    for (auto* arg : node.NamedArguments)
+        os << " " << *arg;
     os << " " << node.CloseToken->ToString();
     return os;
 }
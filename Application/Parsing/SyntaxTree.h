@@ -1,10 +1,11 @@
 #pragma once
-#include "StringBuffer.h"
+#include "Arena.h"
 #include <any>
 #include <exception>
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -17,11 +18,13 @@ struct CBufLoc
     unsigned int Start;
 };
 
+// The text is a view into source copied into the AST context, tokens live in its arena too
 class CToken
 {
 public:
-    CToken(std::string text, unsigned int bufId, unsigned int start);
-    [[nodiscard]] std::string ToString() const;
+    CToken(std::string_view text, unsigned int bufId, unsigned int start);
+    [[nodiscard]] std::string ToString() const { return std::string(Text); }
+    [[nodiscard]] std::string_view GetText() const { return Text; }
     [[nodiscard]] const CBufLoc& GetLocation() const { return BufLoc; }
     void SetLocation(unsigned int bufId, unsigned int offset)
     {
@@ -32,7 +35,7 @@ public:
     [[nodiscard]] bool IsLocInvalid() const { return BufLoc.BufId == -1; }
 
 private:
-    std::string Text;
+    std::string_view Text;
     CBufLoc BufLoc;
 };
 
@@ -68,11 +71,13 @@ public:
     [[nodiscard]] CToken* GetCloseToken() const { return CloseToken; }
 
 protected:
-    ANode(EKind kind, EKind childKindBegin, EKind childKindEnd, CToken* token,
+    // Nodes are only made through CASTContext::Make, which passes in its arena
+    ANode(CArena& arena, EKind kind, EKind childKindBegin, EKind childKindEnd, CToken* token,
           CToken* closeToken = nullptr)
         : Kind(kind)
         , Token(token)
         , CloseToken(closeToken)
+        , Children(arena)
     {
         ChildKindRange =
             static_cast<uint32_t>(childKindBegin) | (static_cast<uint32_t>(childKindEnd) << 16);
@@ -81,7 +86,7 @@ protected:
     EKind Kind;
     CToken* Token;
     CToken* CloseToken; // Optionally provide handling for matched open/close pairs
-    std::vector<ANode*> Children;
+    TArenaVector<ANode*> Children;
     uint32_t ChildKindRange = 0;
 };
 
@@ -98,8 +103,8 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const AExpr& node);
 
 protected:
-    AExpr(EKind kind, CToken* token, CToken* closeToken = nullptr)
-        : ANode(kind, EKind::Expr, EKind::ExprPost, token, closeToken)
+    AExpr(CArena& arena, EKind kind, CToken* token, CToken* closeToken = nullptr)
+        : ANode(arena, kind, EKind::Expr, EKind::ExprPost, token, closeToken)
     {
     }
 };
@@ -107,8 +112,8 @@ protected:
 class AIdent : public AExpr
 {
 public:
-    AIdent(CToken* token)
-        : AExpr(EKind::Ident, token)
+    AIdent(CArena& arena, CToken* token)
+        : AExpr(arena, EKind::Ident, token)
     {
     }
 
@@ -125,8 +130,8 @@ public:
 class ANumber : public AExpr
 {
 public:
-    ANumber(CToken* token)
-        : AExpr(EKind::Number, token)
+    ANumber(CArena& arena, CToken* token)
+        : AExpr(arena, EKind::Number, token)
     {
     }
 
@@ -150,8 +155,8 @@ public:
         Plus
     };
 
-    AUnaryOp(CToken* token, AExpr* operand)
-        : AExpr(EKind::UnaryOp, token)
+    AUnaryOp(CArena& arena, CToken* token, AExpr* operand)
+        : AExpr(arena, EKind::UnaryOp, token)
     {
         AddChild(operand);
     }
@@ -184,8 +189,8 @@ public:
         Exp
     };
 
-    ABinaryOp(CToken* token, AExpr* left, AExpr* right)
-        : AExpr(EKind::BinaryOp, token)
+    ABinaryOp(CArena& arena, CToken* token, AExpr* left, AExpr* right)
+        : AExpr(arena, EKind::BinaryOp, token)
     {
         AddChild(left);
         AddChild(right);
@@ -214,8 +219,8 @@ public:
 class AVector : public AExpr
 {
 public:
-    AVector(CToken* openToken, CToken* closeToken)
-        : AExpr(EKind::Vector, openToken, closeToken)
+    AVector(CArena& arena, CToken* openToken, CToken* closeToken)
+        : AExpr(arena, EKind::Vector, openToken, closeToken)
     {
     }
 
@@ -241,7 +246,7 @@ public:
 class ACall : public AExpr
 {
 public:
-    ACall(CToken* funcToken, AVector* argumentList);
+    ACall(CArena& arena, CToken* funcToken, AVector* argumentList);
 
     std::string GetFuncName() const { return Token->ToString(); }
     AVector* GetOperandList() const { return static_cast<AVector*>(Children[0]); }
@@ -262,14 +267,16 @@ public:
 class AWrappedExpr : public AExpr
 {
 public:
-    AWrappedExpr(CToken* beginToken, CToken* endToken, CToken* secondToken, AExpr* expr)
-        : AExpr(EKind::WrappedExpr, beginToken, endToken)
+    AWrappedExpr(CArena& arena, CToken* beginToken, CToken* endToken, CToken* secondToken,
+                 AExpr* expr)
+        : AExpr(arena, EKind::WrappedExpr, beginToken, endToken)
         , SecondToken(secondToken)
     {
         AddChild(expr);
     }
 
     AExpr* GetExpr() const { return static_cast<AExpr*>(Children[0]); }
+    CToken* GetSecondToken() const { return SecondToken; }
 
     void CollectTokens(std::vector<CToken*>& tokenList) const
     {
@@ -310,12 +317,15 @@ class ACommand;
 class AFile : public ANode
 {
 public:
-    AFile()
-        : ANode(EKind::File, EKind::Command, EKind::CommandPost, nullptr)
+    explicit AFile(CArena& arena)
+        : ANode(arena, EKind::File, EKind::Command, EKind::CommandPost, nullptr)
     {
     }
 
     std::vector<ACommand*> GetCommands() const;
+    ACommand* GetLastCommand() const;
+    // Swaps out count commands starting at first, the old ones are not freed
+    void ReplaceCommands(size_t first, size_t count, const std::vector<ACommand*>& commands);
     void CollectTokens(std::vector<CToken*>& tokenList) const;
 
     friend std::ostream& operator<<(std::ostream& os, const AFile& node);
@@ -324,8 +334,8 @@ public:
 class ANamedArgument : public ANode
 {
 public:
-    ANamedArgument(CToken* nameToken)
-        : ANode(EKind::NamedArgument, EKind::Expr, EKind::ExprPost, nameToken)
+    ANamedArgument(CArena& arena, CToken* nameToken)
+        : ANode(arena, EKind::NamedArgument, EKind::Expr, EKind::ExprPost, nameToken)
     {
     }
 
@@ -340,7 +350,7 @@ public:
 class ACommand : public ANode
 {
 public:
-    ACommand(CToken* openToken, CToken* closeToken);
+    ACommand(CArena& arena, CToken* openToken, CToken* closeToken);
 
     // `Children` field of ACommand only stores sub-commands
     void AddSubCommand(ACommand* subCommand) { AddChild(subCommand); }
@@ -356,7 +366,9 @@ public:
     std::string GetPositionalIdentAsString(size_t index) const;
     AExpr* GetPositionalArgument(size_t index) const;
     ANamedArgument* GetNamedArgument(const std::string& name) const;
-    const std::vector<ANamedArgument*>& GetTransforms() const { return Transforms; }
+    const TArenaVector<AExpr*>& GetPositionalArguments() const { return PositionalArguments; }
+    const TArenaVector<ANamedArgument*>& GetNamedArguments() const { return NamedArguments; }
+    const TArenaVector<ANamedArgument*>& GetTransforms() const { return Transforms; }
 
     std::vector<ACommand*> GetSubCommands() const;
     void CollectTokens(std::vector<CToken*>& tokenList) const;
@@ -367,9 +379,10 @@ public:
     void SetPendingSave(bool value) { bPendingSave = value; }
 
 private:
-    std::vector<AExpr*> PositionalArguments;
-    std::map<std::string, ANamedArgument*> NamedArguments;
-    std::vector<ANamedArgument*> Transforms;
+    TArenaVector<AExpr*> PositionalArguments;
+    // Sorted by name, commands have a handful at most
+    TArenaVector<ANamedArgument*> NamedArguments;
+    TArenaVector<ANamedArgument*> Transforms;
     bool bPendingSave = false;
 };
 
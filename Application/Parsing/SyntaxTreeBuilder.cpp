@@ -1,11 +1,13 @@
 #include "SyntaxTreeBuilder.h"
 
+#include <algorithm>
+
 namespace Nome
 {
 
 antlrcpp::Any CFileBuilder::visitFile(NomParser::FileContext* context)
 {
-    AST::AFile* file = new AST::AFile();
+    AST::AFile* file = Ctx.Make<AST::AFile>();
     for (auto* command : context->command())
         file->AddChild(this->visit(command).as<AST::ACommand*>());
     return file;
@@ -13,13 +15,13 @@ antlrcpp::Any CFileBuilder::visitFile(NomParser::FileContext* context)
 
 antlrcpp::Any CFileBuilder::visitArgClosed(NomParser::ArgClosedContext* context)
 {
-    AST::ANamedArgument* arg = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    AST::ANamedArgument* arg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     return arg;
 }
 
 antlrcpp::Any CFileBuilder::visitArgHidden(NomParser::ArgHiddenContext* context)
 {
-    AST::ANamedArgument* arg = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    AST::ANamedArgument* arg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     return arg;
 }
 
@@ -27,35 +29,35 @@ antlrcpp::Any CFileBuilder::visitArgHidden(NomParser::ArgHiddenContext* context)
 
 antlrcpp::Any CFileBuilder::visitArgSurface(NomParser::ArgSurfaceContext* context)
 {
-    AST::ANamedArgument* arg = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    AST::ANamedArgument* arg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     arg->AddChild(visit(context->ident()).as<AST::AExpr*>());
     return arg;
 }
 
 antlrcpp::Any CFileBuilder::visitArgSlices(NomParser::ArgSlicesContext* context)
 {
-    auto* result = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    auto* result = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     result->AddChild(visit(context->expression()).as<AST::AExpr*>());
     return result;
 }
 
 antlrcpp::Any CFileBuilder::visitArgOrder(NomParser::ArgOrderContext* context)
 {
-    auto* result = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    auto* result = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     result->AddChild(visit(context->expression()).as<AST::AExpr*>());
     return result;
 }
 
 antlrcpp::Any CFileBuilder::visitArgTransformTwo(NomParser::ArgTransformTwoContext* context)
 {
-    auto* result = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    auto* result = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     auto* list =
-        new AST::AVector(ConvertToken(context->LPAREN(0)), ConvertToken(context->RPAREN(0)));
+        Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN(0)), ConvertToken(context->RPAREN(0)));
     list->AddChild(visit(context->exp1).as<AST::AExpr*>());
     list->AddChild(visit(context->exp2).as<AST::AExpr*>());
     list->AddChild(visit(context->exp3).as<AST::AExpr*>());
     result->AddChild(list);
-    list = new AST::AVector(ConvertToken(context->LPAREN(1)), ConvertToken(context->RPAREN(1)));
+    list = Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN(1)), ConvertToken(context->RPAREN(1)));
     list->AddChild(visit(context->exp4).as<AST::AExpr*>());
     result->AddChild(list);
     return result;
@@ -63,9 +65,9 @@ antlrcpp::Any CFileBuilder::visitArgTransformTwo(NomParser::ArgTransformTwoConte
 
 antlrcpp::Any CFileBuilder::visitArgTransformOne(NomParser::ArgTransformOneContext* context)
 {
-    auto* result = new AST::ANamedArgument(ConvertToken(context->getStart()));
+    auto* result = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
     auto* firstList =
-        new AST::AVector(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
+        Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
     for (auto* expr : context->expression())
         firstList->AddChild(visit(expr).as<AST::AExpr*>());
     result->AddChild(firstList);
@@ -74,8 +76,8 @@ antlrcpp::Any CFileBuilder::visitArgTransformOne(NomParser::ArgTransformOneConte
 
 antlrcpp::Any CFileBuilder::visitArgColor(NomParser::ArgColorContext* context)
 {
-    auto* result = new AST::ANamedArgument(ConvertToken(context->getStart()));
-    auto* colorList = new AST::AVector(ConvertToken(context->LPAREN()->getSymbol()),
+    auto* result = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->getStart()));
+    auto* colorList = Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN()->getSymbol()),
                                        ConvertToken(context->RPAREN()->getSymbol()));
     for (auto* expr : context->expression())
     {
@@ -87,7 +89,7 @@ antlrcpp::Any CFileBuilder::visitArgColor(NomParser::ArgColorContext* context)
 
 antlrcpp::Any CFileBuilder::visitIdList(NomParser::IdListContext *context)
 {
-    auto* list = new AST::AVector(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
+    auto* list = Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
     for (auto* expr : context->identList)
         list->AddChild(visit(expr).as<AST::AExpr*>());
     return static_cast<AST::AExpr*>(list);
@@ -95,9 +97,9 @@ antlrcpp::Any CFileBuilder::visitIdList(NomParser::IdListContext *context)
 
 antlrcpp::Any CFileBuilder::visitCmdExprListOne(NomParser::CmdExprListOneContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
-    auto* list = new AST::AVector(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
+    auto* list = Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
     for (auto* expr : context->expression())
         list->AddChild(visit(expr).as<AST::AExpr*>());
     cmd->PushPositionalArgument(list);
@@ -109,7 +111,7 @@ antlrcpp::Any CFileBuilder::visitCmdExprListOne(NomParser::CmdExprListOneContext
 
 antlrcpp::Any CFileBuilder::visitCmdIdListOne(NomParser::CmdIdListOneContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
     cmd->PushPositionalArgument(visit(context->idList()));
     // Handle arguments other than name
@@ -126,7 +128,7 @@ antlrcpp::Any CFileBuilder::visitCmdIdListOne(NomParser::CmdIdListOneContext* co
 
 antlrcpp::Any CFileBuilder::visitCmdSubCmds(NomParser::CmdSubCmdsContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
     for (auto* subCmd : context->command())
         cmd->AddSubCommand(visit(subCmd));
@@ -135,7 +137,7 @@ antlrcpp::Any CFileBuilder::visitCmdSubCmds(NomParser::CmdSubCmdsContext* contex
 
 antlrcpp::Any CFileBuilder::visitCmdInstance(NomParser::CmdInstanceContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
     cmd->PushPositionalArgument(visit(context->entity));
     for (auto* arg : context->argHidden())
@@ -149,7 +151,7 @@ antlrcpp::Any CFileBuilder::visitCmdInstance(NomParser::CmdInstanceContext* cont
 
 antlrcpp::Any CFileBuilder::visitCmdSurface(NomParser::CmdSurfaceContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
     cmd->AddNamedArgument(visit(context->argColor()));
     return cmd;
@@ -157,14 +159,14 @@ antlrcpp::Any CFileBuilder::visitCmdSurface(NomParser::CmdSurfaceContext* contex
 
 antlrcpp::Any CFileBuilder::visitCmdArgSurface(NomParser::CmdArgSurfaceContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->AddNamedArgument(visit(context->argSurface()));
     return cmd;
 }
 
 antlrcpp::Any CFileBuilder::visitCmdBank(NomParser::CmdBankContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
     for (auto* set : context->set())
         cmd->AddSubCommand(visit(set));
@@ -173,7 +175,7 @@ antlrcpp::Any CFileBuilder::visitCmdBank(NomParser::CmdBankContext* context)
 
 antlrcpp::Any CFileBuilder::visitCmdDelete(NomParser::CmdDeleteContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     for (auto* deleteFace : context->deleteFace())
         cmd->AddSubCommand(visit(deleteFace));
     return cmd;
@@ -181,35 +183,37 @@ antlrcpp::Any CFileBuilder::visitCmdDelete(NomParser::CmdDeleteContext* context)
 
 antlrcpp::Any CFileBuilder::visitCmdSubdivision(NomParser::CmdSubdivisionContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
-    auto* namedArg = new AST::ANamedArgument(ConvertToken(context->k1));
+    auto* namedArg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->k1));
     namedArg->AddChild(visit(context->v1).as<AST::AExpr*>());
     cmd->AddNamedArgument(namedArg);
 
-    namedArg = new AST::ANamedArgument(ConvertToken(context->k2));
+    namedArg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->k2));
     namedArg->AddChild(visit(context->v2).as<AST::AExpr*>());
     cmd->AddNamedArgument(namedArg);
+    for (auto* subCmd : context->command())
+        cmd->AddSubCommand(visit(subCmd));
     return cmd;
 }
 
 antlrcpp::Any CFileBuilder::visitCmdOffset(NomParser::CmdOffsetContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->name));
-    auto* namedArg = new AST::ANamedArgument(ConvertToken(context->k1));
+    auto* namedArg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->k1));
     namedArg->AddChild(visit(context->v1).as<AST::AExpr*>());
     cmd->AddNamedArgument(namedArg);
 
-    namedArg = new AST::ANamedArgument(ConvertToken(context->k2));
+    namedArg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->k2));
     namedArg->AddChild(visit(context->v2).as<AST::AExpr*>());
     cmd->AddNamedArgument(namedArg);
 
-    namedArg = new AST::ANamedArgument(ConvertToken(context->k3));
+    namedArg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->k3));
     namedArg->AddChild(visit(context->v3).as<AST::AExpr*>());
     cmd->AddNamedArgument(namedArg);
 
-    namedArg = new AST::ANamedArgument(ConvertToken(context->k4));
+    namedArg = Ctx.Make<AST::ANamedArgument>(ConvertToken(context->k4));
     namedArg->AddChild(visit(context->v4).as<AST::AExpr*>());
     cmd->AddNamedArgument(namedArg);
     return cmd;
@@ -217,7 +221,7 @@ antlrcpp::Any CFileBuilder::visitCmdOffset(NomParser::CmdOffsetContext* context)
 
 antlrcpp::Any CFileBuilder::visitSet(NomParser::SetContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), nullptr);
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), nullptr);
     cmd->PushPositionalArgument(visit(context->ident()));
     for (auto* expr : context->expression())
         cmd->PushPositionalArgument(visit(expr));
@@ -226,7 +230,7 @@ antlrcpp::Any CFileBuilder::visitSet(NomParser::SetContext* context)
 
 antlrcpp::Any CFileBuilder::visitDeleteFace(NomParser::DeleteFaceContext* context)
 {
-    auto* cmd = new AST::ACommand(ConvertToken(context->open), ConvertToken(context->end));
+    auto* cmd = Ctx.Make<AST::ACommand>(ConvertToken(context->open), ConvertToken(context->end));
     cmd->PushPositionalArgument(visit(context->ident()));
     return cmd;
 }
@@ -234,30 +238,30 @@ antlrcpp::Any CFileBuilder::visitDeleteFace(NomParser::DeleteFaceContext* contex
 antlrcpp::Any CFileBuilder::visitCall(NomParser::CallContext* context)
 {
     auto* argList =
-        new AST::AVector(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
+        Ctx.Make<AST::AVector>(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()));
     argList->AddChild(visit(context->expression()).as<AST::AExpr*>());
     auto* funcToken = ConvertToken(context->ident()->IDENT());
-    return static_cast<AST::AExpr*>(new AST::ACall(funcToken, argList));
+    return static_cast<AST::AExpr*>(Ctx.Make<AST::ACall>(funcToken, argList));
 }
 
 antlrcpp::Any CFileBuilder::visitUnaryOp(NomParser::UnaryOpContext* context)
 {
     if (context->PLUS())
-        return static_cast<AST::AExpr*>(new AST::AUnaryOp(ConvertToken(context->PLUS()), visit(context->expression())));
+        return static_cast<AST::AExpr*>(Ctx.Make<AST::AUnaryOp>(ConvertToken(context->PLUS()), visit(context->expression())));
     if (context->MINUS())
-        return static_cast<AST::AExpr*>(new AST::AUnaryOp(ConvertToken(context->MINUS()), visit(context->expression())));
+        return static_cast<AST::AExpr*>(Ctx.Make<AST::AUnaryOp>(ConvertToken(context->MINUS()), visit(context->expression())));
     throw AST::CSemanticError("Invalid unary operator", nullptr);
 }
 
 antlrcpp::Any CFileBuilder::visitSubExpParen(NomParser::SubExpParenContext* context)
 {
-    return static_cast<AST::AExpr*>(new AST::AWrappedExpr(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()),
+    return static_cast<AST::AExpr*>(Ctx.Make<AST::AWrappedExpr>(ConvertToken(context->LPAREN()), ConvertToken(context->RPAREN()),
                                  nullptr, visit(context->expression())));
 }
 
 antlrcpp::Any CFileBuilder::visitSubExpCurly(NomParser::SubExpCurlyContext* context)
 {
-    return static_cast<AST::AExpr*>(new AST::AWrappedExpr(ConvertToken(context->beg), ConvertToken(context->end),
+    return static_cast<AST::AExpr*>(Ctx.Make<AST::AWrappedExpr>(ConvertToken(context->beg), ConvertToken(context->end),
                                  ConvertToken(context->sec), visit(context->expression())));
 }
 
@@ -267,17 +271,17 @@ antlrcpp::Any CFileBuilder::visitBinOp(NomParser::BinOpContext* context)
     auto left = visit(context->expression(0));
     auto right = visit(context->expression(1));
     auto* op = ConvertToken(context->op);
-    return static_cast<AST::AExpr*>(new AST::ABinaryOp(op, left, right));
+    return static_cast<AST::AExpr*>(Ctx.Make<AST::ABinaryOp>(op, left, right));
 }
 
 antlrcpp::Any CFileBuilder::visitScientific(NomParser::ScientificContext* context)
 {
-    return static_cast<AST::AExpr*>(new AST::ANumber(ConvertToken(context->SCIENTIFIC_NUMBER())));
+    return static_cast<AST::AExpr*>(Ctx.Make<AST::ANumber>(ConvertToken(context->SCIENTIFIC_NUMBER())));
 }
 
 antlrcpp::Any CFileBuilder::visitIdent(NomParser::IdentContext* context)
 {
-    return static_cast<AST::AExpr*>(new AST::AIdent(ConvertToken(context->IDENT())));
+    return static_cast<AST::AExpr*>(Ctx.Make<AST::AIdent>(ConvertToken(context->IDENT())));
 }
 
 antlrcpp::Any CFileBuilder::visitAtomExpr(NomParser::AtomExprContext* context)
@@ -288,15 +292,35 @@ antlrcpp::Any CFileBuilder::visitAtomExpr(NomParser::AtomExprContext* context)
 AST::CToken* CFileBuilder::ConvertToken(antlr4::Token* token)
 {
     auto start = token->getStartIndex();
-    auto len = token->getStopIndex() - start + 1;
-    return new AST::CToken(token->getText(), 0, start);
+    auto stop = token->getStopIndex();
+    // Tokens conjured up by error recovery have no text in the source
+    if (start == INVALID_INDEX || stop == INVALID_INDEX || stop < start)
+        return Ctx.MakeToken(token->getText());
+    // ANTLR counts code points, the views and locations want bytes
+    size_t byteStart = ByteOffsets.empty() ? start : ByteOffsets[start];
+    size_t byteEnd = ByteOffsets.empty() ? stop + 1 : ByteOffsets[stop + 1];
+    return Ctx.Make<AST::CToken>(Source.substr(byteStart, byteEnd - byteStart), BufId,
+                                 BaseOffset + static_cast<unsigned int>(byteStart));
 }
 
 AST::CToken* CFileBuilder::ConvertToken(antlr4::tree::TerminalNode* token)
 {
-    auto start = token->getSymbol()->getStartIndex();
-    auto len = token->getSymbol()->getStopIndex() - start + 1;
-    return new AST::CToken(token->getText(), 0, start);
+    return ConvertToken(token->getSymbol());
+}
+
+void CFileBuilder::BuildByteOffsets()
+{
+    bool bAscii = std::all_of(Source.begin(), Source.end(),
+                              [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+    if (bAscii)
+        return;
+    for (size_t i = 0; i < Source.size(); i++)
+    {
+        // Skip UTF-8 continuation bytes
+        if ((static_cast<unsigned char>(Source[i]) & 0xC0) != 0x80)
+            ByteOffsets.push_back(i);
+    }
+    ByteOffsets.push_back(Source.size());
 }
 
 }
@@ -1,6 +1,9 @@
 #pragma once
+#include "ASTContext.h"
 #include "NomBaseVisitor.h"
 #include "SyntaxTree.h"
+#include <string_view>
+#include <vector>
 
 namespace Nome
 {
@@ -8,10 +11,17 @@ namespace Nome
 class CFileBuilder : public NomBaseVisitor
 {
 public:
-    // The CStringBuffer is used to generate source location references
-    CFileBuilder(CStringBuffer& srcStringBuffer)
-        : SrcStringBuffer(srcStringBuffer)
+    // Nodes are made in ctx and token text views into source, which must be exactly what was
+    //  parsed and outlive the AST. When only a slice of the file is parsed, tokens are placed at
+    //  baseOffset in buffer bufId.
+    CFileBuilder(AST::CASTContext& ctx, std::string_view source, unsigned int bufId = 0,
+                 unsigned int baseOffset = 0)
+        : Ctx(ctx)
+        , Source(source)
+        , BufId(bufId)
+        , BaseOffset(baseOffset)
     {
+        BuildByteOffsets();
     }
 
     antlrcpp::Any visitFile(NomParser::FileContext* context) override;
@@ -56,7 +66,14 @@ private:
     AST::CToken* ConvertToken(antlr4::Token* token);
     AST::CToken* ConvertToken(antlr4::tree::TerminalNode* token);
 
-    CStringBuffer& SrcStringBuffer;
+    // Maps code point indices to byte offsets, left empty for plain ASCII sources
+    void BuildByteOffsets();
+
+    AST::CASTContext& Ctx;
+    std::string_view Source;
+    std::vector<size_t> ByteOffsets;
+    unsigned int BufId;
+    unsigned int BaseOffset;
 };
 
 }
@@ -53,10 +53,16 @@ void CInteractiveMesh::UpdateGeometry()
         auto* meshInstance = dynamic_cast<Scene::CMeshInstance*>(entity);
         if (meshInstance)
         {
-            delete GeometryRenderer;
-            delete Geometry;
+            auto shading = meshInstance->IsSmooth() ? EShading::Smooth : EShading::Flat;
+            CMeshToQGeometry meshToQGeometry(meshInstance->GetDrawMeshImpl(), true, shading);
+            if (Geometry)
+            {
+                // Keep the Qt3D objects alive across updates, only their buffers change
+                meshToQGeometry.UpdateGeometry(Geometry);
+                meshToQGeometry.UpdatePointGeometry(PointGeometry);
+                return;
+            }
 
-            CMeshToQGeometry meshToQGeometry(meshInstance->GetMeshImpl(), true);
             Geometry = meshToQGeometry.GetGeometry();
             Geometry->setParent(this);
 
@@ -65,22 +71,15 @@ void CInteractiveMesh::UpdateGeometry()
             GeometryRenderer->setPrimitiveType(Qt3DRender::QGeometryRenderer::Triangles);
             this->addComponent(GeometryRenderer);
 
-            // Update or create the entity for drawing vertices
-            if (!PointEntity) 
-            {
-                PointEntity = new Qt3DCore::QEntity(this);
+            // Create the entity for drawing vertices
+            PointEntity = new Qt3DCore::QEntity(this);
+
+            auto xmlPath = CResourceMgr::Get().Find("DebugDrawLine.xml"); //this uses instanceColor, and also uses LineShading.frag for final color
+            auto* lineMat = new CXMLMaterial(QString::fromStdString(xmlPath));
+            PointMaterial = lineMat;
+            PointMaterial->setParent(this);
+            PointEntity->addComponent(PointMaterial);
 
-                auto xmlPath = CResourceMgr::Get().Find("DebugDrawLine.xml"); //this uses instanceColor, and also uses LineShading.frag for final color
-                auto* lineMat = new CXMLMaterial(QString::fromStdString(xmlPath));
-                PointMaterial = lineMat;
-                PointMaterial->setParent(this);
-                PointEntity->addComponent(PointMaterial);
-            }
-            else
-            {
-                delete PointRenderer;
-                delete PointGeometry;
-            }
             PointGeometry = meshToQGeometry.GetPointGeometry();
             PointGeometry->setParent(PointEntity);
             PointRenderer = new Qt3DRender::QGeometryRenderer(PointEntity);
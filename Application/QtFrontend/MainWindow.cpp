@@ -6,6 +6,7 @@
 #include <Scene/ASTSceneAdapter.h>
 #include <Scene/Environment.h>
 #include <Scene/MeshMerger.h>
+#include <Scene/SceneCache.h>
 
 #include <QDockWidget>
 #include <QScrollArea> // Randy added
@@ -20,6 +21,8 @@
 #include <QVBoxLayout>
 #include <StringPrintf.h>
 
+#include <fstream>
+
 namespace Nome
 {
 
@@ -114,6 +117,8 @@ void CMainWindow::on_actionOpen_triggered()
 
 void CMainWindow::on_actionReload_triggered()
 {
+    if (SourceMgr && !bIsBlankFile && ReloadChangedCommands())
+        return;
     UnloadNomeFile();
     if (!SourceMgr || SourceMgr->GetMainSourcePath().empty())
         LoadEmptyNomeFile();
@@ -333,6 +338,7 @@ void CMainWindow::LoadNomeFile(const std::string& filePath)
     setWindowFilePath(QString::fromStdString(filePath));
     bIsBlankFile = false;
     SourceMgr = std::make_shared<CSourceManager>(filePath);
+    SourceMgr->SetUseCache(true);
     bool parseSuccess = SourceMgr->ParseMainSource();
     if (!parseSuccess)
     {
@@ -367,9 +373,49 @@ void CMainWindow::LoadNomeFile(const std::string& filePath)
         }
     }
 
+    if (SourceMgr->WasLoadedFromCache())
+        Scene::CSceneCache::RestoreMeshes(*SourceMgr, *Scene);
+    else
+    {
+        // Generate everything now so that the next load of the same file can skip it
+        Scene->Update();
+        Scene::CSceneCache::Save(*SourceMgr, *Scene);
+    }
+
     PostloadSetup();
 }
 
+bool CMainWindow::ReloadChangedCommands()
+{
+    std::ifstream ifs(SourceMgr->GetMainSourcePath());
+    if (!ifs)
+        return false;
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    // Reloading an unchanged file is how temporary meshes and edits get thrown away, the full
+    //  reload does that
+    if (content == SourceMgr->CollectText())
+        return false;
+
+    auto result = SourceMgr->ReparseText(content);
+    if (!result)
+        return false;
+    try
+    {
+        Scene::CASTSceneAdapter adapter;
+        adapter.SyncChangedCommands(SourceMgr->GetASTContext().GetAstRoot(),
+                                    result->RemovedCommands, result->AddedCommands, *Scene);
+    }
+    catch (const AST::CSemanticError&)
+    {
+        // The full reload runs into the same error and reports it
+        return false;
+    }
+    // Same as after a full reload, nothing made interactively survives
+    TemporaryMeshManager->DiscardChanges();
+    Nome3DView->DiscardInstanceEdits();
+    return true;
+}
+
 void CMainWindow::PostloadSetup()
 {
     Scene->GetBankAndSet().AddObserver(this);
@@ -74,6 +74,8 @@ private:
     void SetupUI();
     void LoadEmptyNomeFile();
     void LoadNomeFile(const std::string& filePath);
+    // Reparses only the commands that changed on disk, false if a full reload is needed
+    bool ReloadChangedCommands();
     void PostloadSetup();
     void UnloadNomeFile();
     bool hasEnding(std::string const &str, std::string const &end) {
@@ -2,146 +2,277 @@
 
 #include <Qt3DRender/QBuffer>
 
+#include <algorithm>
+
 namespace Nome
 {
 
-CMeshToQGeometry::CMeshToQGeometry(const CMeshImpl& fromMesh, bool bGenPointGeometry)
+// Position followed by normal
+static constexpr uint32_t VertexStride = sizeof(float) * 6;
+
+CMeshToQGeometry::CMeshToQGeometry(const CMeshImpl& fromMesh, bool bGenPointGeometry,
+                                   EShading shading)
+    : bHasPoints(bGenPointGeometry)
+{
+    if (shading == EShading::Flat)
+        FillFlat(fromMesh);
+    else
+        FillSmooth(fromMesh);
+
+    if (bGenPointGeometry)
+    {
+        PointCount = static_cast<uint32_t>(fromMesh.n_vertices());
+        PointBufferData.resize(static_cast<int>(PointCount * sizeof(float) * 6));
+        auto* pointOut = reinterpret_cast<float*>(PointBufferData.data());
+        for (uint32_t i = 0; i < PointCount; i++)
+        {
+            CMeshImpl::VertexHandle v(static_cast<int>(i));
+            const auto& point = fromMesh.point(v);
+            const auto& color = fromMesh.color(v);
+            *pointOut++ = point[0];
+            *pointOut++ = point[1];
+            *pointOut++ = point[2];
+            *pointOut++ = color[0] / 255.0f;
+            *pointOut++ = color[1] / 255.0f;
+            *pointOut++ = color[2] / 255.0f;
+        }
+    }
+}
+
+void CMeshToQGeometry::FillFlat(const CMeshImpl& fromMesh)
 {
-    // Per face normal, thus no shared vertices between faces
-    struct CVertexData
+    // Size both buffers up front from the face valences
+    uint32_t numCorners = 0;
+    uint32_t numTriangles = 0;
+    CMeshImpl::FaceIter fIter, fEnd = fromMesh.faces_end();
+    for (fIter = fromMesh.faces_sbegin(); fIter != fEnd; ++fIter)
+    {
+        uint32_t valence = fromMesh.valence(*fIter);
+        numCorners += valence;
+        numTriangles += valence >= 3 ? valence - 2 : 0;
+    }
+    VertexCount = numCorners;
+    IndexCount = numTriangles * 3;
+    VertexBufferData.resize(static_cast<int>(VertexCount * VertexStride));
+    IndexBufferData.resize(static_cast<int>(IndexCount * sizeof(uint32_t)));
+
+    auto* vertexOut = reinterpret_cast<float*>(VertexBufferData.data());
+    auto* indexOut = reinterpret_cast<uint32_t*>(IndexBufferData.data());
+    bool bHasNormals = fromMesh.has_face_normals();
+    uint32_t corner = 0;
+    for (fIter = fromMesh.faces_sbegin(); fIter != fEnd; ++fIter)
     {
-        std::array<float, 3> Pos;
-        std::array<float, 3> Normal;
+        CMeshImpl::Normal normal { 0.0f, 0.0f, 0.0f };
+        if (bHasNormals)
+            normal = fromMesh.normal(*fIter);
 
-        void SendToBuilder(CGeometryBuilder& builder) const
+        uint32_t first = corner;
+        for (auto faceVert : fromMesh.fv_range(*fIter))
         {
-            builder.Ingest(Pos[0], Pos[1], Pos[2]);
-            builder.Ingest(Normal[0], Normal[1], Normal[2]);
+            const auto& pos = fromMesh.point(faceVert);
+            *vertexOut++ = pos[0];
+            *vertexOut++ = pos[1];
+            *vertexOut++ = pos[2];
+            *vertexOut++ = normal[0];
+            *vertexOut++ = normal[1];
+            *vertexOut++ = normal[2];
+            if (corner >= first + 2)
+            {
+                *indexOut++ = first;
+                *indexOut++ = corner - 1;
+                *indexOut++ = corner;
+            }
+            corner++;
         }
-    };
-    const uint32_t stride = sizeof(CVertexData);
-    static_assert(stride == 24, "Vertex data size isn't as expected");
-    QByteArray bufferArray;
-    CAttribute attrPos { bufferArray, offsetof(CVertexData, Pos), stride,
-                         Qt3DRender::QAttribute::Float, 3 };
-    CAttribute attrNor { bufferArray, offsetof(CVertexData, Normal), stride,
-                         Qt3DRender::QAttribute::Float, 3 };
-    CGeometryBuilder builder;
-    builder.AddAttribute(&attrPos);
-    builder.AddAttribute(&attrNor);
+    }
+}
 
+void CMeshToQGeometry::FillSmooth(const CMeshImpl& fromMesh)
+{
+    uint32_t numTriangles = 0;
     CMeshImpl::FaceIter fIter, fEnd = fromMesh.faces_end();
     for (fIter = fromMesh.faces_sbegin(); fIter != fEnd; ++fIter)
     {
-        CVertexData v0, vPrev, vCurr;
+        uint32_t valence = fromMesh.valence(*fIter);
+        numTriangles += valence >= 3 ? valence - 2 : 0;
+    }
+    // Vertex handles are used as indices directly, so deleted vertices keep their slot
+    VertexCount = static_cast<uint32_t>(fromMesh.n_vertices());
+    IndexCount = numTriangles * 3;
+    VertexBufferData.resize(static_cast<int>(VertexCount * VertexStride));
+    IndexBufferData.resize(static_cast<int>(IndexCount * sizeof(uint32_t)));
+
+    auto* vertexOut = reinterpret_cast<float*>(VertexBufferData.data());
+    bool bHasNormals = fromMesh.has_vertex_normals();
+    for (uint32_t i = 0; i < VertexCount; i++)
+    {
+        CMeshImpl::VertexHandle vertex(static_cast<int>(i));
+        const auto& pos = fromMesh.point(vertex);
+        CMeshImpl::Normal normal { 0.0f, 0.0f, 0.0f };
+        if (bHasNormals)
+            normal = fromMesh.normal(vertex);
+        *vertexOut++ = pos[0];
+        *vertexOut++ = pos[1];
+        *vertexOut++ = pos[2];
+        *vertexOut++ = normal[0];
+        *vertexOut++ = normal[1];
+        *vertexOut++ = normal[2];
+    }
+
+    auto* indexOut = reinterpret_cast<uint32_t*>(IndexBufferData.data());
+    for (fIter = fromMesh.faces_sbegin(); fIter != fEnd; ++fIter)
+    {
+        uint32_t first = 0;
+        uint32_t prev = 0;
         int faceVCount = 0;
-        CMeshImpl::FaceVertexIter fvIter = CMeshImpl::FaceVertexIter(fromMesh, *fIter);
-        for (; fvIter.is_valid(); ++fvIter)
+        for (auto faceVert : fromMesh.fv_range(*fIter))
         {
-            CMeshImpl::VertexHandle faceVert = *fvIter;
+            auto curr = static_cast<uint32_t>(faceVert.idx());
             if (faceVCount == 0)
+                first = curr;
+            else if (faceVCount >= 2)
             {
-                const auto& posVec = fromMesh.point(faceVert);
-                v0.Pos = { posVec[0], posVec[1], posVec[2] };
-                const auto& fnVec = fromMesh.normal(*fIter);
-                v0.Normal = { fnVec[0], fnVec[1], fnVec[2] };
-            }
-            else if (faceVCount == 1)
-            {
-                const auto& posVec = fromMesh.point(faceVert);
-                vPrev.Pos = { posVec[0], posVec[1], posVec[2] };
-                const auto& fnVec = fromMesh.normal(*fIter);
-                vPrev.Normal = { fnVec[0], fnVec[1], fnVec[2] };
-            }
-            else
-            {
-                const auto& posVec = fromMesh.point(faceVert);
-                vCurr.Pos = { posVec[0], posVec[1], posVec[2] };
-                const auto& fnVec = fromMesh.normal(*fIter);
-                vCurr.Normal = { fnVec[0], fnVec[1], fnVec[2] };
-                v0.SendToBuilder(builder);
-                vPrev.SendToBuilder(builder);
-                vCurr.SendToBuilder(builder);
-                vPrev = vCurr;
+                *indexOut++ = first;
+                *indexOut++ = prev;
+                *indexOut++ = curr;
             }
+            prev = curr;
             faceVCount++;
         }
     }
+}
 
+Qt3DRender::QGeometry* CMeshToQGeometry::GetGeometry()
+{
+    if (Geometry)
+        return Geometry;
     Geometry = new Qt3DRender::QGeometry();
 
     auto* buffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer, Geometry);
-    buffer->setData(bufferArray);
+    buffer->setData(VertexBufferData);
 
     auto* posAttr = new Qt3DRender::QAttribute(Geometry);
     posAttr->setName(Qt3DRender::QAttribute::defaultPositionAttributeName());
     posAttr->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
     posAttr->setBuffer(buffer);
-    posAttr->setCount(builder.GetVertexCount());
-    attrPos.FillInQAttribute(posAttr);
+    posAttr->setCount(VertexCount);
+    posAttr->setByteOffset(0);
+    posAttr->setByteStride(VertexStride);
+    posAttr->setVertexBaseType(Qt3DRender::QAttribute::Float);
+    posAttr->setVertexSize(3);
     Geometry->addAttribute(posAttr);
 
     auto* normAttr = new Qt3DRender::QAttribute(Geometry);
     normAttr->setName(Qt3DRender::QAttribute::defaultNormalAttributeName());
     normAttr->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
     normAttr->setBuffer(buffer);
-    normAttr->setCount(builder.GetVertexCount());
-    attrNor.FillInQAttribute(normAttr);
+    normAttr->setCount(VertexCount);
+    normAttr->setByteOffset(sizeof(float) * 3);
+    normAttr->setByteStride(VertexStride);
+    normAttr->setVertexBaseType(Qt3DRender::QAttribute::Float);
+    normAttr->setVertexSize(3);
     Geometry->addAttribute(normAttr);
 
-    if (bGenPointGeometry)
-    {
-        PointGeometry = new Qt3DRender::QGeometry();
+    auto* indexBuffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::IndexBuffer, Geometry);
+    indexBuffer->setData(IndexBufferData);
 
-        std::vector<float> pointBufferData;
-        uint32_t vertexCount = 0;
-        for (const auto& v : fromMesh.vertices())
-        {
-            const auto& point = fromMesh.point(v);
-            const auto& color = fromMesh.color(v);
-            pointBufferData.push_back(point[0]);
-            pointBufferData.push_back(point[1]);
-            pointBufferData.push_back(point[2]);
-            // TODO: if selected, change color to something else
-            pointBufferData.push_back(color[0] / 255.0f);
-            pointBufferData.push_back(color[1] / 255.0f);
-            pointBufferData.push_back(color[2] / 255.0f);
-            printf("v%d: %d %d %d\n", vertexCount, color[0], color[1], color[2]);
-            vertexCount++;
-        }
+    auto* indexAttr = new Qt3DRender::QAttribute(Geometry);
+    indexAttr->setAttributeType(Qt3DRender::QAttribute::IndexAttribute);
+    indexAttr->setBuffer(indexBuffer);
+    indexAttr->setCount(IndexCount);
+    indexAttr->setVertexBaseType(Qt3DRender::QAttribute::UnsignedInt);
+    indexAttr->setVertexSize(1);
+    Geometry->addAttribute(indexAttr);
+    return Geometry;
+}
 
-        QByteArray copyOfBuffer { reinterpret_cast<const char*>(pointBufferData.data()),
-                                  static_cast<int>(pointBufferData.size() * sizeof(float)) };
-        auto* buffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer, PointGeometry);
-        buffer->setData(copyOfBuffer);
-
-        posAttr = new Qt3DRender::QAttribute(PointGeometry);
-        posAttr->setName(Qt3DRender::QAttribute::defaultPositionAttributeName());
-        posAttr->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
-        posAttr->setBuffer(buffer);
-        posAttr->setCount(vertexCount);
-        posAttr->setByteOffset(0);
-        posAttr->setByteStride(24);
-        posAttr->setVertexBaseType(Qt3DRender::QAttribute::Float);
-        posAttr->setVertexSize(3);
-        PointGeometry->addAttribute(posAttr);
-
-        auto* colorAttr = new Qt3DRender::QAttribute(PointGeometry);
-        colorAttr->setName(Qt3DRender::QAttribute::defaultColorAttributeName());
-        colorAttr->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
-        colorAttr->setBuffer(buffer);
-        colorAttr->setCount(vertexCount);
-        colorAttr->setByteOffset(12);
-        colorAttr->setByteStride(24);
-        colorAttr->setVertexBaseType(Qt3DRender::QAttribute::Float);
-        colorAttr->setVertexSize(3);
-        PointGeometry->addAttribute(colorAttr);
+Qt3DRender::QGeometry* CMeshToQGeometry::GetPointGeometry()
+{
+    if (PointGeometry || !bHasPoints)
+        return PointGeometry;
+    PointGeometry = new Qt3DRender::QGeometry();
+
+    auto* buffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer, PointGeometry);
+    buffer->setData(PointBufferData);
+
+    auto* posAttr = new Qt3DRender::QAttribute(PointGeometry);
+    posAttr->setName(Qt3DRender::QAttribute::defaultPositionAttributeName());
+    posAttr->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+    posAttr->setBuffer(buffer);
+    posAttr->setCount(PointCount);
+    posAttr->setByteOffset(0);
+    posAttr->setByteStride(24);
+    posAttr->setVertexBaseType(Qt3DRender::QAttribute::Float);
+    posAttr->setVertexSize(3);
+    PointGeometry->addAttribute(posAttr);
+
+    auto* colorAttr = new Qt3DRender::QAttribute(PointGeometry);
+    colorAttr->setName(Qt3DRender::QAttribute::defaultColorAttributeName());
+    colorAttr->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+    colorAttr->setBuffer(buffer);
+    colorAttr->setCount(PointCount);
+    colorAttr->setByteOffset(12);
+    colorAttr->setByteStride(24);
+    colorAttr->setVertexBaseType(Qt3DRender::QAttribute::Float);
+    colorAttr->setVertexSize(3);
+    PointGeometry->addAttribute(colorAttr);
+    return PointGeometry;
+}
+
+void CMeshToQGeometry::UpdateGeometry(Qt3DRender::QGeometry* geometry) const
+{
+    UploadToGeometry(geometry, Qt3DRender::QAttribute::VertexAttribute, VertexBufferData,
+                     VertexCount);
+    // Unchanged topology produces identical indices, in which case nothing is uploaded
+    UploadToGeometry(geometry, Qt3DRender::QAttribute::IndexAttribute, IndexBufferData,
+                     IndexCount);
+}
+
+void CMeshToQGeometry::UpdatePointGeometry(Qt3DRender::QGeometry* pointGeometry) const
+{
+    UploadToGeometry(pointGeometry, Qt3DRender::QAttribute::VertexAttribute, PointBufferData,
+                     PointCount);
+}
+
+void CMeshToQGeometry::UploadToGeometry(Qt3DRender::QGeometry* geometry,
+                                        Qt3DRender::QAttribute::AttributeType type,
+                                        const QByteArray& bytes, uint32_t count)
+{
+    QVector<Qt3DRender::QAttribute*> attributes;
+    for (auto* attr : geometry->attributes())
+        if (attr->attributeType() == type)
+            attributes.push_back(attr);
+    if (attributes.empty())
+        return;
+    auto* buffer = attributes.front()->buffer();
+
+    const QByteArray current = buffer->data();
+    if (current.size() != bytes.size())
+    {
+        // Something was added or removed, the backend has to reallocate anyway
+        buffer->setData(bytes);
+        for (auto* attr : attributes)
+            attr->setCount(count);
+        return;
     }
+
+    // Same layout, e.g. a slider drag or a selection color change, so send only the changed span
+    const char* oldBegin = current.constData();
+    const char* newBegin = bytes.constData();
+    auto firstDiff = std::mismatch(newBegin, newBegin + bytes.size(), oldBegin);
+    if (firstDiff.first == newBegin + bytes.size())
+        return;
+    auto lastDiff = std::mismatch(std::make_reverse_iterator(newBegin + bytes.size()),
+                                  std::make_reverse_iterator(firstDiff.first),
+                                  std::make_reverse_iterator(oldBegin + current.size()));
+    int offset = static_cast<int>(firstDiff.first - newBegin);
+    int length = static_cast<int>(lastDiff.first.base() - firstDiff.first);
+    buffer->updateData(offset, bytes.mid(offset, length));
 }
 
 CMeshToQGeometry::~CMeshToQGeometry()
 {
-    if (!Geometry->parent())
+    if (Geometry && !Geometry->parent())
         delete Geometry;
     if (PointGeometry && !PointGeometry->parent())
         delete PointGeometry;
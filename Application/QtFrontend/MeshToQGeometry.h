@@ -8,95 +8,26 @@
 #include <QByteArray>
 #include <Qt3DRender/QAttribute>
 #include <Qt3DRender/QGeometry>
-#include <vector>
 
 namespace Nome
 {
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> CMeshImpl;
 
-class CAttribute
+enum class EShading
 {
-public:
-    QByteArray& Buffer;
-    uint32_t ByteOffset;
-    uint32_t ByteStride;
-    Qt3DRender::QAttribute::VertexBaseType Type;
-    uint32_t Size;
-
-    CAttribute(QByteArray& buffer, uint32_t byteOffset, uint32_t byteStride,
-               Qt3DRender::QAttribute::VertexBaseType type, uint32_t size)
-        : Buffer(buffer)
-        , ByteOffset(byteOffset)
-        , ByteStride(byteStride)
-        , Type(type)
-        , Size(size)
-    {
-    }
-
-    [[nodiscard]] int GetAbsByteOffset(uint32_t i) const { return ByteOffset + ByteStride * i; }
-
-    void FillInQAttribute(Qt3DRender::QAttribute* attr) const
-    {
-        attr->setByteOffset(ByteOffset);
-        attr->setByteStride(ByteStride);
-        attr->setVertexBaseType(Type);
-        attr->setVertexSize(Size);
-    }
-};
-
-class CGeometryBuilder
-{
-public:
-    CGeometryBuilder() = default;
-
-    void AddAttribute(const CAttribute* attr) { Attributes.push_back(attr); }
-
-    void Ingest(float x, float y, float z)
-    {
-        auto* target = Attributes[CurrAttrIndex];
-
-        // Type check for target
-        assert(target->Type == Qt3DRender::QAttribute::Float);
-        assert(target->Size == 3);
-
-        // Append the buffer pointed to by target
-        const int byteLen = sizeof(float) * 3;
-        int begOffset = target->GetAbsByteOffset(CurrVertexIndex);
-        if (target->Buffer.size() < begOffset + byteLen)
-            target->Buffer.resize(begOffset + byteLen);
-        auto* beg = &*target->Buffer.begin() + begOffset;
-        auto* p = reinterpret_cast<float*>(beg);
-        *p++ = x;
-        *p++ = y;
-        *p = z;
-
-        AdvanceIndices();
-    }
-
-    [[nodiscard]] uint32_t GetVertexCount() const { return CurrVertexIndex; }
-
-protected:
-    void AdvanceIndices()
-    {
-        CurrAttrIndex++;
-        if (CurrAttrIndex == Attributes.size())
-        {
-            CurrAttrIndex = 0;
-            CurrVertexIndex++;
-        }
-    }
-
-private:
-    std::vector<const CAttribute*> Attributes;
-    uint32_t CurrVertexIndex = 0;
-    uint32_t CurrAttrIndex = 0;
+    // Every face corner gets its own vertex carrying the face normal
+    Flat,
+    // Vertices are shared between faces and carry the averaged vertex normal
+    Smooth
 };
 
+// Converts a mesh into an indexed triangle list, faces are fan triangulated
 class CMeshToQGeometry
 {
 public:
-    explicit CMeshToQGeometry(const CMeshImpl& fromMesh, bool bGenPointGeometry = false);
+    explicit CMeshToQGeometry(const CMeshImpl& fromMesh, bool bGenPointGeometry = false,
+                              EShading shading = EShading::Flat);
 
     ~CMeshToQGeometry();
 
@@ -105,10 +36,34 @@ public:
     CMeshToQGeometry& operator=(const CMeshToQGeometry&) = delete;
     CMeshToQGeometry& operator=(CMeshToQGeometry&&) = delete;
 
-    [[nodiscard]] Qt3DRender::QGeometry* GetGeometry() const { return Geometry; }
-    [[nodiscard]] Qt3DRender::QGeometry* GetPointGeometry() const { return PointGeometry; }
+    // Creates new geometry objects on first call, the caller is expected to parent them
+    [[nodiscard]] Qt3DRender::QGeometry* GetGeometry();
+    [[nodiscard]] Qt3DRender::QGeometry* GetPointGeometry();
+
+    // Refill geometries made by an earlier converter in place. Only the bytes that changed get
+    //  uploaded, and the buffer is only reallocated if its size changed.
+    void UpdateGeometry(Qt3DRender::QGeometry* geometry) const;
+    void UpdatePointGeometry(Qt3DRender::QGeometry* pointGeometry) const;
 
 private:
+    void FillFlat(const CMeshImpl& fromMesh);
+    void FillSmooth(const CMeshImpl& fromMesh);
+
+    static void UploadToGeometry(Qt3DRender::QGeometry* geometry,
+                                 Qt3DRender::QAttribute::AttributeType type,
+                                 const QByteArray& bytes, uint32_t count);
+
+    // Interleaved position and normal
+    QByteArray VertexBufferData;
+    uint32_t VertexCount = 0;
+    // Three uint32 per triangle
+    QByteArray IndexBufferData;
+    uint32_t IndexCount = 0;
+    // Interleaved position and color, one point per mesh vertex
+    QByteArray PointBufferData;
+    uint32_t PointCount = 0;
+    bool bHasPoints;
+
     Qt3DRender::QGeometry* Geometry = nullptr;
     Qt3DRender::QGeometry* PointGeometry = nullptr;
 };
@@ -10,6 +10,8 @@
 #include <QTableWidget>
 #include <QBuffer>
 
+#include <algorithm>
+
 
 namespace Nome
 {
@@ -120,6 +122,7 @@ void CNome3DView::TakeScene(const tc::TAutoPtr<Scene::CScene>& scene)
 {
     using namespace Scene;
     Scene = scene;
+    SyncedStructureVersion = InvalidStructureVersion;
     Scene->Update();
     Scene->ForEachSceneTreeNode([this](CSceneTreeNode* node) {
         printf("%s\n", node->GetPath().c_str());
@@ -147,10 +150,87 @@ void CNome3DView::UnloadScene()
     for (auto* m : InteractiveMeshes)
         delete m;
     InteractiveMeshes.clear();
+    MeshForTreeNode.clear();
+    InstancePicker.Clear();
     Scene = nullptr;
 }
 
 void CNome3DView::PostSceneUpdate()
+{
+    using namespace Scene;
+    if (Scene->GetStructureVersion() != SyncedStructureVersion)
+    {
+        SyncWithSceneTree();
+        InstancePicker.Rebuild(*Scene);
+        SyncedStructureVersion = Scene->GetStructureVersion();
+        UpdateLevelsOfDetail();
+        return;
+    }
+
+    // The tree is unchanged, so only the nodes touched by the last Scene::Update need work
+    std::unordered_set<CEntity*> entitiesToRedraw;
+    for (const auto& node : Scene->GetUpdatedTreeNodes())
+    {
+        InstancePicker.MarkDirty(node.Get());
+        auto iter = MeshForTreeNode.find(node.Get());
+        if (iter == MeshForTreeNode.end())
+            continue;
+        CInteractiveMesh* mesh = iter->second;
+        mesh->UpdateTransform();
+        if (node->WasEntityUpdated())
+        {
+            printf("Geom regen for %s\n", node->GetPath().c_str());
+            mesh->UpdateGeometry();
+            mesh->UpdateMaterial();
+            node->SetEntityUpdated(false);
+        }
+        entitiesToRedraw.insert(node->GetEntity());
+    }
+
+    for (auto* entity : entitiesToRedraw)
+    {
+        auto iter = EntityDrawData.find(entity);
+        if (iter == EntityDrawData.end())
+            continue;
+        iter->second->Reset();
+        entity->Draw(iter->second);
+        iter->second->Commit();
+    }
+    UpdateLevelsOfDetail();
+}
+
+void CNome3DView::UpdateLevelsOfDetail()
+{
+    using namespace Scene;
+    // Allow the chordal error of about one pixel at the distance of each instance's origin. Picking
+    //  and vertex selection work on the full meshes, so those are drawn while selecting.
+    QVector3D cameraPos = cameraset->position();
+    float fovY = cameraset->lens()->fieldOfView();
+    for (auto* mesh : InteractiveMeshes)
+    {
+        auto* node = mesh->GetSceneTreeNode();
+        auto* instance = dynamic_cast<CMeshInstance*>(node->GetInstanceEntity());
+        if (!instance)
+            continue;
+        int level = 0;
+        if (!vertexSelectionEnabled)
+        {
+            const auto& l2w = node->L2WTransform.GetValue(tc::Matrix3x4::IDENTITY);
+            auto origin = l2w.Translation();
+            QVector3D viewPos = rotation.rotatedVector(QVector3D(origin.x, origin.y, origin.z))
+                + QVector3D(objectX, objectY, objectZ);
+            auto scale = l2w.Scale();
+            float maxScale = std::max({ scale.x, scale.y, scale.z, 1e-6f });
+            float pixelSize = CTessellation::GetPixelSize(viewPos.distanceToPoint(cameraPos), fovY,
+                                                          static_cast<float>(height()));
+            level = CTessellation::PickLevel(pixelSize / maxScale);
+        }
+        if (instance->SetLODLevel(level))
+            mesh->UpdateGeometry();
+    }
+}
+
+void CNome3DView::SyncWithSceneTree()
 {
     using namespace Scene;
     std::unordered_map<CSceneTreeNode*, CInteractiveMesh*> sceneNodeAssoc;
@@ -158,6 +238,7 @@ void CNome3DView::PostSceneUpdate()
     std::unordered_map<Scene::CEntity*, CDebugDraw*> aliveEntityDrawData;
     for (auto* m : InteractiveMeshes)
         sceneNodeAssoc.emplace(m->GetSceneTreeNode(), m);
+    MeshForTreeNode.clear();
 
     Scene->ForEachSceneTreeNode([&](CSceneTreeNode* node) {
         // Obtain either an instance entity or a shared entity from the scene node
@@ -193,6 +274,7 @@ void CNome3DView::PostSceneUpdate()
                 aliveSet.insert(mesh);
                 InteractiveMeshes.insert(mesh);
             }
+            MeshForTreeNode[node] = mesh;
 
             // Create a DebugDraw for the CEntity if not already
             auto eIter = EntityDrawData.find(entity);
@@ -262,6 +344,18 @@ void CNome3DView::ClearSelectedVertices()
 }
 
 
+void CNome3DView::DiscardInstanceEdits()
+{
+    SelectedVertices.clear();
+    Scene->ForEachSceneTreeNode([&](Scene::CSceneTreeNode* node) {
+        auto* entity = node->GetInstanceEntity();
+        if (!entity)
+            entity = node->GetOwner()->GetEntity();
+        if (auto* meshInst = dynamic_cast<Scene::CMeshInstance*>(entity))
+            meshInst->DiscardEdits();
+    });
+}
+
 void CNome3DView::PickFaceWorldRay(tc::Ray& ray)
 {
     if (vertexSelectionEnabled)
@@ -271,21 +365,9 @@ void CNome3DView::PickFaceWorldRay(tc::Ray& ray)
         rotateRay(ray);
 
         std::vector<std::tuple<float, Scene::CMeshInstance*, std::string>> hits;
-        Scene->ForEachSceneTreeNode([&](Scene::CSceneTreeNode* node) {
-            // Obtain either an instance entity or a shared entity from the scene node
-            auto* entity = node->GetInstanceEntity();
-            if (!entity)
-                entity = node->GetOwner()->GetEntity();
-            if (entity)
-            {
-                const auto& l2w = node->L2WTransform.GetValue(tc::Matrix3x4::IDENTITY);
-                auto localRay = ray.Transformed(l2w.Inverse());
-
-                auto* meshInst = dynamic_cast<Scene::CMeshInstance*>(entity);
-                auto pickResults = meshInst->PickFaces(localRay);
-                for (const auto& [dist, name] : pickResults)
-                    hits.emplace_back(dist, meshInst, name);
-            }
+        InstancePicker.Pick(ray, [&](Scene::CMeshInstance* meshInst, const tc::Ray& localRay) {
+            for (const auto& [dist, name] : meshInst->PickFaces(localRay))
+                hits.emplace_back(dist, meshInst, name);
         });
 
         std::sort(hits.begin(), hits.end());
@@ -351,23 +433,9 @@ void CNome3DView::PickVertexWorldRay(tc::Ray& ray)
     {
         rotateRay(ray);
         std::vector<std::tuple<float, Scene::CMeshInstance*, std::string>> hits;
-        Scene->ForEachSceneTreeNode([&](Scene::CSceneTreeNode* node) {
-            // Obtain either an instance entity or a shared entity from the scene node
-            auto* entity = node->GetInstanceEntity();
-            if (!entity)
-                entity = node->GetOwner()->GetEntity();
-            if (entity)
-            {
-                const auto& l2w = node->L2WTransform.GetValue(tc::Matrix3x4::IDENTITY);
-                auto localRay = ray.Transformed(l2w.Inverse());
-                localRay.Direction =
-                    localRay.Direction
-                        .Normalized(); // Normalize to fix "scale" error caused by l2w.Inverse()
-                auto* meshInst = dynamic_cast<Scene::CMeshInstance*>(entity);
-                auto pickResults = meshInst->PickVertices(localRay);
-                for (const auto& [dist, name] : pickResults)
-                    hits.emplace_back(dist, meshInst, name);
-            }
+        InstancePicker.Pick(ray, [&](Scene::CMeshInstance* meshInst, const tc::Ray& localRay) {
+            for (const auto& [dist, name] : meshInst->PickVertices(localRay))
+                hits.emplace_back(dist, meshInst, name);
         });
 
         std::sort(hits.begin(), hits.end());
@@ -629,6 +697,8 @@ void CNome3DView::wheelEvent(QWheelEvent *ev)
         if (objectZ > 2)
             objectZ = 2;
         sphereTransform->setTranslation(QVector3D(objectX, objectY, objectZ));
+        if (Scene)
+            UpdateLevelsOfDetail();
         ev->accept();
     }
 }
@@ -643,6 +713,8 @@ void CNome3DView::keyPressEvent(QKeyEvent *ev)
         break;
     case Qt::Key_Shift:
         vertexSelectionEnabled = true;
+        if (Scene)
+            UpdateLevelsOfDetail();
         break;
     case Qt::Key_Space:
         if (animationEnabled) {
@@ -705,6 +777,8 @@ void CNome3DView::rotateRay(tc::Ray& ray) {
 }
 void CNome3DView::FreeVertexSelection() {
     vertexSelectionEnabled = false;
+    if (Scene)
+        UpdateLevelsOfDetail();
 }
 
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "InteractiveMesh.h"
 #include "OrbitTransformController.h"
 #include <Ray.h>
+#include <Scene/InstancePicker.h>
 #include <Scene/Scene.h>
 
 #include <Qt3DExtras>
@@ -25,6 +26,8 @@ public:
     }
 
     void ClearSelectedVertices(); // Randy added on 9/27
+    // Drops the selection and face deletions of every instance, whether or not selection is on
+    void DiscardInstanceEdits();
     void TakeScene(const tc::TAutoPtr<Scene::CScene>& scene);
     void UnloadScene();
     void PostSceneUpdate();
@@ -48,11 +51,21 @@ private:
     QVector2D GetProjectionPoint(QVector2D originalPosition);
     static QVector3D GetCrystalPoint(QVector2D originalPoint);
     void rotateRay(tc::Ray& ray);
+    // Full reconciliation of meshes and debug draws against the scene tree
+    void SyncWithSceneTree();
+    // Switches instances to the level of detail for their distance, only re-uploads geometry
+    void UpdateLevelsOfDetail();
+
 private:
     Qt3DCore::QEntity* Root;
     Qt3DCore::QEntity* Base;
     tc::TAutoPtr<Scene::CScene> Scene;
     std::unordered_set<CInteractiveMesh*> InteractiveMeshes;
+    std::unordered_map<Scene::CSceneTreeNode*, CInteractiveMesh*> MeshForTreeNode;
+    // Scene structure version the meshes above were built against
+    static constexpr uint64_t InvalidStructureVersion = ~0ull;
+    uint64_t SyncedStructureVersion = InvalidStructureVersion;
+    Scene::CInstancePicker InstancePicker;
     std::unordered_map<Scene::CEntity*, CDebugDraw*> EntityDrawData;
     std::vector<std::string> SelectedVertices;
     bool vertexSelectionEnabled;
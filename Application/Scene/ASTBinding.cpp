@@ -10,7 +10,7 @@
 #include <Flow/FlowNodeArray.h>
 #include <Parsing/SyntaxTree.h>
 #include <StringPrintf.h>
-#include <stack>
+#include <algorithm>
 
 namespace Nome::Scene
 {
@@ -19,8 +19,18 @@ CExprToNodeGraph::CExprToNodeGraph(AST::AExpr* expr, CBankAndSet& bankAndSet,
                                    Flow::TInput<float>* output)
     : BankAndSet(bankAndSet)
 {
-    InputStack.push(output);
     expr->Accept(this);
+    auto* node = new CExprNode(std::move(Program), Sources);
+    node->Result.Connect(*output);
+}
+
+uint32_t CExprToNodeGraph::GetSlot(Flow::CFloatNumber* source)
+{
+    // Expressions seldom read more than a few variables, a linear search is plenty
+    auto iter = std::find(Sources.begin(), Sources.end(), source);
+    if (iter == Sources.end())
+        iter = Sources.insert(Sources.end(), source);
+    return static_cast<uint32_t>(iter - Sources.begin());
 }
 
 std::any CExprToNodeGraph::VisitIdent(AST::AIdent* ident)
@@ -28,72 +38,54 @@ std::any CExprToNodeGraph::VisitIdent(AST::AIdent* ident)
     Flow::CFloatNumber* node;
     if (ident->ToString() == "time") {
         node = GEnv.Scene->GetTime();
-        node->Value.Connect(*InputStack.top());
     } else if (ident->ToString() == "frame") {
         node = GEnv.Scene->GetFrame();
-        node->Value.Connect(*InputStack.top());
     } else {
-        CSlider* sum = BankAndSet.GetSlider(ident->ToString());
-        if (!sum)
+        node = BankAndSet.GetSlider(ident->ToString());
+        if (!node)
             throw AST::CSemanticError(
                 tc::StringPrintf("Could not find slider %s", ident->ToString().c_str()), ident);
-        sum->Value.Connect(*InputStack.top());
     }
+    Program.PushVar(GetSlot(node));
     return {};
 }
 
 std::any CExprToNodeGraph::VisitNumber(AST::ANumber* number)
 {
-    auto* node = new Flow::CFloatNumber(static_cast<float>(number->AsDouble()));
-    node->Value.Connect(*InputStack.top());
+    Program.PushConst(static_cast<float>(number->AsDouble()));
     return {};
 }
 
 std::any CExprToNodeGraph::VisitUnaryOp(AST::AUnaryOp* unaryOp)
 {
+    unaryOp->GetOperand()->Accept(this);
     if (unaryOp->GetOperatorType() == AST::AUnaryOp::EOperator::Neg)
-    {
-        auto* node = new Flow::CFloatNeg();
-        InputStack.push(&node->Operand0);
-        unaryOp->GetOperand()->Accept(this);
-        InputStack.pop();
-        node->Result.Connect(*InputStack.top());
-    }
-    else
-    {
+        Program.PushOp(CExprProgram::EOp::Neg);
+    else if (unaryOp->GetOperatorType() != AST::AUnaryOp::EOperator::Plus)
         throw AST::CSemanticError("Unrecognized unary operator", unaryOp);
-    }
     return {};
 }
 
 std::any CExprToNodeGraph::VisitBinaryOp(AST::ABinaryOp* binaryOp)
 {
-    auto lambda = [this, binaryOp](auto* curr) {
-        InputStack.push(&curr->Operand0);
-        binaryOp->GetLeft()->Accept(this);
-        InputStack.pop();
-        InputStack.push(&curr->Operand1);
-        binaryOp->GetRight()->Accept(this);
-        InputStack.pop();
-        curr->Result.Connect(*InputStack.top());
-    };
-
+    binaryOp->GetLeft()->Accept(this);
+    binaryOp->GetRight()->Accept(this);
     switch (binaryOp->GetOperatorType())
     {
     case AST::ABinaryOp::EOperator::Add:
-        lambda(new Flow::CFloatAdd());
+        Program.PushOp(CExprProgram::EOp::Add);
         break;
     case AST::ABinaryOp::EOperator::Sub:
-        lambda(new Flow::CFloatSub());
+        Program.PushOp(CExprProgram::EOp::Sub);
         break;
     case AST::ABinaryOp::EOperator::Mul:
-        lambda(new Flow::CFloatMul());
+        Program.PushOp(CExprProgram::EOp::Mul);
         break;
     case AST::ABinaryOp::EOperator::Div:
-        lambda(new Flow::CFloatDiv());
+        Program.PushOp(CExprProgram::EOp::Div);
         break;
     case AST::ABinaryOp::EOperator::Exp:
-        lambda(new Flow::CFloatPow());
+        Program.PushOp(CExprProgram::EOp::Pow);
         break;
     default:
         throw AST::CSemanticError("Unrecognized binary operator", binaryOp);
@@ -103,23 +95,14 @@ std::any CExprToNodeGraph::VisitBinaryOp(AST::ABinaryOp* binaryOp)
 
 std::any CExprToNodeGraph::VisitCall(AST::ACall* call)
 {
-    auto lambda = [this, call](auto* curr) {
-        InputStack.push(&curr->Operand0);
-        const AST::AVector* operandList = call->GetOperandList();
-        if (operandList->GetItems().size() != 1)
-            throw AST::CSemanticError("Call expression may only have one argument", call);
-        operandList->GetItems()[0]->Accept(this);
-        InputStack.pop();
-        curr->Result.Connect(*InputStack.top());
-    };
-
     std::string func = call->GetFuncName();
-    if (func == "sin")
-        lambda(new Flow::CFloatSin());
-    else if (func == "cos")
-        lambda(new Flow::CFloatCos());
-    else
+    if (func != "sin" && func != "cos")
         throw AST::CSemanticError("Unrecognized function", call);
+    const AST::AVector* operandList = call->GetOperandList();
+    if (operandList->GetItems().size() != 1)
+        throw AST::CSemanticError("Call expression may only have one argument", call);
+    operandList->GetItems()[0]->Accept(this);
+    Program.PushOp(func == "sin" ? CExprProgram::EOp::Sin : CExprProgram::EOp::Cos);
     return {};
 }
 
@@ -4,13 +4,13 @@
 #include <LangUtils.h>
 #include <Parsing/SyntaxTree.h>
 #include <memory>
-#include <stack>
 #include <utility>
 
 namespace Nome::Scene
 {
 
-// Converts an AST expression tree into a flow node graph
+// Compiles an AST expression into a single CExprNode feeding output. Sliders, time and frame
+//  become variable slots of the program.
 class CExprToNodeGraph : public AST::IExprVisitor
 {
 public:
@@ -25,8 +25,11 @@ public:
     std::any VisitWrappedExpr(AST::AWrappedExpr* wrapped) override;
 
 private:
+    uint32_t GetSlot(Flow::CFloatNumber* source);
+
     CBankAndSet& BankAndSet;
-    std::stack<Flow::TInput<float>*> InputStack;
+    CExprProgram Program;
+    std::vector<Flow::CFloatNumber*> Sources;
 };
 
 struct CCommandSubpart
@@ -12,6 +12,7 @@
 #include "Point.h"
 #include "Polyline.h"
 #include "Surface.h"
+#include "Subdivision.h"
 #include "Sweep.h"
 #include "TorusKnot.h"
 #include "Torus.h"
@@ -54,7 +55,7 @@ static const std::unordered_map<std::string, ECommandKind> CommandInfoMap = {
     { "frontfaces", ECommandKind::Dummy },   { "backfaces", ECommandKind::Dummy },
     { "rimfaces", ECommandKind::Dummy },     { "bank", ECommandKind::BankSet },
     { "set", ECommandKind::BankSet },        { "delete", ECommandKind::Instance },
-    { "subdivision", ECommandKind::Dummy },  { "offset", ECommandKind::Dummy },
+    { "subdivision", ECommandKind::Entity }, { "offset", ECommandKind::Dummy },
     { "mobiusstrip", ECommandKind::Entity }, {"helix", ECommandKind::Entity }
 };
 
@@ -87,6 +88,8 @@ CEntity* CASTSceneAdapter::MakeEntity(const std::string& cmd, const std::string&
         return new CHelix(name);
     else if (cmd == "sphere")
         return new CSphere(name);
+    else if (cmd == "subdivision")
+        return new CSubdivision(name);
     else if (cmd == "sweep")
         return new CSweep(name);
     else if (cmd == "sweepcontrol")
@@ -118,6 +121,114 @@ void CASTSceneAdapter::TraverseFile(AST::AFile* astRoot, CScene& scene)
         VisitCommandSyncScene(cmd, scene, false);
 }
 
+void CASTSceneAdapter::SyncChangedCommands(AST::AFile* astRoot,
+                                           const std::vector<AST::ACommand*>& removed,
+                                           const std::vector<AST::ACommand*>& added,
+                                           CScene& scene)
+{
+    assert(CmdTraverseStack.empty());
+    std::set<AST::ACommand*> toRebuild(added.begin(), added.end());
+    std::set<std::string> changedNames;
+    for (const auto* cmds : { &removed, &added })
+        for (auto* cmd : *cmds)
+            if (!cmd->GetName().empty())
+                changedNames.insert(cmd->GetName());
+
+    // Entities, sliders and groups are looked up by name, so whatever refers to a changed name
+    //  has to be rebuilt against the new objects, and so on downstream
+    auto commands = astRoot->GetCommands();
+    std::vector<AST::ACommand*> dependents;
+    bool bFoundMore = !changedNames.empty();
+    while (bFoundMore)
+    {
+        bFoundMore = false;
+        for (auto* cmd : commands)
+        {
+            if (toRebuild.count(cmd) || !RefersToAny(cmd, changedNames))
+                continue;
+            toRebuild.insert(cmd);
+            dependents.push_back(cmd);
+            if (!cmd->GetName().empty() && changedNames.insert(cmd->GetName()).second)
+                bFoundMore = true;
+        }
+    }
+
+    for (auto* cmd : removed)
+        RemoveCommandFromScene(cmd, scene, scene.GetRootNode());
+    for (auto* cmd : dependents)
+        RemoveCommandFromScene(cmd, scene, scene.GetRootNode());
+
+    // Same two passes as TraverseFile, in file order
+    for (auto* cmd : commands)
+        if (toRebuild.count(cmd))
+            VisitCommandBankSet(cmd, scene);
+    InstanciateUnder = scene.GetRootNode();
+    for (auto* cmd : commands)
+        if (toRebuild.count(cmd))
+            VisitCommandSyncScene(cmd, scene, false);
+}
+
+void CASTSceneAdapter::RemoveCommandFromScene(AST::ACommand* cmd, CScene& scene,
+                                              CSceneNode* parent)
+{
+    const auto& cmdName = cmd->GetCommand();
+    auto name = cmd->GetName();
+    auto kind = ClassifyCommand(cmdName);
+    if (cmdName == "bank")
+    {
+        for (auto* sub : cmd->GetSubCommands())
+            scene.GetBankAndSet().RemoveSlider(name + "." + sub->GetName());
+    }
+    else if (kind == ECommandKind::Entity)
+    {
+        // Sub-entities are all named after the top level command, see VisitCommandSyncScene
+        std::vector<AST::ACommand*> stack = cmd->GetSubCommands();
+        while (!stack.empty())
+        {
+            auto* sub = stack.back();
+            stack.pop_back();
+            if (ClassifyCommand(sub->GetCommand()) == ECommandKind::Entity)
+                scene.RemoveEntity(name + "." + sub->GetName());
+            for (auto* subSub : sub->GetSubCommands())
+                stack.push_back(subSub);
+        }
+        scene.RemoveEntity(name);
+    }
+    else if (cmdName == "instance")
+    {
+        if (auto* node = parent->FindChildNode(name))
+            node->Detach();
+    }
+    else if (cmdName == "group")
+    {
+        if (auto group = scene.FindGroup(name))
+        {
+            // Tear down the nested instances through the group they hang off, whether or not the
+            //  group itself is instantiated somewhere
+            for (auto* sub : cmd->GetSubCommands())
+                RemoveCommandFromScene(sub, scene, group);
+            group->Detach();
+            scene.RemoveGroup(name);
+        }
+    }
+}
+
+bool CASTSceneAdapter::RefersToAny(AST::ACommand* cmd, const std::set<std::string>& names)
+{
+    // Over-approximates by looking at every token, keywords included. Paths like "inst.mesh.v1"
+    //  and sliders like "bank.x" depend on their first component.
+    std::vector<AST::CToken*> tokens;
+    cmd->CollectTokens(tokens);
+    for (auto* token : tokens)
+    {
+        auto text = token->ToString();
+        size_t begin = !text.empty() && text[0] == '.' ? 1 : 0;
+        if (names.count(text.substr(begin, text.find('.', begin) - begin)))
+            return true;
+    }
+    return false;
+}
+
 void CASTSceneAdapter::VisitCommandBankSet(AST::ACommand* cmd, CScene& scene)
 {
     CmdTraverseStack.push_back(cmd);
@@ -1,6 +1,7 @@
 #pragma once
 #include "Scene.h"
 #include <Parsing/SyntaxTree.h>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -23,8 +24,17 @@ public:
     static CTransform* ConvertASTTransform(AST::ANamedArgument* namedArg);
 
     void TraverseFile(AST::AFile* astRoot, CScene& scene);
+    // After an incremental reparse: tears down what the removed top level commands created and
+    //  builds the added ones. Commands referring to a name either of them defines are redone too.
+    void SyncChangedCommands(AST::AFile* astRoot, const std::vector<AST::ACommand*>& removed,
+                             const std::vector<AST::ACommand*>& added, CScene& scene);
 
 private:
+    // Undoes VisitCommandBankSet and VisitCommandSyncScene for a command. Instance nodes are looked
+    //  up under parent, the root for top level commands and the group for ones nested in a group.
+    static void RemoveCommandFromScene(AST::ACommand* cmd, CScene& scene, CSceneNode* parent);
+    static bool RefersToAny(AST::ACommand* cmd, const std::set<std::string>& names);
+
     void VisitCommandBankSet(AST::ACommand* cmd, CScene& scene);
     void VisitCommandSyncScene(AST::ACommand* cmd, CScene& scene, bool insubMesh);
 
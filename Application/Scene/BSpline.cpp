@@ -19,54 +19,24 @@ void CBSpline::MarkDirty()
 }
 
 
-Matrix3 CBSplineMath::FrenetFrameAt(float t) {
-    return Matrix3();
-}
+Matrix3 CBSplineMath::FrenetFrameAt(float t) { return Curve.FrenetFrameAt(t); }
 
 void CBSpline::SetClosed(bool closed) {
     bClosed = closed;
 }
 
 std::vector<float> CBSplineMath::GetDefaultKnots() {
-    std::vector<float> result = {0.0f, 0.5f, 1.0f};
+    std::vector<float> result;
+    if (Segments <= 0)
+        return result;
+    float begin = Curve.GetBegin();
+    float step = (Curve.GetEnd() - begin) / Segments;
+    for (int i = 0; i < Segments; i++)
+        result.push_back(begin + i * step);
+    result.push_back(Curve.GetEnd());
     return result;
 }
 
-std::vector<float> CBSpline::GetDefKnots() {
-    float numKnots = Order.GetValue(3) + ((float) ControlPoints.GetSize());
-    std::vector<float> result = {};
-    for (int i = 0; i < numKnots; i++) {
-        result.push_back(i);
-    }
-    return result;
-}
-
-float CBSpline::NFactor(int i, int k, float t) {
-    std::vector<float> knots = GetDefKnots();
-    if (k == 1) {
-        if (knots[i - 1] <= t && t < knots[i]) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-    float numA = (t - knots[i-1]);
-    float denA = (knots[i + k - 2] - knots[i-1]);
-    float numB = (knots[i + k - 1] - t);
-    float denB = (knots[i + k - 1] - knots[i]);
-    float weightA = 0;
-    float weightB = 0;
-
-    if (denA != 0) {
-        weightA = (numA / denA) * NFactor(i, k-1, t);
-    }
-    if (denB != 0) {
-        weightB = (numB / denB) * NFactor(i + 1, k-1, t);
-    }
-    return weightA + weightB;
-}
-
-
 void CBSpline::UpdateEntity() {
     if (!IsDirty())
         return;
@@ -77,17 +47,14 @@ void CBSpline::UpdateEntity() {
     size_t howMany = ControlPoints.GetSize();
     int order = (int) Order.GetValue(3);
 
-    SamplePositions.clear();
-
-    for (float steps = 0; steps <= n; steps++) {
-        float t =  ((steps / Segments.GetValue(8.0f)) * (howMany - order + 1)) + (order - 1);
-        Vector3 ret = {0,0,0};
-        for (int i = 0; i < howMany; i++) {
-            float weight = NFactor(i+1,order,t);
-            ret += weight * ControlPoints.GetValue(i, nullptr)->Position;
-        }
-        SamplePositions.emplace_back(ret.x, ret.y, ret.z);
-    }
+    std::vector<Vector3> controlPoints;
+    controlPoints.reserve(howMany);
+    for (size_t i = 0; i < howMany; i++)
+        controlPoints.push_back(ControlPoints.GetValue(i, nullptr)->Position);
+    Math.Curve.Build(controlPoints, order);
+    Math.Segments = Math.Curve.IsEmpty() ? 0 : n;
+    Math.Curve.Evaluate(Math.GetDefaultKnots(), SamplePositions);
+    n = static_cast<int>(SamplePositions.size()) - 1;
 
     std::vector<CMeshImpl::VertexHandle> handles;
     handles.reserve(n + 1);
@@ -95,7 +62,7 @@ void CBSpline::UpdateEntity() {
     std::vector<CVertexInfo> positions;
     for (int i = 0; i < n + 1; i++)
     {
-        handles.push_back(AddVertex("v" + std::to_string(i), SamplePositions[i]));
+        handles.push_back(AddVertex(CGridName("v", i), SamplePositions[i]));
         CVertexInfo point;
         point.Position = SamplePositions[i];
         positions.push_back(point);
@@ -114,6 +81,8 @@ void CBSpline::UpdateEntity() {
 
 void CBSpline::Draw(IDebugDraw* draw)
 {
+    if (SamplePositions.size() < 2)
+        return;
     tc::Color c1 = tc::Color::YELLOW;
     tc::Color c2 = tc::Color::RED;
     auto iter = SamplePositions.begin();
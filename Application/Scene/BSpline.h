@@ -1,4 +1,5 @@
 #pragma once
+#include "BSplineCurve.h"
 #include "BezierSpline.h"
 #include "SweepPath.h"
 
@@ -11,8 +12,11 @@ public:
     /// Get the frenet frame at t
     Matrix3 FrenetFrameAt(float t) override;
 
-    /// Get a default list of t values to use
+    /// Get a default list of t values to use, evenly spread over the range of the curve
     std::vector<float> GetDefaultKnots() override;
+
+    CBSplineCurve Curve;
+    int Segments = 0;
 };
 
 class CBSpline : public CSweepPath
@@ -39,11 +43,9 @@ public:
 
     /// Set whether the bspline is a closed loop
     void SetClosed(bool closed);
-    std::vector<float> GetDefKnots();
     void UpdateEntity() override;
     void MarkDirty() override;
     void Draw(IDebugDraw* draw) override;
-    float NFactor(int i, int j, float t);
 
 private:
     CBSplineMath Math;
@@ -0,0 +1,140 @@
+#include "BSplineCurve.h"
+#include <ThreadPool.h>
+#include <algorithm>
+#include <cmath>
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Nome::Scene
+{
+
+void CBSplineCurve::Build(const std::vector<tc::Vector3>& controlPoints, int order)
+{
+    NumPoints = static_cast<int>(controlPoints.size());
+    Order = NumPoints == 0 ? 0 : std::clamp(order, 1, NumPoints);
+    Knots.resize(NumPoints + Order);
+    for (size_t i = 0; i < Knots.size(); i++)
+        Knots[i] = static_cast<float>(i);
+
+    Points[0].clear();
+    for (const auto& point : controlPoints)
+        Points[0].insert(Points[0].end(), { point.x, point.y, point.z, 0.0f });
+
+    // The d-th derivative is a spline of degree p - d with one control point fewer than the last,
+    //  the scaled differences of neighbouring control points
+    const int degree = Order - 1;
+    for (int d = 1; d <= MaxDerivative; d++)
+    {
+        auto& points = Points[d];
+        const auto& prev = Points[d - 1];
+        points.clear();
+        if (d > degree)
+            continue;
+        for (int i = 0; i < NumPoints - d; i++)
+        {
+            float span = Knots[i + degree + 1] - Knots[i + d];
+            float scale = span > 0.0f ? static_cast<float>(degree - d + 1) / span : 0.0f;
+            for (int k = 0; k < 4; k++)
+                points.push_back(scale * (prev[(i + 1) * 4 + k] - prev[i * 4 + k]));
+        }
+    }
+}
+
+int CBSplineCurve::FindSpan(float t) const
+{
+    // The span s with knot s <= t < knot s + 1, the end of the range belongs to the last span
+    const int degree = Order - 1;
+    auto iter = std::upper_bound(Knots.begin() + degree, Knots.begin() + NumPoints, t);
+    return std::max(static_cast<int>(iter - Knots.begin()) - 1, degree);
+}
+
+void CBSplineCurve::EvaluateInSpan(float t, int derivative, float* scratch, float* out) const
+{
+    const int degree = Order - 1;
+    const int q = degree - derivative;
+    if (q < 0)
+    {
+        std::fill(out, out + 4, 0.0f);
+        return;
+    }
+    t = std::clamp(t, GetBegin(), GetEnd());
+    const int span = FindSpan(t);
+
+    // The knots of the d-th derivative are those of the curve without the first d
+    const float* knots = Knots.data();
+    const float* points = Points[derivative].data() + (span - degree) * 4;
+    std::copy(points, points + (q + 1) * 4, scratch);
+    for (int r = 1; r <= q; r++)
+    {
+        for (int j = q; j >= r; j--)
+        {
+            float left = knots[j + span - degree + derivative];
+            float right = knots[j + 1 + span - r];
+            float alpha = right > left ? (t - left) / (right - left) : 0.0f;
+            float* dst = scratch + j * 4;
+            const float* src = scratch + (j - 1) * 4;
+#ifdef URHO3D_SSE
+            __m128 a = _mm_loadu_ps(src);
+            __m128 b = _mm_loadu_ps(dst);
+            _mm_storeu_ps(dst, _mm_add_ps(a, _mm_mul_ps(_mm_set1_ps(alpha), _mm_sub_ps(b, a))));
+#else
+            for (int k = 0; k < 3; k++)
+                dst[k] = src[k] + alpha * (dst[k] - src[k]);
+#endif
+        }
+    }
+    std::copy(scratch + q * 4, scratch + q * 4 + 4, out);
+}
+
+tc::Vector3 CBSplineCurve::Evaluate(float t, int derivative) const
+{
+    if (IsEmpty() || derivative < 0 || derivative > MaxDerivative)
+        return tc::Vector3::ZERO;
+    std::vector<float> scratch(Order * 4);
+    float out[4];
+    EvaluateInSpan(t, derivative, scratch.data(), out);
+    return { out[0], out[1], out[2] };
+}
+
+void CBSplineCurve::Evaluate(const std::vector<float>& params, std::vector<tc::Vector3>& result,
+                             int derivative) const
+{
+    result.resize(params.size());
+    if (IsEmpty() || derivative < 0 || derivative > MaxDerivative)
+    {
+        std::fill(result.begin(), result.end(), tc::Vector3::ZERO);
+        return;
+    }
+    tc::FThreadPool::Get().ParallelFor(params.size(), 1024, [&](size_t begin, size_t end) {
+        std::vector<float> scratch(Order * 4);
+        float out[4];
+        for (size_t i = begin; i < end; i++)
+        {
+            EvaluateInSpan(params[i], derivative, scratch.data(), out);
+            result[i] = { out[0], out[1], out[2] };
+        }
+    });
+}
+
+tc::Matrix3 CBSplineCurve::FrenetFrameAt(float t) const
+{
+    auto d1 = Evaluate(t, 1);
+    auto d2 = Evaluate(t, 2);
+    auto tangent = d1.Normalized();
+    if (tangent == tc::Vector3::ZERO)
+        tangent = tc::Vector3::RIGHT;
+
+    auto binormal = d1.CrossProduct(d2);
+    if (binormal.Length() <= 1e-6f * d1.Length() * d2.Length())
+    {
+        // Straight here, so any axis not along the tangent will do
+        auto axis = std::abs(tangent.x) < 0.9f ? tc::Vector3::RIGHT : tc::Vector3::UP;
+        binormal = tangent.CrossProduct(axis);
+    }
+    binormal.Normalize();
+    auto normal = binormal.CrossProduct(tangent);
+    return { tangent, normal, binormal };
+}
+
+}
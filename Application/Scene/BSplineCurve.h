@@ -0,0 +1,48 @@
+#pragma once
+#include <Matrix3.h>
+#include <Vector3.h>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+// B-spline with the uniform knots 0, 1, 2 and so on that the bspline command has always used.
+//  Build works out the knots and the control points of the derivatives once, evaluating a
+//  parameter after that is a span search and de Boor's algorithm.
+class CBSplineCurve
+{
+public:
+    static constexpr int MaxDerivative = 2;
+
+    // The order is clamped to the number of control points
+    void Build(const std::vector<tc::Vector3>& controlPoints, int order);
+
+    [[nodiscard]] bool IsEmpty() const { return Order == 0; }
+    [[nodiscard]] int GetOrder() const { return Order; }
+    [[nodiscard]] const std::vector<float>& GetKnots() const { return Knots; }
+    // The parameter range over which the basis functions sum up to one
+    [[nodiscard]] float GetBegin() const { return IsEmpty() ? 0.0f : Knots[Order - 1]; }
+    [[nodiscard]] float GetEnd() const { return IsEmpty() ? 0.0f : Knots[NumPoints]; }
+
+    // Parameters outside the range are clamped to it
+    [[nodiscard]] tc::Vector3 Evaluate(float t, int derivative = 0) const;
+    // One result per parameter, long batches are split over the thread pool
+    void Evaluate(const std::vector<float>& params, std::vector<tc::Vector3>& result,
+                  int derivative = 0) const;
+    // Columns are the unit tangent, normal and binormal. Where the curve does not bend, the
+    //  normal is just some vector perpendicular to the tangent.
+    [[nodiscard]] tc::Matrix3 FrenetFrameAt(float t) const;
+
+private:
+    [[nodiscard]] int FindSpan(float t) const;
+    // scratch holds four floats per order, the result is written to out
+    void EvaluateInSpan(float t, int derivative, float* scratch, float* out) const;
+
+    int Order = 0;
+    int NumPoints = 0;
+    std::vector<float> Knots;
+    // Control points of the curve and of its derivatives, padded to four floats for SSE
+    std::vector<float> Points[MaxDerivative + 1];
+};
+
+}
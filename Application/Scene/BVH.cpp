@@ -0,0 +1,91 @@
+#include "BVH.h"
+#include <algorithm>
+
+namespace Nome::Scene
+{
+
+void CBVH::Build(std::vector<tc::BoundingBox> itemBoxes)
+{
+    Clear();
+    ItemBoxes = std::move(itemBoxes);
+    if (ItemBoxes.empty())
+        return;
+    Items.resize(ItemBoxes.size());
+    for (uint32_t i = 0; i < Items.size(); i++)
+        Items[i] = i;
+    ItemLeaf.resize(ItemBoxes.size());
+    Nodes.reserve(2 * (ItemBoxes.size() / MaxLeafItems + 1));
+    BuildNode(0, static_cast<uint32_t>(Items.size()), UINT32_MAX);
+}
+
+void CBVH::Refit(uint32_t item, const tc::BoundingBox& box)
+{
+    ItemBoxes[item] = box;
+    uint32_t index = ItemLeaf[item];
+    UpdateLeafBox(Nodes[index]);
+    while (Nodes[index].Parent != UINT32_MAX)
+    {
+        index = Nodes[index].Parent;
+        auto& node = Nodes[index];
+        node.Box = Nodes[index + 1].Box;
+        node.Box.Merge(Nodes[node.Right].Box);
+    }
+}
+
+void CBVH::Clear()
+{
+    Nodes.clear();
+    Items.clear();
+    ItemBoxes.clear();
+    ItemLeaf.clear();
+}
+
+uint32_t CBVH::BuildNode(uint32_t begin, uint32_t end, uint32_t parent)
+{
+    auto index = static_cast<uint32_t>(Nodes.size());
+    Nodes.emplace_back();
+    Nodes[index].Parent = parent;
+    if (end - begin <= MaxLeafItems)
+    {
+        Nodes[index].First = begin;
+        Nodes[index].Count = end - begin;
+        for (uint32_t i = begin; i < end; i++)
+            ItemLeaf[Items[i]] = index;
+        UpdateLeafBox(Nodes[index]);
+        return index;
+    }
+
+    // Empty items have no center, they go wherever 0 falls
+    auto center = [this](uint32_t item) {
+        const auto& box = ItemBoxes[item];
+        return box.Defined() ? box.Center() : tc::Vector3::ZERO;
+    };
+    tc::BoundingBox centers;
+    for (uint32_t i = begin; i < end; i++)
+        centers.Merge(center(Items[i]));
+    tc::Vector3 size = centers.Size();
+    int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(Items.begin() + begin, Items.begin() + mid, Items.begin() + end,
+                     [&](uint32_t lhs, uint32_t rhs) {
+                         return center(lhs).Data()[axis] < center(rhs).Data()[axis];
+                     });
+
+    BuildNode(begin, mid, index);
+    uint32_t right = BuildNode(mid, end, index);
+    auto& node = Nodes[index];
+    node.Right = right;
+    node.Box = Nodes[index + 1].Box;
+    node.Box.Merge(Nodes[right].Box);
+    return index;
+}
+
+void CBVH::UpdateLeafBox(CNode& leaf) const
+{
+    leaf.Box.Clear();
+    for (uint32_t i = leaf.First; i < leaf.First + leaf.Count; i++)
+        if (ItemBoxes[Items[i]].Defined())
+            leaf.Box.Merge(ItemBoxes[Items[i]]);
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <BoundingBox.h>
+#include <Ray.h>
+#include <cstdint>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+// Binary tree of boxes over a fixed list of items, split at the median of the longest axis.
+//  Moving an item afterwards only refits the boxes above it, the shape of the tree is kept until
+//  the next Build.
+class CBVH
+{
+public:
+    void Build(std::vector<tc::BoundingBox> itemBoxes);
+    void Refit(uint32_t item, const tc::BoundingBox& box);
+    void Clear();
+
+    [[nodiscard]] size_t GetNumItems() const { return ItemBoxes.size(); }
+    [[nodiscard]] const tc::BoundingBox& GetItemBox(uint32_t item) const
+    {
+        return ItemBoxes[item];
+    }
+    // Undefined if there are no items
+    [[nodiscard]] tc::BoundingBox GetBounds() const
+    {
+        return Nodes.empty() ? tc::BoundingBox() : Nodes[0].Box;
+    }
+
+    // Calls itemFunc on every item whose box and all boxes above it pass boxTest
+    template <typename TBoxTest, typename TItemFunc>
+    void Query(const TBoxTest& boxTest, const TItemFunc& itemFunc) const
+    {
+        if (Nodes.empty())
+            return;
+        // Median splits keep the depth logarithmic, so this never runs out
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const auto& node = Nodes[stack[--top]];
+            if (!boxTest(node.Box))
+                continue;
+            if (node.Count == 0)
+            {
+                stack[top++] = node.Right;
+                stack[top++] = static_cast<uint32_t>(&node - Nodes.data()) + 1;
+                continue;
+            }
+            for (uint32_t i = node.First; i < node.First + node.Count; i++)
+                if (boxTest(ItemBoxes[Items[i]]))
+                    itemFunc(Items[i]);
+        }
+    }
+
+    // Items whose box the ray goes through, even if the origin is inside
+    template <typename TItemFunc> void QueryRay(const tc::Ray& ray, const TItemFunc& itemFunc) const
+    {
+        Query([&](const tc::BoundingBox& box) { return ray.HitDistance(box) < tc::M_INFINITY; },
+              itemFunc);
+    }
+
+private:
+    static constexpr uint32_t MaxLeafItems = 4;
+
+    struct CNode
+    {
+        tc::BoundingBox Box;
+        uint32_t Parent;
+        // Inner nodes have no items, their left child comes right after them
+        uint32_t Right = 0;
+        uint32_t First = 0;
+        uint32_t Count = 0;
+    };
+
+    uint32_t BuildNode(uint32_t begin, uint32_t end, uint32_t parent);
+    void UpdateLeafBox(CNode& leaf) const;
+
+    std::vector<CNode> Nodes;
+    // Item indices grouped by leaf
+    std::vector<uint32_t> Items;
+    std::vector<tc::BoundingBox> ItemBoxes;
+    std::vector<uint32_t> ItemLeaf;
+};
+
+}
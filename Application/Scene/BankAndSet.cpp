@@ -1,4 +1,6 @@
 #include "BankAndSet.h"
+#include "ExprEval.h"
+#include <algorithm>
 
 namespace Nome::Scene
 {
@@ -14,14 +16,29 @@ CSlider::CSlider(AST::ACommand* cmd, float value, float min, float max, float st
 
 void CSlider::SetValue(float value)
 {
+    if (value == GetNumber())
+        return;
     SetNumber(value);
+    for (auto* expr : Dependents)
+        expr->Result.Update();
+}
+
+void CSlider::RemoveDependent(CExprNode* expr)
+{
+    auto iter = std::find(Dependents.begin(), Dependents.end(), expr);
+    if (iter != Dependents.end())
+    {
+        *iter = Dependents.back();
+        Dependents.pop_back();
+    }
 }
 
 CBankAndSet::~CBankAndSet()
 {
-    for (const auto& nameSlider : Sliders)
+    ForEachSlider([this](const std::string& name, CSlider& slider) {
         for (auto* observer : Observers)
-            observer->OnSliderRemoving(*nameSlider.second, nameSlider.first);
+            observer->OnSliderRemoving(slider, name);
+    });
 }
 
 void CBankAndSet::AddSlider(const std::string& name, AST::ACommand* cmd, float value, float min,
@@ -32,29 +49,36 @@ void CBankAndSet::AddSlider(const std::string& name, AST::ACommand* cmd, float v
         throw std::runtime_error("Slider already exists");
     }
     auto* slider = new CSlider(cmd, value, min, max, step);
-    Sliders.insert({ name, slider });
+    Sliders.Insert(name, slider);
 
     for (auto* observer : Observers)
         observer->OnSliderAdded(*slider, name);
 }
 
-CSlider* CBankAndSet::GetSlider(const std::string& name)
+void CBankAndSet::RemoveSlider(const std::string& name)
 {
-    std::map<std::string, tc::TAutoPtr<CSlider>>::iterator iter;
-    if (name.size() > 1 && name[0] == '$')
-        iter = Sliders.find(name.substr(1));
-    else
-        iter = Sliders.find(name);
+    uint32_t id = Sliders.Find(name);
+    if (id == Sliders.InvalidId)
+        return;
+    for (auto* observer : Observers)
+        observer->OnSliderRemoving(*Sliders.GetValue(id), name);
+    Sliders.EraseId(id);
+}
 
-    if (iter != Sliders.end())
-        return iter->second;
-    return nullptr;
+CSlider* CBankAndSet::GetSlider(const std::string& name)
+{
+    std::string_view key = name;
+    if (key.size() > 1 && key[0] == '$')
+        key.remove_prefix(1);
+    const auto* slider = Sliders.FindValue(key);
+    return slider ? slider->Get() : nullptr;
 }
 
 void CBankAndSet::AddObserver(ISliderObserver* observer)
 {
-    for (const auto& nameSlider : Sliders)
-        observer->OnSliderAdded(*nameSlider.second, nameSlider.first);
+    ForEachSlider([observer](const std::string& name, CSlider& slider) {
+        observer->OnSliderAdded(slider, name);
+    });
     Observers.insert(observer);
 }
 
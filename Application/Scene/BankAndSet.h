@@ -1,19 +1,24 @@
 #pragma once
 #include <Flow/Arithmetics.h>
 #include <LangUtils.h>
+#include "NameMap.h"
 #include <Parsing/SyntaxTree.h>
-#include <map>
 #include <set>
 #include <stdexcept>
+#include <vector>
 
 namespace Nome::Scene
 {
 
+class CExprNode;
+
 class CSlider : public Flow::CFloatNumber
 {
 public:
     CSlider(AST::ACommand* cmd, float value, float min, float max, float step);
 
+    // Also brings every expression reading the slider up to date in one go, so that entities
+    //  pulling them later find their values ready
     void SetValue(float value);
 
     float GetMin() const { return Min; }
@@ -22,11 +27,15 @@ public:
     float GetValue() const { return GetNumber(); }
     AST::ACommand* GetASTNode() const { return Cmd; }
 
+    void AddDependent(CExprNode* expr) { Dependents.push_back(expr); }
+    void RemoveDependent(CExprNode* expr);
+
 private:
     AST::ACommand* Cmd;
     float Min;
     float Max;
     float Step;
+    std::vector<CExprNode*> Dependents;
 };
 
 class ISliderObserver : public tc::FNonCopyable
@@ -47,14 +56,22 @@ public:
 
     void AddSlider(const std::string& name, AST::ACommand* cmd, float value, float min, float max,
                    float step);
+    void RemoveSlider(const std::string& name);
     CSlider* GetSlider(const std::string& name);
 
+    // In name order
+    template <typename TFunc> void ForEachSlider(const TFunc& func) const
+    {
+        for (uint32_t id : Sliders.FindWithPrefix(""))
+            func(Sliders.GetName(id), *Sliders.GetValue(id));
+    }
+
     // An observer is typically the GUI that is responsible for displaying the sliders
     void AddObserver(ISliderObserver* observer);
     void RemoveObserver(ISliderObserver* observer) { Observers.erase(observer); }
 
 private:
-    std::map<std::string, tc::TAutoPtr<CSlider>> Sliders;
+    TNameMap<tc::TAutoPtr<CSlider>> Sliders;
     std::set<ISliderObserver*> Observers;
 };
 
@@ -69,7 +69,7 @@ void CBezierSpline::UpdateEntity()
     std::vector<CMeshImpl::VertexHandle> handles;
     for (int i = 0; i < n + 1; i++)
     {
-        handles.push_back(AddVertex("v" + std::to_string(i), positions[i]));
+        handles.push_back(AddVertex(CGridName("v", i), positions[i]));
     }
     AddLineStrip("curve", handles);
 }
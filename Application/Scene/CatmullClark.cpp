@@ -0,0 +1,283 @@
+#include "CatmullClark.h"
+#include <algorithm>
+#include <unordered_map>
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Nome::Scene
+{
+
+namespace
+{
+
+// Padded to four floats, so a whole point goes through one SSE register
+struct alignas(16) CPoint4
+{
+    float V[4];
+};
+
+// Collects the weights of one new vertex, the same source may come up several times
+class CStencilBuilder
+{
+public:
+    void Add(uint32_t source, float weight) { Terms.emplace_back(source, weight); }
+
+    void AddFace(const uint32_t* verts, size_t count, float weight)
+    {
+        for (size_t i = 0; i < count; i++)
+            Add(verts[i], weight / static_cast<float>(count));
+    }
+
+    template <typename TTable> void Flush(TTable& table)
+    {
+        std::sort(Terms.begin(), Terms.end());
+        for (size_t i = 0; i < Terms.size(); i++)
+        {
+            if (i > 0 && Terms[i].first == Terms[i - 1].first)
+                table.Weights.back() += Terms[i].second;
+            else
+            {
+                table.Sources.push_back(Terms[i].first);
+                table.Weights.push_back(Terms[i].second);
+            }
+        }
+        table.Starts.push_back(static_cast<uint32_t>(table.Sources.size()));
+        Terms.clear();
+    }
+
+private:
+    std::vector<std::pair<uint32_t, float>> Terms;
+};
+
+}
+
+void CCatmullClark::Build(const CPolygonTopology& base, int numLevels)
+{
+    Base = base;
+    Levels.clear();
+    Levels.resize(std::max(numLevels, 0));
+    Result = base;
+    for (auto& stencils : Levels)
+    {
+        CPolygonTopology next;
+        Subdivide(Result, stencils, next);
+        Result = std::move(next);
+    }
+    bBuilt = true;
+}
+
+void CCatmullClark::Subdivide(const CPolygonTopology& from, CStencilTable& stencils,
+                              CPolygonTopology& to)
+{
+    const uint32_t numVerts = from.NumVerts;
+    const auto numFaces = static_cast<uint32_t>(from.GetNumFaces());
+    auto faceBegin = [&](uint32_t face) { return from.FaceVerts.data() + from.FaceStarts[face]; };
+    auto faceSize = [&](uint32_t face) {
+        return static_cast<size_t>(from.FaceStarts[face + 1] - from.FaceStarts[face]);
+    };
+
+    // Number the edges, cornerEdges[c] is the edge from corner c to the next corner of its face
+    struct CEdge
+    {
+        uint32_t V0, V1;
+        uint32_t Faces[2];
+        uint32_t NumFaces = 0;
+    };
+    std::vector<CEdge> edges;
+    std::vector<uint32_t> cornerEdges(from.FaceVerts.size());
+    std::unordered_map<uint64_t, uint32_t> edgeIndex;
+    edgeIndex.reserve(from.FaceVerts.size());
+    for (uint32_t face = 0; face < numFaces; face++)
+    {
+        const uint32_t* verts = faceBegin(face);
+        size_t count = faceSize(face);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t v0 = verts[i];
+            uint32_t v1 = verts[(i + 1) % count];
+            uint64_t key = (static_cast<uint64_t>(std::min(v0, v1)) << 32) | std::max(v0, v1);
+            auto [iter, bInserted] = edgeIndex.emplace(key, static_cast<uint32_t>(edges.size()));
+            if (bInserted)
+                edges.push_back({ v0, v1, { 0, 0 }, 0 });
+            auto& edge = edges[iter->second];
+            // More than two faces make the edge non-manifold, it is then treated as a boundary
+            if (edge.NumFaces < 2)
+                edge.Faces[edge.NumFaces] = face;
+            edge.NumFaces++;
+            cornerEdges[from.FaceStarts[face] + i] = iter->second;
+        }
+    }
+    const auto numEdges = static_cast<uint32_t>(edges.size());
+
+    // Faces and edges around every vertex
+    std::vector<uint32_t> vertFaceStarts(numVerts + 1, 0);
+    std::vector<uint32_t> vertEdgeStarts(numVerts + 1, 0);
+    for (uint32_t v : from.FaceVerts)
+        vertFaceStarts[v + 1]++;
+    for (const auto& edge : edges)
+    {
+        vertEdgeStarts[edge.V0 + 1]++;
+        vertEdgeStarts[edge.V1 + 1]++;
+    }
+    for (uint32_t v = 0; v < numVerts; v++)
+    {
+        vertFaceStarts[v + 1] += vertFaceStarts[v];
+        vertEdgeStarts[v + 1] += vertEdgeStarts[v];
+    }
+    std::vector<uint32_t> vertFaces(vertFaceStarts.back());
+    std::vector<uint32_t> vertEdges(vertEdgeStarts.back());
+    {
+        std::vector<uint32_t> faceFill(vertFaceStarts.begin(), vertFaceStarts.end() - 1);
+        for (uint32_t face = 0; face < numFaces; face++)
+            for (size_t i = 0; i < faceSize(face); i++)
+                vertFaces[faceFill[faceBegin(face)[i]]++] = face;
+        std::vector<uint32_t> edgeFill(vertEdgeStarts.begin(), vertEdgeStarts.end() - 1);
+        for (uint32_t e = 0; e < numEdges; e++)
+        {
+            vertEdges[edgeFill[edges[e].V0]++] = e;
+            vertEdges[edgeFill[edges[e].V1]++] = e;
+        }
+    }
+
+    stencils = CStencilTable();
+    stencils.Sources.reserve(from.FaceVerts.size() * 4 + numVerts * 8);
+    stencils.Weights.reserve(stencils.Sources.capacity());
+    CStencilBuilder builder;
+
+    // Vertex points
+    for (uint32_t v = 0; v < numVerts; v++)
+    {
+        uint32_t n = vertEdgeStarts[v + 1] - vertEdgeStarts[v];
+        uint32_t numVertFaces = vertFaceStarts[v + 1] - vertFaceStarts[v];
+        uint32_t boundary[2];
+        uint32_t numBoundary = 0;
+        for (uint32_t i = vertEdgeStarts[v]; i < vertEdgeStarts[v + 1]; i++)
+        {
+            const auto& edge = edges[vertEdges[i]];
+            if (edge.NumFaces != 2)
+            {
+                if (numBoundary < 2)
+                    boundary[numBoundary] = edge.V0 == v ? edge.V1 : edge.V0;
+                numBoundary++;
+            }
+        }
+
+        if (numBoundary == 0 && n >= 3 && numVertFaces == n)
+        {
+            // (F + 2R + (n - 3)P) / n with F the average face point and R the average midpoint
+            float nn = static_cast<float>(n) * static_cast<float>(n);
+            for (uint32_t i = vertFaceStarts[v]; i < vertFaceStarts[v + 1]; i++)
+                builder.AddFace(faceBegin(vertFaces[i]), faceSize(vertFaces[i]), 1.0f / nn);
+            for (uint32_t i = vertEdgeStarts[v]; i < vertEdgeStarts[v + 1]; i++)
+            {
+                builder.Add(edges[vertEdges[i]].V0, 1.0f / nn);
+                builder.Add(edges[vertEdges[i]].V1, 1.0f / nn);
+            }
+            builder.Add(v, (static_cast<float>(n) - 3.0f) / static_cast<float>(n));
+        }
+        else if (numBoundary == 2 && n > 2)
+        {
+            // Boundary curves are subdivided as cubic B-splines
+            builder.Add(v, 0.75f);
+            builder.Add(boundary[0], 0.125f);
+            builder.Add(boundary[1], 0.125f);
+        }
+        else
+        {
+            // Corners of a single face, loose vertices and non-manifold ones stay put
+            builder.Add(v, 1.0f);
+        }
+        builder.Flush(stencils);
+    }
+
+    // Face points
+    for (uint32_t face = 0; face < numFaces; face++)
+    {
+        builder.AddFace(faceBegin(face), faceSize(face), 1.0f);
+        builder.Flush(stencils);
+    }
+
+    // Edge points
+    for (const auto& edge : edges)
+    {
+        if (edge.NumFaces == 2)
+        {
+            builder.Add(edge.V0, 0.25f);
+            builder.Add(edge.V1, 0.25f);
+            for (uint32_t face : edge.Faces)
+                builder.AddFace(faceBegin(face), faceSize(face), 0.25f);
+        }
+        else
+        {
+            builder.Add(edge.V0, 0.5f);
+            builder.Add(edge.V1, 0.5f);
+        }
+        builder.Flush(stencils);
+    }
+
+    // Every corner becomes a quad of its vertex point, the edge points on both sides and the
+    //  face point, in the winding of the face
+    to = CPolygonTopology();
+    to.NumVerts = numVerts + numFaces + numEdges;
+    to.FaceVerts.reserve(from.FaceVerts.size() * 4);
+    to.FaceStarts.reserve(from.FaceVerts.size() + 1);
+    const uint32_t firstEdgePoint = numVerts + numFaces;
+    for (uint32_t face = 0; face < numFaces; face++)
+    {
+        uint32_t start = from.FaceStarts[face];
+        auto count = static_cast<uint32_t>(faceSize(face));
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t prev = start + (i + count - 1) % count;
+            uint32_t quad[4] = { from.FaceVerts[start + i],
+                                 firstEdgePoint + cornerEdges[start + i], numVerts + face,
+                                 firstEdgePoint + cornerEdges[prev] };
+            to.AddFace(quad, 4);
+        }
+    }
+}
+
+std::vector<tc::Vector3> CCatmullClark::Apply(const std::vector<tc::Vector3>& basePositions,
+                                              tc::FThreadPool& pool) const
+{
+    std::vector<CPoint4> current(Base.NumVerts);
+    for (size_t i = 0; i < current.size() && i < basePositions.size(); i++)
+        current[i] = { { basePositions[i].x, basePositions[i].y, basePositions[i].z, 0.0f } };
+
+    std::vector<CPoint4> next;
+    for (const auto& stencils : Levels)
+    {
+        next.resize(stencils.Starts.size() - 1);
+        pool.ParallelFor(next.size(), 4096, [&](size_t begin, size_t end) {
+            const CPoint4* in = current.data();
+            for (size_t i = begin; i < end; i++)
+            {
+                uint32_t first = stencils.Starts[i];
+                uint32_t last = stencils.Starts[i + 1];
+#ifdef URHO3D_SSE
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t j = first; j < last; j++)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(stencils.Weights[j]),
+                                                     _mm_load_ps(in[stencils.Sources[j]].V)));
+                _mm_store_ps(next[i].V, sum);
+#else
+                CPoint4 sum { { 0.0f, 0.0f, 0.0f, 0.0f } };
+                for (uint32_t j = first; j < last; j++)
+                    for (int k = 0; k < 3; k++)
+                        sum.V[k] += stencils.Weights[j] * in[stencils.Sources[j]].V[k];
+                next[i] = sum;
+#endif
+            }
+        });
+        std::swap(current, next);
+    }
+
+    std::vector<tc::Vector3> result;
+    result.reserve(current.size());
+    for (const auto& point : current)
+        result.emplace_back(point.V[0], point.V[1], point.V[2]);
+    return result;
+}
+
+}
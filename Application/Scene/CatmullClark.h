@@ -0,0 +1,72 @@
+#pragma once
+#include <ThreadPool.h>
+#include <Vector3.h>
+#include <cstdint>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+// Polygons as runs of vertex indices, face i is FaceVerts[FaceStarts[i]] up to FaceStarts[i + 1]
+struct CPolygonTopology
+{
+    uint32_t NumVerts = 0;
+    std::vector<uint32_t> FaceStarts { 0 };
+    std::vector<uint32_t> FaceVerts;
+
+    [[nodiscard]] size_t GetNumFaces() const { return FaceStarts.size() - 1; }
+    void AddFace(const uint32_t* verts, size_t count)
+    {
+        FaceVerts.insert(FaceVerts.end(), verts, verts + count);
+        FaceStarts.push_back(static_cast<uint32_t>(FaceVerts.size()));
+    }
+
+    bool operator==(const CPolygonTopology& rhs) const
+    {
+        return NumVerts == rhs.NumVerts && FaceStarts == rhs.FaceStarts
+            && FaceVerts == rhs.FaceVerts;
+    }
+};
+
+// Catmull-Clark subdivision split into a topology and a position step. Build works out once per
+//  topology which vertices of the level before every new vertex is a weighted sum of, and Apply
+//  only runs those sums, which is all that moving a point takes. Every level numbers its
+//  vertices as vertex points, then face points, then edge points, so the vertices of the base
+//  mesh keep their indices.
+class CCatmullClark
+{
+public:
+    void Build(const CPolygonTopology& base, int numLevels);
+    [[nodiscard]] bool IsBuiltFor(const CPolygonTopology& base, int numLevels) const
+    {
+        return bBuilt && numLevels == GetNumLevels() && base == Base;
+    }
+
+    [[nodiscard]] int GetNumLevels() const { return static_cast<int>(Levels.size()); }
+    // Quads only, unless there are no levels
+    [[nodiscard]] const CPolygonTopology& GetResultTopology() const { return Result; }
+
+    // One position per base vertex in, one per vertex of the result topology out
+    [[nodiscard]] std::vector<tc::Vector3> Apply(const std::vector<tc::Vector3>& basePositions,
+                                                 tc::FThreadPool& pool) const;
+
+private:
+    // New vertex i is the sum of Weights[j] * old vertex Sources[j] for j in Starts[i] up to
+    //  Starts[i + 1]
+    struct CStencilTable
+    {
+        std::vector<uint32_t> Starts { 0 };
+        std::vector<uint32_t> Sources;
+        std::vector<float> Weights;
+    };
+
+    static void Subdivide(const CPolygonTopology& from, CStencilTable& stencils,
+                          CPolygonTopology& to);
+
+    bool bBuilt = false;
+    CPolygonTopology Base;
+    std::vector<CStencilTable> Levels;
+    CPolygonTopology Result;
+};
+
+}
@@ -19,13 +19,13 @@ void CCircle::UpdateEntity()
     Super::UpdateEntity();
     int n = (int)Segments.GetValue(6.0f);
     float radius = Radius.GetValue(1.0f);
+    auto table = CTessellation::GetTrigTable(n, 0.0f, 2.f * (float)tc::M_PI / n);
 
     std::vector<CMeshImpl::VertexHandle> handles;
     for (int i = 0; i < n; i++)
     {
-        float theta = (float)i / n * 2.f * (float)tc::M_PI;
-        handles.push_back(AddVertex("v" + std::to_string(i),
-                                    { radius * cosf(theta), radius * sinf(theta), 0.0f }));
+        handles.push_back(AddVertex(CGridName("v", i),
+                                    { radius * table->Cos[i], radius * table->Sin[i], 0.0f }));
     }
     handles.push_back(handles[0]);
     AddLineStrip("circle", handles);
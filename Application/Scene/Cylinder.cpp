@@ -19,19 +19,25 @@ void CCylinder::UpdateEntity()
         return;
 
     Super::UpdateEntity();
+    GenerateMesh();
+}
 
+void CCylinder::GenerateMesh()
+{
     float radius = Radius.GetValue(1.0f);
     float height = Height.GetValue(1.0f);
     int maxTheta = (int)ThetaMax.GetValue(6.0f);
     int numSegs = (int)ThetaSegs.GetValue(6.0f);
+    float thetaRange = (float)maxTheta / 180.f * (float)tc::M_PI;
+    numSegs = GetLODSegments(numSegs, radius, thetaRange);
+    auto thetaTable = CTessellation::GetTrigTable(numSegs, 0.0f, thetaRange / numSegs);
 
     for (int j = 0; j < 2; j++) {
       for (int i = 0; i < numSegs; i++) {
-          float theta = (float)i / numSegs * ((float) maxTheta / 360.f) * 2.f * (float)tc::M_PI;
-          float x = radius * cosf(theta);
-          float y = radius * sinf(theta);
+          float x = radius * thetaTable->Cos[i];
+          float y = radius * thetaTable->Sin[i];
           float z = j * height;
-          AddVertex("v" + std::to_string(j) + "-" + std::to_string(i),
+          AddVertex(CGridName("v", j, "-", i),
                                     { x, y, z });
       }
     }
@@ -43,19 +49,19 @@ void CCylinder::UpdateEntity()
     for (int c = 0; c < numSegs; c++) {
       // CCW winding
       int next_c = (c + 1) % numSegs;
-      std::vector<std::string> face = {
+      std::vector<CGridName> face = {
           // CCW
-          "v" + std::to_string(1) + "-" + std::to_string(next_c),
-          "v" + std::to_string(1) + "-" + std::to_string(c),
-          "v" + std::to_string(0) + "-" + std::to_string(c),
-          "v" + std::to_string(0) + "-" + std::to_string(next_c),
+          CGridName("v", 1, "-", next_c),
+          CGridName("v", 1, "-", c),
+          CGridName("v", 0, "-", c),
+          CGridName("v", 0, "-", next_c),
       };
       if (c == numSegs - 1) {
         if (maxTheta == 360) {
-          AddFace("f-" + std::to_string(c), face);
+          AddFace(CGridName("f-", c), face);
         }
       } else {
-        AddFace("f-" + std::to_string(c), face);
+        AddFace(CGridName("f-", c), face);
       }
     }
 
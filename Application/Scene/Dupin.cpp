@@ -37,7 +37,7 @@ void CDupin::UpdateEntity()
         for (int j = 0; j < crossec; j++) {
             float theta1 = (float)i / crossec * u * (float)tc::M_PI;
             float theta2 = (float)j / crossec * v * (float)tc::M_PI;
-            AddVertex("v" + std::to_string(i) + "*" + std::to_string(j), {(d*(c - a * cosf(theta1)*cosf(theta2)) + b*b*cosf(theta1))/(a - c*cosf(theta1)*cosf(theta2)),(b*sinf(theta1)*(a-d*cosf(theta2)))/(a-c*cosf(theta1)*cosf(theta2)), (b*sinf(theta2)*(c*cosf(theta1)-d))/(a - c*cosf(theta1)*cosf(theta2))});
+            AddVertex(CGridName("v", i, "*", j), {(d*(c - a * cosf(theta1)*cosf(theta2)) + b*b*cosf(theta1))/(a - c*cosf(theta1)*cosf(theta2)),(b*sinf(theta1)*(a-d*cosf(theta2)))/(a-c*cosf(theta1)*cosf(theta2)), (b*sinf(theta2)*(c*cosf(theta1)-d))/(a - c*cosf(theta1)*cosf(theta2))});
         }
     }
     for (int i = 0; i < crossec; i++) {
@@ -46,27 +46,27 @@ void CDupin::UpdateEntity()
 
             } else if (j == crossec - 1) {
                 if (v == 2) {
-                    std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(0), "v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(0)};
-                    AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                    std::vector<std::string> face2 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(0)};
-                    AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);    
+                    std::vector<CGridName> face1 = {CGridName("v", i, "*", 0), CGridName("v", i, "*", j), CGridName("v", i + 1, "*", 0)};
+                    AddFace(CGridName("f1_", i, "-", j), face1);
+                    std::vector<CGridName> face2 = {CGridName("v", i, "*", j), CGridName("v", i + 1, "*", j), CGridName("v", i + 1, "*", 0)};
+                    AddFace(CGridName("f2_", i, "-", j), face2);    
                 } else {
                 }     
             } else if (i == crossec - 1) {
                 if (u == 2) {
-                    std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(0) + "*" + std::to_string(j), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                    AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                    std::vector<std::string> face2 = {"v" + std::to_string(0) + "*" + std::to_string(j), "v" + std::to_string(0) + "*" + std::to_string(j + 1), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                    AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);    
+                    std::vector<CGridName> face1 = {CGridName("v", i, "*", j), CGridName("v", 0, "*", j), CGridName("v", i, "*", j + 1)};
+                    AddFace(CGridName("f1_", i, "-", j), face1);
+                    std::vector<CGridName> face2 = {CGridName("v", 0, "*", j), CGridName("v", 0, "*", j + 1), CGridName("v", i, "*", j + 1)};
+                    AddFace(CGridName("f2_", i, "-", j), face2);    
                 } else {
 
                 }
             }
             else {
-                std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                std::vector<std::string> face2 = {"v" + std::to_string(i) + "*" + std::to_string(j + 1), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j + 1)};
-                AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);      
+                std::vector<CGridName> face1 = {CGridName("v", i, "*", j), CGridName("v", i + 1, "*", j), CGridName("v", i, "*", j + 1)};
+                AddFace(CGridName("f1_", i, "-", j), face1);
+                std::vector<CGridName> face2 = {CGridName("v", i, "*", j + 1), CGridName("v", i + 1, "*", j), CGridName("v", i + 1, "*", j + 1)};
+                AddFace(CGridName("f2_", i, "-", j), face2);      
             }
         }
     }
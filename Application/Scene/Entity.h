@@ -4,6 +4,7 @@
 #include "RendererInterface.h"
 #include <Matrix3x4.h> //For convenience
 #include <Parsing/ASTContext.h>
+#include <SignalSlot.h>
 #include <string>
 
 /*
@@ -92,7 +93,13 @@ public:
 
     // The entity itself can also be considered an output, the following 2 functions handle the
     // update thereof
-    virtual void MarkDirty() { bEntityDirty = true; }
+    virtual void MarkDirty()
+    {
+        if (bEntityDirty)
+            return;
+        bEntityDirty = true;
+        OnMarkedDirty();
+    }
     // Update the entity, doesn't do anything if not dirty
     virtual void UpdateEntity()
     {
@@ -115,8 +122,14 @@ public:
     virtual bool IsInstantiable() { return false; }
     virtual CEntity* Instantiate(CSceneTreeNode* treeNode) { return nullptr; }
 
+    // Entities read by UpdateEntity without going through a Flow input, used for scheduling
+    virtual void GetHiddenDependencies(std::vector<CEntity*>& deps) const {}
+
     virtual AST::ACommand* SyncToAST(AST::CASTContext& ctx, bool createNewNode);
 
+    // Fired when the entity goes from clean to dirty, the scene uses this to queue tree nodes
+    tc::FSignal<void()> OnMarkedDirty;
+
 private:
     std::string Name;
     bool bIsValid = false;
@@ -0,0 +1,146 @@
+#include "EntityUpdateGraph.h"
+#include <algorithm>
+
+namespace Nome::Scene
+{
+
+static bool HasDirtyOutput(const Flow::CFlowNode* node)
+{
+    for (const Flow::IOutputSlot* output : node->GetOutputSlots())
+        if (output->IsDirty())
+            return true;
+    return false;
+}
+
+bool CEntityUpdateGraph::NeedsUpdate(CEntity* entity)
+{
+    // An entity can be clean while still having dirty outputs, e.g. after
+    //  CMeshInstance::MarkOnlyDownstreamDirty, and readers would race to refresh those
+    return entity->IsDirty() || HasDirtyOutput(entity);
+}
+
+void CEntityUpdateGraph::AddEntity(CEntity* entity)
+{
+    if (NeedsUpdate(entity))
+        AddTask(entity);
+}
+
+size_t CEntityUpdateGraph::AddTask(Flow::CFlowNode* node)
+{
+    auto iter = TaskIndex.find(node);
+    if (iter != TaskIndex.end())
+        return iter->second;
+
+    size_t index = Tasks.size();
+    Tasks.emplace_back(new FTask);
+    Tasks[index]->Node = node;
+    Tasks[index]->Entity = dynamic_cast<CEntity*>(node);
+    TaskIndex.emplace(node, index);
+
+    std::vector<Flow::CFlowNode*> dependencies = CollectUpstream(node);
+    if (CEntity* entity = Tasks[index]->Entity)
+    {
+        std::vector<CEntity*> hidden;
+        entity->GetHiddenDependencies(hidden);
+        for (CEntity* dependency : hidden)
+            if (NeedsUpdate(dependency))
+                dependencies.push_back(dependency);
+    }
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    for (Flow::CFlowNode* dependency : dependencies)
+    {
+        if (dependency == node)
+            continue;
+        size_t depIndex = AddTask(dependency);
+        if (Tasks[depIndex]->bVisiting)
+        {
+            // Ignore the edge, neither end can be trusted to read up to date values
+            Tasks[index]->bInCycle = true;
+            Tasks[depIndex]->bInCycle = true;
+            continue;
+        }
+        Tasks[depIndex]->Successors.push_back(index);
+        Tasks[index]->NumDependencies++;
+    }
+    Tasks[index]->bVisiting = false;
+    return index;
+}
+
+const std::vector<Flow::CFlowNode*>& CEntityUpdateGraph::CollectUpstream(Flow::CFlowNode* node)
+{
+    auto iter = UpstreamTasks.find(node);
+    if (iter != UpstreamTasks.end())
+        return iter->second;
+    // Insert first so that a cycle terminates instead of recursing forever
+    std::vector<Flow::CFlowNode*>& result = UpstreamTasks[node];
+
+    std::vector<Flow::CFlowNode*> found;
+    for (const Flow::IInputSlot* input : node->GetInputSlots())
+    {
+        Flow::CFlowNode* upstream = input->GetUpstreamNode();
+        if (!upstream)
+            continue;
+        if (auto* entity = dynamic_cast<CEntity*>(upstream))
+        {
+            // Entities are tasks of their own, they walk further upstream themselves
+            if (NeedsUpdate(entity))
+                found.push_back(entity);
+            continue;
+        }
+        if (!HasDirtyOutput(upstream))
+            continue;
+
+        bool bFirstVisit = UpstreamTasks.find(upstream) == UpstreamTasks.end();
+        if (!CollectUpstream(upstream).empty())
+            // Updating it pulls an entity, so it has to wait for that entity's task
+            found.push_back(upstream);
+        else if (bFirstVisit)
+            SharedNodes.push_back(upstream);
+    }
+    result = std::move(found);
+    return result;
+}
+
+void CEntityUpdateGraph::Run(tc::FThreadPool& pool)
+{
+    // These only depend on other values in the nom file, so computing them up front on this thread
+    //  never regenerates a mesh
+    for (Flow::CFlowNode* node : SharedNodes)
+        for (const Flow::IOutputSlot* output : node->GetOutputSlots())
+            output->Update();
+
+    if (Tasks.size() == 1)
+    {
+        RunTask(pool, 0);
+        return;
+    }
+
+    for (auto& task : Tasks)
+        task->RemainingDependencies = task->NumDependencies;
+    for (size_t i = 0; i < Tasks.size(); i++)
+        if (Tasks[i]->NumDependencies == 0)
+            pool.Submit([this, &pool, i]() { RunTask(pool, i); });
+    pool.WaitIdle();
+}
+
+void CEntityUpdateGraph::RunTask(tc::FThreadPool& pool, size_t index)
+{
+    FTask& task = *Tasks[index];
+    if (task.Entity)
+    {
+        task.Entity->UpdateEntity();
+        // Same as any other entity that could not be generated properly
+        if (task.bInCycle)
+            task.Entity->SetValid(false);
+    }
+    // Bring the outputs up to date too, so downstream tasks only ever read them
+    for (const Flow::IOutputSlot* output : task.Node->GetOutputSlots())
+        output->Update();
+
+    for (size_t successor : task.Successors)
+        if (Tasks[successor]->RemainingDependencies.fetch_sub(1) == 1)
+            pool.Submit([this, &pool, successor]() { RunTask(pool, successor); });
+}
+
+}
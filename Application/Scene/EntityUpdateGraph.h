@@ -0,0 +1,57 @@
+#pragma once
+#include "Entity.h"
+#include <ThreadPool.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+// Regenerates a batch of dirty entities on a thread pool. Dependencies are found by walking the
+//  Flow connections upstream: a dirty entity feeding another one is updated first, entities with
+//  no path between them run concurrently. Non-entity nodes that read a dirty entity, such as
+//  vertex selectors pulling their instance, become tasks of their own between the two.
+class CEntityUpdateGraph
+{
+public:
+    // Adds a dirty entity and, transitively, every dirty entity it reads from
+    void AddEntity(CEntity* entity);
+
+    // Updates everything added so far and returns once all of it is done
+    void Run(tc::FThreadPool& pool);
+
+    size_t GetTaskCount() const { return Tasks.size(); }
+
+private:
+    struct FTask
+    {
+        Flow::CFlowNode* Node = nullptr;
+        // Null for a shared node, which only has its outputs brought up to date
+        TAutoPtr<CEntity> Entity;
+        std::vector<size_t> Successors;
+        size_t NumDependencies = 0;
+        std::atomic<size_t> RemainingDependencies { 0 };
+        bool bVisiting = true;
+        // An edge of a dependency cycle was dropped here, the entity is marked invalid once updated
+        bool bInCycle = false;
+    };
+
+    static bool NeedsUpdate(CEntity* entity);
+    size_t AddTask(Flow::CFlowNode* node);
+    const std::vector<Flow::CFlowNode*>& CollectUpstream(Flow::CFlowNode* node);
+    void RunTask(tc::FThreadPool& pool, size_t index);
+
+    std::vector<std::unique_ptr<FTask>> Tasks;
+    std::unordered_map<Flow::CFlowNode*, size_t> TaskIndex;
+
+    // Dirty non-entity nodes with no dirty entity upstream (expressions, sliders), updated
+    //  serially before the parallel part so that no two tasks race to recompute a shared output
+    std::vector<Flow::CFlowNode*> SharedNodes;
+    // Memoized tasks each visited node has to wait for: dirty entities and the shared nodes that
+    //  read one
+    std::unordered_map<Flow::CFlowNode*, std::vector<Flow::CFlowNode*>> UpstreamTasks;
+};
+
+}
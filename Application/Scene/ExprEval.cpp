@@ -1,4 +1,5 @@
 #include "ExprEval.h"
+#include <cassert>
 
 namespace Nome::Scene
 {
@@ -66,4 +67,129 @@ std::any CExprEvalDirect::VisitWrappedExpr(AST::AWrappedExpr* expr)
     return expr->GetExpr()->Accept(this);
 }
 
+namespace
+{
+
+float Apply(CExprProgram::EOp op, float lhs, float rhs)
+{
+    switch (op)
+    {
+    case CExprProgram::EOp::Neg:
+        return -rhs;
+    case CExprProgram::EOp::Add:
+        return lhs + rhs;
+    case CExprProgram::EOp::Sub:
+        return lhs - rhs;
+    case CExprProgram::EOp::Mul:
+        return lhs * rhs;
+    case CExprProgram::EOp::Div:
+        return lhs / rhs;
+    case CExprProgram::EOp::Pow:
+        return std::pow(lhs, rhs);
+    case CExprProgram::EOp::Sin:
+        return std::sin(rhs);
+    case CExprProgram::EOp::Cos:
+        return std::cos(rhs);
+    default:
+        return 0.0f;
+    }
+}
+
+bool IsUnary(CExprProgram::EOp op)
+{
+    return op == CExprProgram::EOp::Neg || op == CExprProgram::EOp::Sin
+        || op == CExprProgram::EOp::Cos;
+}
+
+}
+
+void CExprProgram::PushConst(float value)
+{
+    CInstr instr { EOp::Const };
+    instr.Value = value;
+    Code.push_back(instr);
+    MaxDepth = std::max(MaxDepth, ++Depth);
+}
+
+void CExprProgram::PushVar(uint32_t slot)
+{
+    CInstr instr { EOp::Var };
+    instr.Slot = slot;
+    Code.push_back(instr);
+    MaxDepth = std::max(MaxDepth, ++Depth);
+}
+
+void CExprProgram::PushOp(EOp op)
+{
+    assert(op != EOp::Const && op != EOp::Var);
+    size_t numOperands = IsUnary(op) ? 1 : 2;
+    assert(Depth >= numOperands);
+    bool bFoldable = Code.size() >= numOperands;
+    for (size_t i = 0; bFoldable && i < numOperands; i++)
+        bFoldable = Code[Code.size() - 1 - i].Op == EOp::Const;
+    if (bFoldable)
+    {
+        float rhs = Code.back().Value;
+        float lhs = numOperands == 2 ? Code[Code.size() - 2].Value : 0.0f;
+        Code.resize(Code.size() - numOperands);
+        Depth -= numOperands;
+        PushConst(Apply(op, lhs, rhs));
+        return;
+    }
+    CInstr instr { op };
+    instr.Slot = 0;
+    Code.push_back(instr);
+    Depth -= numOperands - 1;
+}
+
+float CExprProgram::Run(const float* vars, float* stack) const
+{
+    float* top = stack - 1;
+    for (const CInstr& instr : Code)
+    {
+        switch (instr.Op)
+        {
+        case EOp::Const:
+            *++top = instr.Value;
+            break;
+        case EOp::Var:
+            *++top = vars[instr.Slot];
+            break;
+        case EOp::Neg:
+        case EOp::Sin:
+        case EOp::Cos:
+            *top = Apply(instr.Op, 0.0f, *top);
+            break;
+        default:
+            top--;
+            *top = Apply(instr.Op, top[0], top[1]);
+            break;
+        }
+    }
+    return Code.empty() ? 0.0f : *top;
+}
+
+CExprNode::CExprNode(CExprProgram program, const std::vector<Flow::CFloatNumber*>& sources)
+    : Program(std::move(program))
+    , Values(sources.size())
+    , Stack(Program.GetStackDepth())
+{
+    for (auto* source : sources)
+    {
+        Variables.Connect(source->Value);
+        if (auto* slider = dynamic_cast<CSlider*>(source))
+        {
+            slider->AddDependent(this);
+            Sliders.push_back(slider);
+        }
+    }
+}
+
+CExprNode::~CExprNode()
+{
+    // The inputs hold references to the sliders, so they are still around
+    for (auto* slider : Sliders)
+        slider->RemoveDependent(this);
+}
+
 }
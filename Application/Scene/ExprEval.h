@@ -1,6 +1,10 @@
 #pragma once
+#include "BankAndSet.h"
+#include <Flow/FlowNodeArray.h>
 #include <Parsing/SyntaxTree.h>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 namespace Nome::Scene
 {
@@ -17,4 +21,76 @@ public:
     std::any VisitWrappedExpr(AST::AWrappedExpr* expr) override;
 };
 
+// An expression compiled to a flat stack machine program. Variables are read by slot index from
+//  an array the caller fills in, so running it neither allocates nor follows pointers.
+class CExprProgram
+{
+public:
+    enum class EOp : uint8_t
+    {
+        Const,
+        Var,
+        Neg,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Pow,
+        Sin,
+        Cos
+    };
+
+    // Emitted in postfix order. Operators on constants are folded right away.
+    void PushConst(float value);
+    void PushVar(uint32_t slot);
+    void PushOp(EOp op);
+
+    // stack must hold GetStackDepth() floats
+    [[nodiscard]] float Run(const float* vars, float* stack) const;
+
+    [[nodiscard]] size_t GetStackDepth() const { return MaxDepth; }
+    [[nodiscard]] size_t GetNumInstructions() const { return Code.size(); }
+    [[nodiscard]] bool IsConstant() const { return Code.size() == 1 && Code[0].Op == EOp::Const; }
+
+private:
+    struct CInstr
+    {
+        EOp Op;
+        union
+        {
+            float Value;
+            uint32_t Slot;
+        };
+    };
+
+    std::vector<CInstr> Code;
+    size_t Depth = 0;
+    size_t MaxDepth = 0;
+};
+
+// Evaluates one compiled expression as a single flow node, in place of a node per operator
+class CExprNode : public Flow::CFlowNode
+{
+    DEFINE_INPUT_ARRAY(float, Variables) { Result.MarkDirty(); }
+
+    DEFINE_OUTPUT_WITH_UPDATE(float, Result)
+    {
+        for (size_t i = 0; i < Values.size(); i++)
+            Values[i] = Variables.GetValue(i, 0.0f);
+        Result.UpdateValue(Program.Run(Values.data(), Stack.data()));
+    }
+
+public:
+    // sources[i] feeds variable slot i of the program
+    CExprNode(CExprProgram program, const std::vector<Flow::CFloatNumber*>& sources);
+    ~CExprNode() override;
+
+private:
+    CExprProgram Program;
+    // Scratch space sized once, so that re-evaluating does not allocate
+    std::vector<float> Values;
+    std::vector<float> Stack;
+    std::vector<CSlider*> Sliders;
+};
+
 }
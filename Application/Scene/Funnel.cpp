@@ -30,12 +30,12 @@ void CFunnel::UpdateEntity()
     for (int i = 0; i < n; i++)
     {
         float theta = (float)i / n * 2.f * (float)tc::M_PI;
-        AddVertex("v2_" + std::to_string(i), { radius * cosf(theta), radius * sinf(theta), 0.f });
+        AddVertex(CGridName("v2_", i), { radius * cosf(theta), radius * sinf(theta), 0.f });
     }
     for (int i = 0; i < n; i++)
     {
         float theta = (float)i / n * 2.f * (float)tc::M_PI;
-        AddVertex("v1_" + std::to_string(i), { ri * cosf(theta), ri * sinf(theta), height });
+        AddVertex(CGridName("v1_", i), { ri * cosf(theta), ri * sinf(theta), height });
     }
 
     // Create faces
@@ -45,10 +45,9 @@ void CFunnel::UpdateEntity()
         // v1_next v1_i
         // v2_next v2_i
         int next = (i + 1) % n;
-        std::vector<std::string> upperFace = { "v1_" + std::to_string(next),
-                                               "v1_" + std::to_string(i), "v2_" + std::to_string(i),
-                                               "v2_" + std::to_string(next) };
-        AddFace("f1_" + std::to_string(i), upperFace);
+        std::vector<CGridName> upperFace = { CGridName("v1_", next), CGridName("v1_", i),
+                                             CGridName("v2_", i), CGridName("v2_", next) };
+        AddFace(CGridName("f1_", i), upperFace);
     }
     // Two caps
     // std::vector<std::string> upperCap, lowerCap;
@@ -0,0 +1,218 @@
+#include "GridNames.h"
+#include <Parsing/BinaryStream.h>
+#include <algorithm>
+
+namespace Nome::Scene
+{
+
+// Parses an integer exactly as std::to_string would have printed it, so that "v01" is not "v1"
+static bool ParseCanonicalInt(const std::string& str, size_t& pos, int& result)
+{
+    bool bNegative = pos < str.size() && str[pos] == '-';
+    size_t begin = bNegative ? pos + 1 : pos;
+    size_t end = begin;
+    while (end < str.size() && end - begin < 10 && str[end] >= '0' && str[end] <= '9')
+        end++;
+    if (end == begin || end - begin > 9 || (str[begin] == '0' && end - begin > 1)
+        || (bNegative && str[begin] == '0'))
+        return false;
+
+    int value = 0;
+    for (size_t i = begin; i < end; i++)
+        value = value * 10 + (str[i] - '0');
+    result = bNegative ? -value : value;
+    pos = end;
+    return true;
+}
+
+std::string CGridName::ToString() const
+{
+    std::string result = Prefix + std::to_string(Row);
+    if (Separator)
+        result += Separator + std::to_string(Col);
+    return result;
+}
+
+void CGridNameTable::Add(const CGridName& name, int index)
+{
+    Size++;
+    if (!Blocks.empty())
+    {
+        CBlock& block = Blocks.back();
+        if (index == block.FirstIndex + block.Count && SameScheme(block, name))
+        {
+            // The second element tells whether the generator loops over columns or rows inside
+            if (block.Count == 1 && name.Row == block.RowBegin && name.Col == block.ColBegin + 1)
+            {
+                block.bColumnMajor = false;
+                block.InnerSize = block.Count = 2;
+                return;
+            }
+            if (block.Count == 1 && name.Row == block.RowBegin + 1 && name.Col == block.ColBegin)
+            {
+                block.bColumnMajor = true;
+                block.InnerSize = block.Count = 2;
+                return;
+            }
+            if (block.Count > 1)
+            {
+                // The first run may keep growing until the second one starts
+                int row, col;
+                GetPosition(block, block.InnerSize - 1, row, col);
+                bool bExtendsRun = block.bColumnMajor ? name.Row == row + 1 && name.Col == col
+                                                      : name.Row == row && name.Col == col + 1;
+                if (block.Count == block.InnerSize && bExtendsRun)
+                {
+                    block.InnerSize++;
+                    block.Count++;
+                    return;
+                }
+                GetPosition(block, block.Count, row, col);
+                if (name.Row == row && name.Col == col)
+                {
+                    block.Count++;
+                    return;
+                }
+            }
+        }
+    }
+
+    CBlock block;
+    block.Prefix = name.Prefix;
+    block.Separator = name.Separator ? name.Separator : "";
+    block.bHasColumn = name.Separator != nullptr;
+    block.RowBegin = name.Row;
+    block.ColBegin = name.Col;
+    block.FirstIndex = index;
+    Blocks.push_back(std::move(block));
+}
+
+int CGridNameTable::Find(const CGridName& name) const
+{
+    for (const auto& block : Blocks)
+    {
+        if (!SameScheme(block, name))
+            continue;
+        int index = IndexInBlock(block, name.Row, name.Col);
+        if (index >= 0)
+            return index;
+    }
+    return -1;
+}
+
+int CGridNameTable::Find(const std::string& name) const
+{
+    for (const auto& block : Blocks)
+    {
+        if (name.compare(0, block.Prefix.size(), block.Prefix) != 0)
+            continue;
+        size_t pos = block.Prefix.size();
+        int row;
+        int col = 0;
+        if (!ParseCanonicalInt(name, pos, row))
+            continue;
+        if (block.bHasColumn)
+        {
+            if (name.compare(pos, block.Separator.size(), block.Separator) != 0)
+                continue;
+            pos += block.Separator.size();
+            if (!ParseCanonicalInt(name, pos, col))
+                continue;
+        }
+        if (pos != name.size())
+            continue;
+        int index = IndexInBlock(block, row, col);
+        if (index >= 0)
+            return index;
+    }
+    return -1;
+}
+
+std::string CGridNameTable::GetName(int index) const
+{
+    // Blocks are appended in index order
+    auto iter = std::upper_bound(Blocks.begin(), Blocks.end(), index,
+                                 [](int i, const CBlock& block) { return i < block.FirstIndex; });
+    if (iter == Blocks.begin())
+        return {};
+    const CBlock& block = *(iter - 1);
+    int offset = index - block.FirstIndex;
+    if (offset >= block.Count)
+        return {};
+
+    int row, col;
+    GetPosition(block, offset, row, col);
+    std::string result = block.Prefix + std::to_string(row);
+    if (block.bHasColumn)
+        result += block.Separator + std::to_string(col);
+    return result;
+}
+
+bool CGridNameTable::SameScheme(const CBlock& block, const CGridName& name)
+{
+    if (block.bHasColumn != (name.Separator != nullptr))
+        return false;
+    if (block.Prefix != name.Prefix)
+        return false;
+    return !name.Separator || block.Separator == name.Separator;
+}
+
+void CGridNameTable::GetPosition(const CBlock& block, int offset, int& row, int& col)
+{
+    int outer = offset / block.InnerSize;
+    int inner = offset % block.InnerSize;
+    row = block.RowBegin + (block.bColumnMajor ? inner : outer);
+    col = block.ColBegin + (block.bColumnMajor ? outer : inner);
+}
+
+int CGridNameTable::IndexInBlock(const CBlock& block, int row, int col)
+{
+    int outer = block.bColumnMajor ? col - block.ColBegin : row - block.RowBegin;
+    int inner = block.bColumnMajor ? row - block.RowBegin : col - block.ColBegin;
+    if (outer < 0 || inner < 0 || inner >= block.InnerSize)
+        return -1;
+    int offset = outer * block.InnerSize + inner;
+    return offset < block.Count ? block.FirstIndex + offset : -1;
+}
+
+void CGridNameTable::Write(CBinaryWriter& out) const
+{
+    out.Write(static_cast<uint32_t>(Blocks.size()));
+    for (const auto& block : Blocks)
+    {
+        out.WriteString(block.Prefix);
+        out.WriteString(block.Separator);
+        out.Write(block.bHasColumn);
+        out.Write(block.bColumnMajor);
+        out.Write(block.RowBegin);
+        out.Write(block.ColBegin);
+        out.Write(block.InnerSize);
+        out.Write(block.Count);
+        out.Write(block.FirstIndex);
+    }
+}
+
+void CGridNameTable::Read(CBinaryReader& in)
+{
+    Clear();
+    auto numBlocks = in.Read<uint32_t>();
+    for (uint32_t i = 0; i < numBlocks; i++)
+    {
+        CBlock block;
+        block.Prefix = in.ReadString();
+        block.Separator = in.ReadString();
+        block.bHasColumn = in.Read<bool>();
+        block.bColumnMajor = in.Read<bool>();
+        block.RowBegin = in.Read<int>();
+        block.ColBegin = in.Read<int>();
+        block.InnerSize = in.Read<int>();
+        block.Count = in.Read<int>();
+        block.FirstIndex = in.Read<int>();
+        if (block.Count < 1 || block.InnerSize < 1)
+            throw std::runtime_error("Damaged name table");
+        Size += block.Count;
+        Blocks.push_back(std::move(block));
+    }
+}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Nome
+{
+class CBinaryReader;
+class CBinaryWriter;
+}
+
+namespace Nome::Scene
+{
+
+// A generated element name such as "v3_7" (prefix "v", row 3, separator "_", column 7) or "v12",
+//  kept as integers until somebody actually needs the string
+struct CGridName
+{
+    CGridName(const char* prefix, int row)
+        : Prefix(prefix)
+        , Row(row)
+    {
+    }
+
+    CGridName(const char* prefix, int row, const char* separator, int col)
+        : Prefix(prefix)
+        , Separator(separator)
+        , Row(row)
+        , Col(col)
+    {
+    }
+
+    std::string ToString() const;
+
+    const char* Prefix;
+    // Null for names with a single running index
+    const char* Separator = nullptr;
+    int Row;
+    int Col = 0;
+};
+
+// Names of the elements a generator emitted, stored as rectangular blocks of grid names instead of
+//  one string per element. Elements added row by row (or column by column) with consecutive
+//  indices extend the current block, so a whole torus ends up as a single block. Lookups parse
+//  the name and index into the block arithmetically.
+class CGridNameTable
+{
+public:
+    void Add(const CGridName& name, int index);
+
+    // Both return -1 if no element has the name; the first block wins for duplicated names
+    int Find(const CGridName& name) const;
+    int Find(const std::string& name) const;
+
+    // Empty if the element was not named through this table
+    std::string GetName(int index) const;
+
+    size_t GetSize() const { return Size; }
+
+    template <typename TFunc> void ForEachIndex(TFunc&& func) const
+    {
+        for (const auto& block : Blocks)
+            for (int i = 0; i < block.Count; i++)
+                func(block.FirstIndex + i);
+    }
+
+    void Clear()
+    {
+        Blocks.clear();
+        Size = 0;
+    }
+
+    // For the scene cache
+    void Write(CBinaryWriter& out) const;
+    void Read(CBinaryReader& in);
+
+private:
+    struct CBlock
+    {
+        std::string Prefix;
+        std::string Separator;
+        bool bHasColumn;
+        // Whether the row index runs fastest, names without a column always count this way
+        bool bColumnMajor = false;
+        int RowBegin;
+        int ColBegin;
+        // Length of a full row (or column, when column-major)
+        int InnerSize = 1;
+        int Count = 1;
+        int FirstIndex;
+    };
+
+    static bool SameScheme(const CBlock& block, const CGridName& name);
+    static void GetPosition(const CBlock& block, int offset, int& row, int& col);
+    // Index of the element at (row, col) in the block, or -1
+    static int IndexInBlock(const CBlock& block, int row, int col);
+
+    std::vector<CBlock> Blocks;
+    size_t Size = 0;
+};
+
+}
@@ -24,12 +24,15 @@ void CHelix::UpdateEntity()
     float c = VerticalSpacing.GetValue(1.0f);
     float max_theta = MaxTheta.GetValue(1.0f);
 
+    float step = max_theta / 180.f * (float)tc::M_PI / n;
+    auto table = CTessellation::GetTrigTable(n, 0.0f, step);
+
     std::vector<CMeshImpl::VertexHandle> handles;
     for (int i = 0; i < n; i++)
     {
-        float theta = (float)i / n * (max_theta / 360.f) * 2.f * (float)tc::M_PI;
-        handles.push_back(AddVertex("v" + std::to_string(i),
-                                    { radius * cosf(theta), radius * sinf(theta), c * theta }));
+        float theta = (float)i * step;
+        handles.push_back(AddVertex(CGridName("v", i),
+                                    { radius * table->Cos[i], radius * table->Sin[i], c * theta }));
     }
     AddLineStrip("helix", handles);
 }
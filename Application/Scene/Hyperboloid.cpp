@@ -36,25 +36,25 @@ void CHyperboloid::UpdateEntity()
             for (int i = 0; i < n; i++)
             {
                 float theta = (float)i / n * angle * (float)tc::M_PI;
-                AddVertex("v" + std::to_string(i) + "*" + std::to_string(j), {a * (float)sqrt(j*j + 1) * cosf(theta), b * (float)sqrt(j*j + 1) * sinf(theta), (float)j});
+                AddVertex(CGridName("v", i, "*", j), {a * (float)sqrt(j*j + 1) * cosf(theta), b * (float)sqrt(j*j + 1) * sinf(theta), (float)j});
             }
         }
 
         for (int j = -crosssec; j < crosssec; j++) {
             for (int i = 0; i < n; i++) {
                 if (i == n - 1 && angle == 2) {
-                    std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(0) + "*" + std::to_string(j), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                    AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                    std::vector<std::string> face2 = {"v" + std::to_string(i) + "*" + std::to_string(j + 1), "v" + std::to_string(0) + "*" + std::to_string(j), "v" + std::to_string(0) + "*" + std::to_string(j + 1)};
-                    AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);                     
+                    std::vector<CGridName> face1 = {CGridName("v", i, "*", j), CGridName("v", 0, "*", j), CGridName("v", i, "*", j + 1)};
+                    AddFace(CGridName("f1_", i, "-", j), face1);
+                    std::vector<CGridName> face2 = {CGridName("v", i, "*", j + 1), CGridName("v", 0, "*", j), CGridName("v", 0, "*", j + 1)};
+                    AddFace(CGridName("f2_", i, "-", j), face2);                     
 
                 } else if (i == n - 1 && angle != 2) {
 
                 } else {
-                    std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                    AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                    std::vector<std::string> face2 = {"v" + std::to_string(i) + "*" + std::to_string(j + 1), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j + 1)};
-                    AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);      
+                    std::vector<CGridName> face1 = {CGridName("v", i, "*", j), CGridName("v", i + 1, "*", j), CGridName("v", i, "*", j + 1)};
+                    AddFace(CGridName("f1_", i, "-", j), face1);
+                    std::vector<CGridName> face2 = {CGridName("v", i, "*", j + 1), CGridName("v", i + 1, "*", j), CGridName("v", i + 1, "*", j + 1)};
+                    AddFace(CGridName("f2_", i, "-", j), face2);      
                 }   
             }
         }
@@ -63,24 +63,24 @@ void CHyperboloid::UpdateEntity()
             for (int i = 0; i < n; i++)
             {
                 float theta = (float)i / n * angle * (float)tc::M_PI;
-                AddVertex("v" + std::to_string(i) + "*" + std::to_string(j), {a * (float)sqrt(j*j - 1) * cosf(theta), b * (float)sqrt(j*j - 1) * sinf(theta), (float)j});
+                AddVertex(CGridName("v", i, "*", j), {a * (float)sqrt(j*j - 1) * cosf(theta), b * (float)sqrt(j*j - 1) * sinf(theta), (float)j});
             }
         }
         for (int j = -crosssec; j < crosssec; j++) {
             for (int i = 0; i < n; i++) {
                 if (i == n - 1 && angle == 2) {
-                    std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(0) + "*" + std::to_string(j), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                    AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                    std::vector<std::string> face2 = {"v" + std::to_string(i) + "*" + std::to_string(j + 1), "v" + std::to_string(0) + "*" + std::to_string(j), "v" + std::to_string(0) + "*" + std::to_string(j + 1)};
-                    AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);                     
+                    std::vector<CGridName> face1 = {CGridName("v", i, "*", j), CGridName("v", 0, "*", j), CGridName("v", i, "*", j + 1)};
+                    AddFace(CGridName("f1_", i, "-", j), face1);
+                    std::vector<CGridName> face2 = {CGridName("v", i, "*", j + 1), CGridName("v", 0, "*", j), CGridName("v", 0, "*", j + 1)};
+                    AddFace(CGridName("f2_", i, "-", j), face2);                     
 
                 } else if (i == n - 1 && angle != 2) {
 
                 } else {
-                    std::vector<std::string> face1 = {"v" + std::to_string(i) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i) + "*" + std::to_string(j + 1)};
-                    AddFace("f1_" + std::to_string(i) + "-" + std::to_string(j), face1);
-                    std::vector<std::string> face2 = {"v" + std::to_string(i) + "*" + std::to_string(j + 1), "v" + std::to_string(i + 1) + "*" + std::to_string(j), "v" + std::to_string(i + 1) + "*" + std::to_string(j + 1)};
-                    AddFace("f2_" + std::to_string(i) + "-" + std::to_string(j), face2);      
+                    std::vector<CGridName> face1 = {CGridName("v", i, "*", j), CGridName("v", i + 1, "*", j), CGridName("v", i, "*", j + 1)};
+                    AddFace(CGridName("f1_", i, "-", j), face1);
+                    std::vector<CGridName> face2 = {CGridName("v", i, "*", j + 1), CGridName("v", i + 1, "*", j), CGridName("v", i + 1, "*", j + 1)};
+                    AddFace(CGridName("f2_", i, "-", j), face2);      
                 }   
             }
         }
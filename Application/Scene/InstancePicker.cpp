@@ -0,0 +1,81 @@
+#include "InstancePicker.h"
+#include "Mesh.h"
+#include "Scene.h"
+
+namespace Nome::Scene
+{
+
+void CInstancePicker::Rebuild(const CScene& scene)
+{
+    Clear();
+    scene.ForEachSceneTreeNode([this](CSceneTreeNode* node) {
+        auto* instance = dynamic_cast<CMeshInstance*>(node->GetEntity());
+        if (!instance)
+            return;
+        LeafForTreeNode.emplace(node, static_cast<uint32_t>(Leaves.size()));
+        Leaves.push_back({ node, instance, tc::Matrix3x4::IDENTITY, tc::BoundingBox() });
+    });
+    // Mesh BVHs are only built once something is picked
+    bNeedsBuild = true;
+}
+
+void CInstancePicker::MarkDirty(CSceneTreeNode* treeNode)
+{
+    auto iter = LeafForTreeNode.find(treeNode);
+    if (iter != LeafForTreeNode.end())
+        DirtyLeaves.push_back(iter->second);
+}
+
+void CInstancePicker::Clear()
+{
+    Leaves.clear();
+    LeafForTreeNode.clear();
+    DirtyLeaves.clear();
+    bNeedsBuild = false;
+    BVH.Clear();
+}
+
+void CInstancePicker::Pick(const tc::Ray& worldRay,
+                           const std::function<void(CMeshInstance*, const tc::Ray&)>& func)
+{
+    if (bNeedsBuild)
+    {
+        std::vector<tc::BoundingBox> boxes;
+        boxes.reserve(Leaves.size());
+        for (uint32_t i = 0; i < Leaves.size(); i++)
+        {
+            UpdateLeaf(i);
+            boxes.push_back(Leaves[i].WorldBox);
+        }
+        BVH.Build(std::move(boxes));
+        bNeedsBuild = false;
+    }
+    else
+    {
+        for (uint32_t leaf : DirtyLeaves)
+        {
+            UpdateLeaf(leaf);
+            if (BVH.GetItemBox(leaf) != Leaves[leaf].WorldBox)
+                BVH.Refit(leaf, Leaves[leaf].WorldBox);
+        }
+    }
+    DirtyLeaves.clear();
+
+    BVH.QueryRay(worldRay, [&](uint32_t leaf) {
+        auto localRay = worldRay.Transformed(Leaves[leaf].W2L);
+        // Normalize to fix "scale" error caused by the inverse transform
+        localRay.Direction = localRay.Direction.Normalized();
+        func(Leaves[leaf].Instance, localRay);
+    });
+}
+
+void CInstancePicker::UpdateLeaf(uint32_t leaf)
+{
+    auto& entry = Leaves[leaf];
+    const auto& l2w = entry.TreeNode->L2WTransform.GetValue(tc::Matrix3x4::IDENTITY);
+    entry.W2L = l2w.Inverse();
+    auto localBox = entry.Instance->GetPickingBounds();
+    entry.WorldBox = localBox.Defined() ? localBox.Transformed(l2w) : tc::BoundingBox();
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "BVH.h"
+#include "SceneGraph.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+class CMeshInstance;
+
+// Finds the mesh instances a pick ray may hit through a BVH over their world boxes. Each instance
+//  then searches its own mesh BVH. Tree nodes updated since the last pick are refit right before
+//  the next one, a change in the tree structure needs a Rebuild.
+class CInstancePicker
+{
+public:
+    void Rebuild(const CScene& scene);
+    // The node's transform or mesh may have changed
+    void MarkDirty(CSceneTreeNode* treeNode);
+    void Clear();
+
+    // Calls func on every instance whose box the ray goes through, with the ray in its local space
+    void Pick(const tc::Ray& worldRay,
+              const std::function<void(CMeshInstance*, const tc::Ray&)>& func);
+
+private:
+    void UpdateLeaf(uint32_t leaf);
+
+    struct CLeaf
+    {
+        TAutoPtr<CSceneTreeNode> TreeNode;
+        CMeshInstance* Instance;
+        tc::Matrix3x4 W2L;
+        tc::BoundingBox WorldBox;
+    };
+
+    std::vector<CLeaf> Leaves;
+    std::unordered_map<CSceneTreeNode*, uint32_t> LeafForTreeNode;
+    std::vector<uint32_t> DirtyLeaves;
+    bool bNeedsBuild = false;
+    CBVH BVH;
+};
+
+}
@@ -1,8 +1,11 @@
 #include "Mesh.h"
 // Render related
 #include "SceneGraph.h"
+#include <Parsing/BinaryStream.h>
 #include <StringPrintf.h>
 #include <StringUtils.h>
+#include <algorithm>
+#include <array>
 
 namespace Nome::Scene
 {
@@ -13,6 +16,134 @@ DEFINE_META_OBJECT(CMesh)
     // `object` is currently unhandled
 }
 
+namespace
+{
+
+// Set while AcquireLODData generates a level on this thread. Only that generation is redirected
+//  into the local mesh, everybody else keeps reading the full one.
+struct FLODBuild
+{
+    const CMesh* Mesh;
+    CMeshData* Data;
+    std::vector<CMeshImpl::VertexHandle>* LineStrip;
+    int Level;
+};
+thread_local FLODBuild* GLODBuild = nullptr;
+
+FLODBuild* FindLODBuild(const CMesh* mesh)
+{
+    return GLODBuild && GLODBuild->Mesh == mesh ? GLODBuild : nullptr;
+}
+
+}
+
+CMeshImpl::VertexHandle CMeshData::FindVertex(const std::string& name) const
+{
+    int index = VertNames.Find(name);
+    if (index >= 0)
+        return CMeshImpl::VertexHandle(index);
+    auto iter = NameToVert.find(name);
+    return iter != NameToVert.end() ? iter->second : CMeshImpl::VertexHandle();
+}
+
+CMeshImpl::FaceHandle CMeshData::FindFace(const std::string& name) const
+{
+    int index = FaceNames.Find(name);
+    if (index >= 0)
+        return CMeshImpl::FaceHandle(index);
+    auto iter = NameToFace.find(name);
+    return iter != NameToFace.end() ? iter->second : CMeshImpl::FaceHandle();
+}
+
+CMeshImpl::FaceHandle CMeshData::FindFace(const std::vector<CMeshImpl::VertexHandle>& verts) const
+{
+    if (verts.empty() || !verts[0].is_valid()
+        || verts[0].idx() >= static_cast<int>(Mesh.n_vertices()))
+        return {};
+    auto sorted = verts;
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+        return {};
+    for (auto fH : Mesh.vf_range(verts[0]))
+    {
+        if (Mesh.valence(fH) != sorted.size())
+            continue;
+        bool bMatch = true;
+        for (auto vH : Mesh.fv_range(fH))
+            bMatch = bMatch && std::binary_search(sorted.begin(), sorted.end(), vH);
+        if (bMatch)
+            return fH;
+    }
+    return {};
+}
+
+std::string CMeshData::GetFaceName(CMeshImpl::FaceHandle face) const
+{
+    auto iter = FaceToName.find(face);
+    if (iter != FaceToName.end())
+        return iter->second;
+    return FaceNames.GetName(face.idx());
+}
+
+namespace
+{
+
+// Vertices farther than this from a pick ray are never hit
+constexpr float MaxVertexPickDistance = 0.25f;
+
+std::unique_ptr<CMeshPickingBVH> BuildPickingBVH(const CMeshData& data)
+{
+    auto bvh = std::make_unique<CMeshPickingBVH>();
+    const auto& mesh = data.Mesh;
+    auto position = [&](CMeshImpl::VertexHandle vertex) {
+        const auto& pos = mesh.point(vertex);
+        return tc::Vector3 { pos[0], pos[1], pos[2] };
+    };
+
+    for (const auto& [name, vertex] : data.NameToVert)
+        bvh->VertexItems.emplace_back(vertex, name);
+    data.VertNames.ForEachIndex([&](int index) {
+        if (index < static_cast<int>(mesh.n_vertices()))
+            bvh->VertexItems.emplace_back(CMeshImpl::VertexHandle(index), std::string());
+    });
+    std::vector<tc::BoundingBox> boxes;
+    boxes.reserve(bvh->VertexItems.size());
+    const tc::Vector3 pad { MaxVertexPickDistance, MaxVertexPickDistance, MaxVertexPickDistance };
+    for (const auto& item : bvh->VertexItems)
+    {
+        auto pos = position(item.first);
+        boxes.emplace_back(pos - pad, pos + pad);
+    }
+    bvh->Vertices.Build(std::move(boxes));
+
+    boxes.clear();
+    std::vector<tc::Vector3> facePoints;
+    for (auto face : mesh.faces())
+    {
+        facePoints.clear();
+        for (auto vertex : mesh.fv_range(face))
+            facePoints.push_back(position(vertex));
+        for (size_t i = 2; i < facePoints.size(); i++)
+        {
+            std::array<tc::Vector3, 3> tri { facePoints[0], facePoints[i - 1], facePoints[i] };
+            boxes.emplace_back(tri.data(), 3);
+            bvh->TriangleItems.emplace_back(face, tri);
+        }
+    }
+    bvh->Triangles.Build(std::move(boxes));
+    return bvh;
+}
+
+}
+
+const CMeshPickingBVH& CMeshPickingCache::Get(const CMeshData& data) const
+{
+    std::lock_guard<std::mutex> lock(Lock);
+    if (!BVH)
+        BVH = BuildPickingBVH(data);
+    return *BVH;
+}
+
 #define VERT_COLOR 255, 255, 255
 #define VERT_SEL_COLOR 0, 255, 0
 
@@ -65,7 +196,7 @@ void CMesh::Draw(IDebugDraw* draw)
         std::vector<Vector3> positions;
         for (auto vHandle : LineStrip)
         {
-            const auto& vPos = Mesh.point(vHandle);
+            const auto& vPos = Data->Mesh.point(vHandle);
             positions.emplace_back(vPos[0], vPos[1], vPos[2]);
         }
 
@@ -79,21 +210,33 @@ void CMesh::Draw(IDebugDraw* draw)
 CMeshImpl::VertexHandle CMesh::AddVertex(const std::string& name, tc::Vector3 pos)
 {
     // Silently fail if the name already exists
-    auto iter = NameToVert.find(name);
-    if (iter != NameToVert.end())
-        return iter->second;
+    auto existing = GetTargetData().FindVertex(name);
+    if (existing.is_valid())
+        return existing;
 
+    auto& data = EditData();
     CMeshImpl::VertexHandle vertex;
-    vertex = Mesh.add_vertex(CMeshImpl::Point(pos.x, pos.y, pos.z));
-    NameToVert.emplace(name, vertex);
+    vertex = data.Mesh.add_vertex(CMeshImpl::Point(pos.x, pos.y, pos.z));
+    data.NameToVert.emplace(name, vertex);
+    return vertex;
+}
+
+CMeshImpl::VertexHandle CMesh::AddVertex(const CGridName& name, tc::Vector3 pos)
+{
+    int existing = GetTargetData().VertNames.Find(name);
+    if (existing >= 0)
+        return CMeshImpl::VertexHandle(existing);
+
+    auto& data = EditData();
+    auto vertex = data.Mesh.add_vertex(CMeshImpl::Point(pos.x, pos.y, pos.z));
+    data.VertNames.Add(name, vertex.idx());
     return vertex;
 }
 
 Vector3 CMesh::GetVertexPos(const std::string& name) const
 {
-    auto iter = NameToVert.find(name);
-    CMeshImpl::VertexHandle vertex = iter->second;
-    const auto& pos = Mesh.point(vertex);
+    CMeshImpl::VertexHandle vertex = Data->FindVertex(name);
+    const auto& pos = Data->Mesh.point(vertex);
     return Vector3(pos[0], pos[1], pos[2]);
 }
 
@@ -102,45 +245,254 @@ void CMesh::AddFace(const std::string& name, const std::vector<std::string>& fac
     std::vector<CMeshImpl::VertexHandle> faceVHandles;
     for (const std::string& pointName : facePoints)
     {
-        faceVHandles.push_back(NameToVert[pointName]);
+        faceVHandles.push_back(GetTargetData().FindVertex(pointName));
     }
     AddFace(name, faceVHandles);
 }
 
 void CMesh::AddFace(const std::string& name, const std::vector<CMeshImpl::VertexHandle>& facePoints)
 {
-    auto faceHandle = Mesh.add_face(facePoints);
+    auto faceHandle = InsertFace(facePoints);
     if (!faceHandle.is_valid())
         printf("Could not add face %s into mesh %s\n", name.c_str(), GetName().c_str());
-    FaceVertsToFace.emplace(facePoints,
-                            faceHandle); // Key: vertex handle, Value: faceHandle. Randy Added
-    NameToFace.emplace(name, faceHandle);
-    FaceToName.emplace(faceHandle, name); // Randy added
+    auto& data = GetTargetData();
+    data.NameToFace.emplace(name, faceHandle);
+    data.FaceToName.emplace(faceHandle, name); // Randy added
+}
+
+void CMesh::AddFace(const CGridName& name, const std::vector<CGridName>& facePoints)
+{
+    std::vector<CMeshImpl::VertexHandle> faceVHandles;
+    faceVHandles.reserve(facePoints.size());
+    for (const CGridName& pointName : facePoints)
+        faceVHandles.emplace_back(GetTargetData().VertNames.Find(pointName));
+    AddFace(name, faceVHandles);
+}
+
+void CMesh::AddFace(const CGridName& name, const std::vector<CMeshImpl::VertexHandle>& facePoints)
+{
+    auto faceHandle = InsertFace(facePoints);
+    if (faceHandle.is_valid())
+        GetTargetData().FaceNames.Add(name, faceHandle.idx());
+    else
+        printf("Could not add face %s into mesh %s\n", name.ToString().c_str(),
+               GetName().c_str());
+}
+
+CMeshImpl::FaceHandle CMesh::InsertFace(const std::vector<CMeshImpl::VertexHandle>& facePoints)
+{
+    auto& data = EditData();
+    return data.Mesh.add_face(facePoints);
 }
 
 void CMesh::AddLineStrip(const std::string& name,
                          const std::vector<CMeshImpl::VertexHandle>& points)
 {
-    LineStrip = points;
+    if (auto* build = FindLODBuild(this))
+        *build->LineStrip = points;
+    else
+        LineStrip = points;
 }
 
 void CMesh::ClearMesh()
 {
-    Mesh.clear();
-    NameToVert.clear();
-    NameToFace.clear();
-    FaceToName.clear(); // Randy added
-    FaceVertsToFace.clear(); // Randy added
+    // Instances may still be drawing the old mesh, so start over with a fresh one
+    Data = std::make_shared<CMeshData>();
+    bDataFinalized = false;
     LineStrip.clear();
+    LODData.fill(nullptr);
 }
 
 // WARNING this function is not currently used and outdated. leaving here for future use
 void CMesh::SetFromData(CMeshImpl mesh, std::map<std::string, CMeshImpl::VertexHandle> vnames,
                         std::map<std::string, CMeshImpl::FaceHandle> fnames)
 {
-    Mesh = std::move(mesh);
-    NameToVert = std::move(vnames);
-    NameToFace = std::move(fnames);
+    auto& data = EditData();
+    data.Mesh = std::move(mesh);
+    data.NameToVert = std::move(vnames);
+    data.NameToFace = std::move(fnames);
+    data.VertNames.Clear();
+    data.FaceNames.Clear();
+}
+
+namespace
+{
+
+void FinalizeMesh(CMeshImpl& mesh)
+{
+    mesh.request_vertex_status();
+    mesh.request_vertex_colors();
+    mesh.request_edge_status();
+    mesh.request_face_status();
+    for (auto vH : mesh.vertices())
+        mesh.set_color(vH, { VERT_COLOR });
+    if (!mesh.faces_empty())
+    {
+        mesh.request_face_normals();
+        mesh.request_vertex_normals();
+        mesh.update_face_normals();
+        mesh.update_vertex_normals();
+    }
+}
+
+}
+
+std::shared_ptr<const CMeshData> CMesh::AcquireData()
+{
+    std::lock_guard<std::mutex> lock(DataLock);
+    if (!bDataFinalized)
+    {
+        // Done once per rebuild here rather than once per instance
+        FinalizeMesh(Data->Mesh);
+        bDataFinalized = true;
+    }
+    return Data;
+}
+
+std::shared_ptr<const CMeshData> CMesh::AcquireLODData(int level)
+{
+    if (level <= 0 || !HasLODs())
+        return AcquireData();
+    level = std::min(level, CTessellation::MaxLODLevel);
+
+    std::lock_guard<std::mutex> lock(DataLock);
+    auto& lodData = LODData[level];
+    if (!lodData)
+    {
+        // The inputs are the same as for the full mesh, which stays untouched while this runs
+        auto data = std::make_shared<CMeshData>();
+        std::vector<CMeshImpl::VertexHandle> lineStrip;
+        FLODBuild build { this, data.get(), &lineStrip, level };
+        GLODBuild = &build;
+        GenerateMesh();
+        GLODBuild = nullptr;
+        FinalizeMesh(data->Mesh);
+        lodData = std::move(data);
+    }
+    return lodData;
+}
+
+int CMesh::GetLODLevel() const
+{
+    auto* build = FindLODBuild(this);
+    return build ? build->Level : 0;
+}
+
+CMeshData& CMesh::GetTargetData()
+{
+    if (auto* build = FindLODBuild(this))
+        return *build->Data;
+    return *Data;
+}
+
+CMeshData& CMesh::EditData()
+{
+    if (auto* build = FindLODBuild(this))
+        return *build->Data;
+    if (Data.use_count() > 1)
+        Data = std::make_shared<CMeshData>(*Data);
+    bDataFinalized = false;
+    Data->PickingCache.Reset();
+    return *Data;
+}
+
+void CMesh::WriteGenerated(CBinaryWriter& out) const
+{
+    const auto& data = *Data;
+    const auto& mesh = data.Mesh;
+    out.Write(IsEntityValid());
+    out.Write(static_cast<uint32_t>(mesh.n_vertices()));
+    for (auto vH : mesh.vertices())
+    {
+        const auto& pos = mesh.point(vH);
+        out.Write(std::array<float, 3> { pos[0], pos[1], pos[2] });
+    }
+    out.Write(static_cast<uint32_t>(mesh.n_faces()));
+    for (auto fH : mesh.faces())
+    {
+        out.Write(static_cast<uint32_t>(mesh.valence(fH)));
+        for (auto vH : mesh.fv_range(fH))
+            out.Write(vH.idx());
+    }
+
+    data.VertNames.Write(out);
+    data.FaceNames.Write(out);
+    out.Write(static_cast<uint32_t>(data.NameToVert.size()));
+    for (const auto& [name, vH] : data.NameToVert)
+    {
+        out.WriteString(name);
+        out.Write(vH.idx());
+    }
+    // Also covers FaceToName, failed faces are named with an invalid handle
+    out.Write(static_cast<uint32_t>(data.NameToFace.size()));
+    for (const auto& [name, fH] : data.NameToFace)
+    {
+        out.WriteString(name);
+        out.Write(fH.idx());
+    }
+    out.Write(static_cast<uint32_t>(LineStrip.size()));
+    for (auto vH : LineStrip)
+        out.Write(vH.idx());
+}
+
+void CMesh::RestoreGenerated(CBinaryReader& in)
+{
+    // Regenerating would have pulled the inputs. They have to be clean either way, a change
+    //  upstream would otherwise stop at them and never reach this mesh.
+    for (auto* input : GetInputSlots())
+        if (auto* upstream = input->GetUpstreamNode())
+            for (auto* output : upstream->GetOutputSlots())
+                output->Update();
+
+    ClearMesh();
+    auto& data = EditData();
+    auto& mesh = data.Mesh;
+    bool bValid = in.Read<bool>();
+    auto numVerts = in.Read<uint32_t>();
+    for (uint32_t i = 0; i < numVerts; i++)
+    {
+        auto pos = in.Read<std::array<float, 3>>();
+        mesh.add_vertex(CMeshImpl::Point(pos[0], pos[1], pos[2]));
+    }
+    auto readVertex = [&]() {
+        auto index = in.Read<int>();
+        if (index < 0 || index >= static_cast<int>(numVerts))
+            throw std::runtime_error("Vertex index out of range");
+        return CMeshImpl::VertexHandle(index);
+    };
+    auto numFaces = in.Read<uint32_t>();
+    std::vector<CMeshImpl::VertexHandle> faceVerts;
+    for (uint32_t i = 0; i < numFaces; i++)
+    {
+        faceVerts.resize(in.Read<uint32_t>());
+        for (auto& vH : faceVerts)
+            vH = readVertex();
+        mesh.add_face(faceVerts);
+    }
+
+    data.VertNames.Read(in);
+    data.FaceNames.Read(in);
+    auto numNamedVerts = in.Read<uint32_t>();
+    for (uint32_t i = 0; i < numNamedVerts; i++)
+    {
+        std::string name(in.ReadString());
+        data.NameToVert.emplace(std::move(name), readVertex());
+    }
+    auto numNamedFaces = in.Read<uint32_t>();
+    for (uint32_t i = 0; i < numNamedFaces; i++)
+    {
+        std::string name(in.ReadString());
+        CMeshImpl::FaceHandle fH(in.Read<int>());
+        data.FaceToName.emplace(fH, name);
+        data.NameToFace.emplace(std::move(name), fH);
+    }
+    LineStrip.resize(in.Read<uint32_t>());
+    for (auto& vH : LineStrip)
+        vH = readVertex();
+
+    // Skips the subclass, which would regenerate
+    CEntity::UpdateEntity();
+    SetValid(bValid);
 }
 
 bool CMesh::IsInstantiable() { return true; }
@@ -206,37 +558,30 @@ void CMeshInstance::UpdateEntity()
         return;
     MeshGenerator->UpdateEntity();
     CopyFromGenerator();
-    Mesh.request_vertex_status();
-    Mesh.request_vertex_colors();
-    Mesh.request_edge_status();
-    Mesh.request_face_status();
-    for (auto vH : Mesh.vertices())
-    {
-        Mesh.set_color(vH, { VERT_COLOR });
-    }
-    for (const std::string& face : FacesToDelete)
+    if (!FacesToDelete.empty())
     {
-        auto iter = NameToFace.find(face);
-        if (iter != NameToFace.end())
+        auto& data = EditData();
+        for (const std::string& face : FacesToDelete)
         {
-            Mesh.delete_face(iter->second, false);
+            auto faceHandle = data.FindFace(face);
+            if (faceHandle.is_valid())
+            {
+                data.Mesh.delete_face(faceHandle, false);
+            }
+            else
+            {
+                printf("Couldn't find face %s for deletion in mesh instance %s\n", face.c_str(),
+                       GetName().c_str());
+            }
         }
-        else
+
+        if (!data.Mesh.faces_empty())
         {
-            printf("Couldn't find face %s for deletion in mesh instance %s\n", face.c_str(),
-                   GetName().c_str());
+            data.Mesh.update_face_normals();
+            data.Mesh.update_vertex_normals();
         }
     }
 
-    if (!Mesh.faces_empty())
-    {
-        Mesh.request_face_normals();
-        Mesh.request_vertex_normals();
-        Mesh.update_face_normals();
-        Mesh.update_vertex_normals();
-        // Update visual layer geometry
-    }
-
 
     // Randy commented the below section on 10/10. i don't think it does anything ??? 
     // Construct interactive points
@@ -270,293 +615,168 @@ void CMeshInstance::Draw(IDebugDraw* draw) { MeshGenerator->Draw(draw); }
 CVertexSelector* CMeshInstance::CreateVertexSelector(const std::string& name,
                                                      const std::string& outputName)
 {
-    auto* selector = new CVertexSelector(name, outputName);
-    SelectorSignal.Connect(selector->MeshInstance);
+    auto& selector = VertexSelectors[{ name, outputName }];
+    if (!selector)
+    {
+        selector = new CVertexSelector(name, outputName);
+        selector->Instance = this;
+        SelectorSignal.Connect(selector->MeshInstance);
+    }
     return selector;
 }
 
 void CMeshInstance::CopyFromGenerator()
 {
-    Mesh.clear();
-    NameToVert.clear();
-    NameToFace.clear();
-    FaceToName.clear(); // Randy added
-    FaceVertsToFace.clear();
+    // Nothing is copied here, the private copy is only made by the first edit
+    SharedData = MeshGenerator->AcquireData();
+    OwnData = nullptr;
+    LODData = nullptr;
+}
 
-    Mesh = MeshGenerator->Mesh;
-    // Since the handle only contains an index, we can just copy
-    NameToVert = MeshGenerator->NameToVert;
-    NameToFace = MeshGenerator->NameToFace;
-    FaceToName = MeshGenerator->FaceToName; // Randy added
-    FaceVertsToFace = MeshGenerator->FaceVertsToFace; // Randy added
+const CMeshImpl& CMeshInstance::GetDrawMeshImpl()
+{
+    if (LODLevel == 0 || OwnData)
+        return GetMeshImpl();
+    if (!LODData)
+        LODData = MeshGenerator->AcquireLODData(LODLevel);
+    return LODData->Mesh;
+}
+
+bool CMeshInstance::SetLODLevel(int level)
+{
+    if (OwnData || !MeshGenerator->HasLODs())
+        level = 0;
+    level = std::clamp(level, 0, CTessellation::MaxLODLevel);
+    if (level == LODLevel)
+        return false;
+    LODLevel = level;
+    LODData = nullptr;
+    return true;
+}
+
+const CMeshData& CMeshInstance::GetData() const
+{
+    if (OwnData)
+        return *OwnData;
+    if (SharedData)
+        return *SharedData;
+    static const CMeshData emptyData;
+    return emptyData;
+}
+
+CMeshData& CMeshInstance::EditData()
+{
+    if (!OwnData)
+        OwnData = std::make_unique<CMeshData>(GetData());
+    OwnData->PickingCache.Reset();
+    return *OwnData;
 }
 
 void CMeshInstance::RemoveFace(const std::vector<std::string>& facePoints) // Randy added
 {
-    auto instPrefix = GetSceneTreeNode()->GetPath() + ".";
     if (AllVertSelected)
-    {
-        std::vector<CMeshImpl::VertexHandle> faceverthandles;
-        for (const auto& myPair :
-             NameToVert) // mesh vert name to vert handle. The issue is they all have the exact same
-                         // mesh vert name and vert handle. Transformation is applied to each
-        {
-            auto test = myPair.first;
-            std::cout << test << std::endl;
-            std::cout << myPair.second.idx() << std::endl;
-        }
-        for (const auto& myPair : NameToFace) // mesh vert name to vert handle. The issue is they
-                                              // all have the same mesh vert name and vert handle.
-        {
-            auto test = myPair.first;
-            std::cout << test << std::endl;
-            std::cout << myPair.second.idx() << std::endl;
-        }
-        for (auto name : facePoints)
-        {
-
-            // The next few lines fixed the bug
-            std::cout << name << std::endl;
-            auto suffix = name.substr(name.find_last_of(".")
-                                      + 1); // get, for example, p5 from cube0.bottom.p5. THIS IS
-                                            // CAUSING A BUG WHEN ALL FACES SHARE THE SAME SUFFIX
-            auto prefix = name.substr(0, name.find_last_of(".") + 1);
-            // auto it = NameToVert.find(suffix);  WRONG THIS WILL ALWAYTS BE FOUND
-            if (prefix == instPrefix)
-            {
-                std::cout << "00" << std::endl;
-                auto verthandle = NameToVert.at(suffix);
-                faceverthandles.push_back(verthandle);
-            }
-        }
-        CMeshImpl::FaceHandle faceHandle;
-        std::string faceName = "none";
-        for (const auto& myPair :
-             FaceVertsToFace) // iterate  through all the faceverts and face pairs
-        {
-            auto currfaceverthandles = myPair.first;
-            if (faceverthandles.size()
-                != 0) // an empty vector is a permutation of any vector, so we need to ignore it
-            {
-                if (std::is_permutation(faceverthandles.begin(), faceverthandles.end(),
-                                        currfaceverthandles.begin()))
-                {
-                    auto fhiter =
-                        FaceVertsToFace.find(currfaceverthandles); // i think this is not finding
-                    if (fhiter != FaceVertsToFace.end())
-                    {
-                        faceHandle = FaceVertsToFace.at(currfaceverthandles);
-                    }
-                    auto fniter = FaceToName.find(faceHandle);
-                    if (fniter != FaceToName.end())
-                    {
-                        faceName = FaceToName.at(faceHandle);
-                        FacesToDelete.insert(faceName);
-                        this->MarkDirty(); // not sure if this is needed
-                    }
-                }
-            }
-        }
-    }
+        DeleteFaceWithVerts(facePoints);
     AllVertSelected = false; // done removing the face with all vert selected
-
-    // if no faces added into facestodelete, this function silently fails
 }
 
 void CMeshInstance::PreserveFace(const std::vector<std::string>& facePoints) // Randy added
 {
-    auto instPrefix = GetSceneTreeNode()->GetPath() + ".";
+    // The face was copied (with a new name) in TempMeshManager, so it goes from here the same way
     if (AllVertSelected)
-    {
-        std::vector<CMeshImpl::VertexHandle> faceverthandles;
-        for (const auto& myPair : NameToVert)
-        {
-            auto test = myPair.first;
-            std::cout << myPair.second.idx() << std::endl;
-        }
-        for (const auto& myPair : NameToFace)
-        {
-            auto test = myPair.first;
-        }
-        for (auto name : facePoints)
-        {
-
-            // The next few lines fixed the bug
-            auto suffix = name.substr(name.find_last_of(".")
-                                      + 1); // get, for example, p5 from cube0.bottom.p5. THIS IS
-                                            // CAUSING A BUG WHEN ALL FACES SHARE THE SAME SUFFIX
-            auto prefix = name.substr(0, name.find_last_of(".") + 1);
-            //std::cout << prefix << std::endl;
-            //std::cout << instPrefix << std::endl;
-            // auto it = NameToVert.find(suffix);  WRONG THIS WILL ALWAYTS BE FOUND
-            if (prefix == instPrefix)
-            {
-                auto verthandle = NameToVert.at(suffix);
-                faceverthandles.push_back(verthandle);
-            }
-        }
-        //std::cout << faceverthandles.size() << std::endl;
-        //std::cout << "above is face vert handles size for preserved face" << std::endl;
-        CMeshImpl::FaceHandle faceHandle;
-        std::string faceName = "none";
-        //std::cout << FaceVertsToFace.size() << std::endl;
-        //std::cout << "above is total number of faces in mesh" << std::endl;
-        for (const auto& myPair :
-             FaceVertsToFace) // iterate  through all the faceverts and face pairs
-        {
+        DeleteFaceWithVerts(facePoints);
+    AllVertSelected = false;
+}
 
-            auto currfaceverthandles = myPair.first;
-            //std::cout << FaceVertsToFace.size() << std::endl;
-            //std::cout << "above is total number of faces in mesh" << std::endl;
-            //std::cout << currfaceverthandles.size() << std::endl; // THIS IS THE BUG
-            //std::cout << "above is face vert handles size for preserved face" << std::endl;
-            if (faceverthandles.size()
-                != 0) // an empty vector is a permutation of any vector, so we need to ignore it
-            {
-                if (std::is_permutation(
-                        faceverthandles.begin(), faceverthandles.end(),
-                        currfaceverthandles
-                            .begin())) // if the selected vertices match the current face vertices
-                {
-
-                    std::cout << "Found a permutation"
-                              << std::endl;
-                    auto fhiter =
-                        FaceVertsToFace.find(currfaceverthandles); 
-                    if (fhiter != FaceVertsToFace.end())
-                    {
-                        faceHandle = FaceVertsToFace.at(currfaceverthandles);
-                    }
-                    auto fniter = FaceToName.find(faceHandle);
-                    if (fniter != FaceToName.end())
-                    {
-
-                        // This face is deleted here and was copied (with a new name) in
-                        // TempMeshManager
-
-                        faceName = FaceToName.at(faceHandle);
-                        FacesToDelete.insert(faceName);
-                        this->MarkDirty(); // not sure if this is needed
-                    }
-                }
-            }
-        }
+void CMeshInstance::DeleteFaceWithVerts(const std::vector<std::string>& vertPaths)
+{
+    const auto& data = GetData();
+    auto instPrefix = GetSceneTreeNode()->GetPath() + ".";
+    std::vector<CMeshImpl::VertexHandle> faceVerts;
+    for (const auto& path : vertPaths)
+    {
+        // Paths look like cube0.bottom.p5, only vertices of this instance count
+        auto dot = path.find_last_of('.');
+        if (dot == std::string::npos || path.compare(0, dot + 1, instPrefix) != 0)
+            continue;
+        auto vertHandle = data.FindVertex(path.substr(dot + 1));
+        if (vertHandle.is_valid())
+            faceVerts.push_back(vertHandle);
     }
-    AllVertSelected = false; // done removing the face with all vert selected
 
-    // if no faces added into facestodelete, this function silently fails
+    // If no face matches, this silently does nothing
+    auto face = data.FindFace(faceVerts);
+    if (!face.is_valid())
+        return;
+    auto faceName = data.GetFaceName(face);
+    if (!faceName.empty())
+    {
+        FacesToDelete.insert(faceName);
+        MarkDirty();
+    }
 }
 
+tc::BoundingBox CMeshInstance::GetPickingBounds() const
+{
+    const auto& data = GetData();
+    const auto& bvh = data.PickingCache.Get(data);
+    auto bounds = bvh.Vertices.GetBounds();
+    bounds.Merge(bvh.Triangles.GetBounds());
+    return bounds;
+}
 
-std::vector<std::pair<float, std::string>> CMeshInstance::PickFaces(const tc::Ray& localRay) {
+std::vector<std::pair<float, std::string>> CMeshInstance::PickFaces(const tc::Ray& localRay)
+{
+    const auto& data = GetData();
+    const auto& bvh = data.PickingCache.Get(data);
+    // A face is hit as often as its fan triangles are, only the nearest counts
+    std::map<int, float> nearest;
+    bvh.Triangles.QueryRay(localRay, [&](uint32_t item) {
+        const auto& [face, tri] = bvh.TriangleItems[item];
+        float t = localRay.HitDistance(tri[0], tri[1], tri[2]);
+        if (t == tc::M_INFINITY)
+            return;
+        auto [iter, bInserted] = nearest.emplace(face.idx(), t);
+        if (!bInserted)
+            iter->second = std::min(iter->second, t);
+    });
 
-    // Randy look at this for delete face
     std::vector<std::pair<float, std::string>> result;
     auto instPrefix = GetSceneTreeNode()->GetPath() + ".";
-    for (const auto& pair : FaceVertsToFace)
+    for (const auto& [index, t] : nearest)
     {
-        /// Construct from 3 vertices.
-        /*Plane(const Vector3& v0, const Vector3& v1, const Vector3& v2) noexcept
-        {
-            Define(v0, v1, v2);
-        }*/
-
-        auto points = pair.first;
-        auto firstpoint = points[0];
-        auto secondpoint = points[1];
-        auto thirdpoint = points[2];
-        const auto& posArr1 = Mesh.point(firstpoint);
-        tc::Vector3 pos1 { posArr1[0], posArr1[1], posArr1[2] };
-        const auto& posArr2 = Mesh.point(secondpoint);
-        tc::Vector3 pos2 { posArr2[0], posArr2[1], posArr2[2] };
-        const auto& posArr3 = Mesh.point(thirdpoint);
-        tc::Vector3 pos3 { posArr3[0], posArr3[1], posArr3[2] };
-        auto testplane = new tc::Plane(pos1, pos2, pos3);
-        auto instPrefix = GetSceneTreeNode()->GetPath() + ".";
-        std::cout << instPrefix << std::endl;
-        std::cout << FaceToName.at(pair.second) << std::endl;
-        std::cout << pos1.ToString() << std::endl;
-        std::cout << pos2.ToString() << std::endl;
-        std::cout << pos3.ToString() << std::endl;
-       // tc::Vector3 projected = localRay.Project(pos);
-
-       // bool Ray::InsideGeometry(const void* vertexData, unsigned vertexSize, unsigned vertexStart,
-        //                         unsigned vertexCount) const
-
-
-        // Randy note: They all have the same position because the local ray is transformed differently
-        auto testdist = localRay.HitDistance(*testplane);
-        std::cout << testdist << std::endl;
-        //auto othertest = localRay.InsideGeometry(&points,4, 0, points.size()); 
-
-       // std::cout << "other test: " + std::to_string(othertest) << std::endl;
-
-        /// Return hit distance to a triangle, or infinity if no hit. Optionally return hit normal
-        /// and hit barycentric coordinate at intersect point.
-        //float HitDistance(const Vector3& v0, const Vector3& v1, const Vector3& v2,
-          //                Vector3* outNormal = nullptr, Vector3* outBary = nullptr) const;
-
-        auto testdist1 = localRay.HitDistance(pos1, pos2, pos3);
-        
-        std::cout << "other test #2: " + std::to_string(testdist1) << std::endl;
-        //auto dist = (pos - projected).Length();
-       
-        //auto t = (localRay.Origin - projected).Length();
-      
-
-       
-        
-        //if (testdist < 10)//std::min(0.01f * t, 0.25f))
-        //{
-        //    //result.emplace_back(t, instPrefix + pair.first);
-        //}
-
-
-
-
-        //auto pos = (pos1 + pos2 + pos3) / 3.f; // find average face position
-        //tc::Vector3 projected = localRay.Project(pos);
-        //auto dist = (pos - projected).Length();
-        //auto t = (localRay.Origin - projected).Length();
-        //std::cout << dist << std::endl;
-        //std::cout << "dist above" << std::endl;
-        //if (dist < std::min(0.01f * t, 0.25f))
-        //{
-        //    //result.emplace_back(t, instPrefix + pair.first);
-        //}
+        auto name = data.GetFaceName(CMeshImpl::FaceHandle(index));
+        if (!name.empty())
+            result.emplace_back(t, instPrefix + name);
     }
     std::sort(result.begin(), result.end());
 
     for (const auto& sel : result)
     {
-        printf("t=%.3f v=%s\n", sel.first, sel.second.c_str());
+        printf("t=%.3f f=%s\n", sel.first, sel.second.c_str());
     }
     return result;
-
-
 }
 
-
-
 std::vector<std::pair<float, std::string>> CMeshInstance::PickVertices(const tc::Ray& localRay)
 {
-    // Randy look at this for delete face
+    const auto& data = GetData();
+    const auto& bvh = data.PickingCache.Get(data);
     std::vector<std::pair<float, std::string>> result;
     auto instPrefix = GetSceneTreeNode()->GetPath() + ".";
-    for (const auto& pair : NameToVert)
-    {
-        const auto& posArr = Mesh.point(pair.second);
-        assert(posArr.size() == 3);
+    // Only the vertices whose grown boxes the ray goes through can be close enough
+    bvh.Vertices.QueryRay(localRay, [&](uint32_t item) {
+        const auto& [vertex, name] = bvh.VertexItems[item];
+        const auto& posArr = data.Mesh.point(vertex);
         tc::Vector3 pos { posArr[0], posArr[1], posArr[2] };
         tc::Vector3 projected = localRay.Project(pos);
         auto dist = (pos - projected).Length();
         auto t = (localRay.Origin - projected).Length();
-
-        if (dist < std::min(0.01f * t, 0.25f))
-        {
-            result.emplace_back(t, instPrefix + pair.first);
-        }
-    }
+        if (dist >= std::min(0.01f * t, MaxVertexPickDistance))
+            return;
+        // Generated names are only spelled out for the vertices actually hit
+        result.emplace_back(t, instPrefix
+                                   + (name.empty() ? data.VertNames.GetName(vertex.idx()) : name));
+    });
     std::sort(result.begin(), result.end());
 
     for (const auto& sel : result)
@@ -572,23 +792,24 @@ void CMeshInstance::MarkAsSelected(const std::set<std::string>& vertNames, bool
     size_t prefixLen = instPrefix.length();
     for (const auto& name : vertNames)
     {
-        auto iter = NameToVert.find(name.substr(prefixLen));
-        if (iter == NameToVert.end())
+        auto handle = GetData().FindVertex(name.substr(prefixLen));
+        if (!handle.is_valid())
             continue;
 
-        auto handle = iter->second;
-        const auto& original = Mesh.color(handle);
+        // Recoloring is what forces this instance to stop sharing the generator's mesh
+        auto& data = EditData();
+        const auto& original = data.Mesh.color(handle);
         printf("Before: %d %d %d\n", original[0], original[1], original[2]);
         if (CurrSelectedVertNames.find(name) == CurrSelectedVertNames.end())
         { // if hasn't been selected before
             if (bSel)
-                Mesh.set_color(handle, { VERT_SEL_COLOR });
+                data.Mesh.set_color(handle, { VERT_SEL_COLOR });
             else
-                Mesh.set_color(handle, { VERT_COLOR });
+                data.Mesh.set_color(handle, { VERT_COLOR });
             CurrSelectedVerts.insert(name.substr(prefixLen));
             CurrSelectedVertNames.insert(name);
 
-            if (CurrSelectedVertNames.size() == NameToVert.size())
+            if (CurrSelectedVertNames.size() == data.GetNumNamedVerts())
             { // RANDY REMOVE THIS LATER if we selected all the available vertices on a face.
               // Reminder, a face is a mesh! A "mesh" command would be a collection of face meshes.
                 AllVertSelected = true;
@@ -596,7 +817,7 @@ void CMeshInstance::MarkAsSelected(const std::set<std::string>& vertNames, bool
         }
         else // it has already been selected, then deselect
         {
-            Mesh.set_color(handle, { VERT_COLOR });
+            data.Mesh.set_color(handle, { VERT_COLOR });
             if (CurrSelectedVerts.find(name.substr(prefixLen)) != CurrSelectedVerts.end())
             { // erase once
                 CurrSelectedVerts.erase(name.substr(prefixLen));
@@ -610,16 +831,39 @@ void CMeshInstance::MarkAsSelected(const std::set<std::string>& vertNames, bool
 
 void CMeshInstance::DeselectAll()
 {
-    for (const auto& name : CurrSelectedVerts)
+    if (!CurrSelectedVerts.empty())
     {
-        auto handle = NameToVert[name];
-        Mesh.set_color(handle, { VERT_COLOR });
+        if (FacesToDelete.empty())
+        {
+            // Nothing else is overridden, go back to sharing the generator's mesh
+            OwnData = nullptr;
+        }
+        else
+        {
+            auto& data = EditData();
+            for (const auto& name : CurrSelectedVerts)
+            {
+                auto handle = data.FindVertex(name);
+                if (handle.is_valid())
+                    data.Mesh.set_color(handle, { VERT_COLOR });
+            }
+        }
         GetSceneTreeNode()->SetEntityUpdated(true);
     }
     CurrSelectedVerts.clear();
     CurrSelectedVertNames.clear(); // added 10/3
 }
 
+void CMeshInstance::DiscardEdits()
+{
+    bool bHadDeletions = !FacesToDelete.empty();
+    FacesToDelete.clear();
+    DeselectAll();
+    // Copying from the generator again drops the private copy the deletions were made on
+    if (bHadDeletions)
+        MarkDirty();
+}
+
 void CVertexSelector::PointUpdate()
 {
     // Assume MeshInstance is connected
@@ -629,20 +873,26 @@ void CVertexSelector::PointUpdate()
         printf("Vertex %s does not have a mesh instance\n", TargetName.c_str());
         return;
     }
-    auto iter = mi->NameToVert.find(TargetName);
-    if (iter == mi->NameToVert.end())
+    const auto& data = mi->GetData();
+    auto vertHandle = data.FindVertex(TargetName);
+    if (!vertHandle.is_valid())
     {
         printf("Vertex %s does not exist in entity %s\n", TargetName.c_str(),
                mi->GetName().c_str());
         return;
     }
-    auto vertHandle = iter->second;
-    const auto& p = mi->Mesh.point(vertHandle);
+    const auto& p = data.Mesh.point(vertHandle);
     VI.Position = { p[0], p[1], p[2] };
     VI.Position = mi->GetSceneTreeNode()->L2WTransform.GetValue(Matrix3x4::IDENTITY) * VI.Position;
     Point.UpdateValue(&VI);
 }
 
+CVertexSelector::~CVertexSelector()
+{
+    if (Instance)
+        Instance->VertexSelectors.erase({ TargetName, VI.Name });
+}
+
 std::string CVertexSelector::GetPath() const
 {
     auto* mi = MeshInstance.GetValue(nullptr);
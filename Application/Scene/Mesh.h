@@ -1,16 +1,21 @@
 #pragma once
+#include "BVH.h"
 #include "Face.h"
+#include "GridNames.h"
 #include "InteractivePoint.h"
+#include "Tessellation.h"
 
 #include <Ray.h>
-#include <Plane.h> // Randy added on 10/10 for pick face
 // We use OpenMesh for now. Can easily replace with in-house library when needed.
 #define _USE_MATH_DEFINES
 #undef min
 #undef max
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 
+#include <array>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <utility>
 
@@ -21,6 +26,63 @@ namespace Nome::Scene
 
 class CMeshInstance;
 class CVertexSelector;
+struct CMeshData;
+
+// Boxes around the named vertices and the faces of a mesh, for picking
+struct CMeshPickingBVH
+{
+    // Grown by the farthest a pick ray may pass a vertex by
+    CBVH Vertices;
+    // Empty names are generated ones, only spelled out when hit
+    std::vector<std::pair<CMeshImpl::VertexHandle, std::string>> VertexItems;
+    // Faces split into fans
+    CBVH Triangles;
+    std::vector<std::pair<CMeshImpl::FaceHandle, std::array<tc::Vector3, 3>>> TriangleItems;
+};
+
+// Built on first use, copies of the mesh data start without one since they are about to change
+class CMeshPickingCache
+{
+public:
+    CMeshPickingCache() = default;
+    CMeshPickingCache(const CMeshPickingCache&) {}
+    CMeshPickingCache& operator=(const CMeshPickingCache&)
+    {
+        Reset();
+        return *this;
+    }
+
+    const CMeshPickingBVH& Get(const CMeshData& data) const;
+    void Reset() { BVH.reset(); }
+
+private:
+    mutable std::mutex Lock;
+    mutable std::unique_ptr<CMeshPickingBVH> BVH;
+};
+
+// The generated mesh together with its naming. Generators hand it out shared, and instances keep
+//  reading the shared copy until they have something of their own to change in it.
+struct CMeshData
+{
+    CMeshImpl Mesh;
+    std::map<std::string, CMeshImpl::VertexHandle> NameToVert;
+    std::map<std::string, CMeshImpl::FaceHandle> NameToFace;
+    std::map<CMeshImpl::FaceHandle, std::string> FaceToName; // Randy added
+    // Generated names like "v3_7", these never go into the string maps above
+    CGridNameTable VertNames;
+    CGridNameTable FaceNames;
+    CMeshPickingCache PickingCache;
+
+    // Look in both the grid names and the string maps, invalid handles if nothing matches
+    CMeshImpl::VertexHandle FindVertex(const std::string& name) const;
+    CMeshImpl::FaceHandle FindFace(const std::string& name) const;
+    // The face made of exactly these vertices in any order, found among the faces around the
+    //  first one. Invalid if there is none.
+    CMeshImpl::FaceHandle FindFace(const std::vector<CMeshImpl::VertexHandle>& verts) const;
+    // Empty for unnamed faces
+    std::string GetFaceName(CMeshImpl::FaceHandle face) const;
+    size_t GetNumNamedVerts() const { return NameToVert.size() + VertNames.GetSize(); }
+};
 
 // Common base class for all mesh objects
 class CMesh : public CEntity
@@ -37,15 +99,16 @@ public:
     void Draw(IDebugDraw* draw) override;
 
     CMeshImpl::VertexHandle AddVertex(const std::string& name, Vector3 pos);
+    // Generators should prefer these, no string is built per element
+    CMeshImpl::VertexHandle AddVertex(const CGridName& name, Vector3 pos);
 
-    bool HasVertex(const std::string& name) const
-    {
-        return NameToVert.find(name) != NameToVert.end();
-    }
+    bool HasVertex(const std::string& name) const { return Data->FindVertex(name).is_valid(); }
 
     Vector3 GetVertexPos(const std::string& name) const;
     void AddFace(const std::string& name, const std::vector<std::string>& facePoints);
     void AddFace(const std::string& name, const std::vector<CMeshImpl::VertexHandle>& facePoints);
+    void AddFace(const CGridName& name, const std::vector<CGridName>& facePoints);
+    void AddFace(const CGridName& name, const std::vector<CMeshImpl::VertexHandle>& facePoints);
     void AddLineStrip(const std::string& name, const std::vector<CMeshImpl::VertexHandle>& points);
     void ClearMesh();
 
@@ -56,18 +119,51 @@ public:
     CEntity* Instantiate(CSceneTreeNode* treeNode) override;
     AST::ACommand* SyncToAST(AST::CASTContext& ctx, bool createNewNode) override;
 
+    // Returns the mesh with colors and normals filled in, shared with the caller read-only
+    std::shared_ptr<const CMeshData> AcquireData();
+    // A coarser mesh for drawing only, built on first use and kept until the next regeneration.
+    //  Level 0 and meshes without levels of detail return AcquireData.
+    std::shared_ptr<const CMeshData> AcquireLODData(int level);
+    virtual bool HasLODs() const { return false; }
+    // Curved surfaces without creases, drawn with vertices shared between faces
+    virtual bool IsSmooth() const { return false; }
+
+    // For the scene cache. Restoring stands in for the next regeneration, so the inputs must be
+    //  the same as when the mesh was written.
+    void WriteGenerated(CBinaryWriter& out) const;
+    void RestoreGenerated(CBinaryReader& in);
+
+protected:
+    // Detaches the mesh from any instance still holding it, call before every modification
+    CMeshData& EditData();
+    const CMeshData& GetData() const { return *Data; }
+
+    // Generators with levels of detail build their mesh here, UpdateEntity calls it for level 0
+    virtual void GenerateMesh() {}
+    // Level GenerateMesh is currently building, nothing but the mesh may change above 0
+    int GetLODLevel() const;
+    // Segment count to generate with, userSegs at level 0
+    int GetLODSegments(int userSegs, float radius, float angle, int minSegs = 3) const
+    {
+        return CTessellation::GetLODSegments(userSegs, radius, angle, GetLODLevel(), minSegs);
+    }
+
 private:
+    // The mesh generation writes to, a local one while AcquireLODData builds a level
+    CMeshData& GetTargetData();
+    // Adds the face without naming it
+    CMeshImpl::FaceHandle InsertFace(const std::vector<CMeshImpl::VertexHandle>& facePoints);
+
     friend class CMeshInstance;
     friend class CMeshMerger;
     std::set<CMeshInstance*> InstanceSet;
 
-    CMeshImpl Mesh;
-    std::map<std::string, CMeshImpl::VertexHandle> NameToVert;
-    std::map<std::string, CMeshImpl::FaceHandle> NameToFace;
-    std::map<CMeshImpl::FaceHandle, std::string> FaceToName; // Randy added
-    std::map<std::vector<CMeshImpl::VertexHandle>, CMeshImpl::FaceHandle>
-        FaceVertsToFace; // Randy added
+    std::shared_ptr<CMeshData> Data = std::make_shared<CMeshData>();
+    // Guards the lazy finishing touches in AcquireData, instances may ask concurrently
+    std::mutex DataLock;
+    bool bDataFinalized = false;
     std::vector<CMeshImpl::VertexHandle> LineStrip;
+    std::array<std::shared_ptr<const CMeshData>, CTessellation::MaxLODLevel + 1> LODData;
 };
 
 class CMeshInstancePoint : public CInteractivePoint
@@ -110,13 +206,18 @@ public:
     void MarkOnlyDownstreamDirty();
     // Copy the actual mesh from the mesh entity and notify selectors
     void UpdateEntity() override;
+    void GetHiddenDependencies(std::vector<CEntity*>& deps) const override
+    {
+        deps.push_back(MeshGenerator);
+    }
 
     std::set<std::string>& GetFacesToDelete() { return FacesToDelete; }
     const std::set<std::string>& GetFacesToDelete() const { return FacesToDelete; }
 
     void Draw(IDebugDraw* draw) override;
 
-    // Create a vertex selector with a vertex name, and a name for the resulting vertex
+    // Create a vertex selector with a vertex name, and a name for the resulting vertex. Returns the
+    //  existing one if a selector with the same names is still alive.
     CVertexSelector* CreateVertexSelector(const std::string& name, const std::string& outputName);
 
     // Get the scene tree node associated with this mesh instance
@@ -128,29 +229,49 @@ public:
     void PreserveFace(const std::vector<std::string>& facePoints); // Randy added, not fully implemented yet
 
     // I am really not sure whether this is a good interface or not
-    const CMeshImpl& GetMeshImpl() const { return Mesh; }
-
+    const CMeshImpl& GetMeshImpl() const { return GetData().Mesh; }
+    // The mesh to draw, coarser than GetMeshImpl above level 0. Edited instances always draw
+    //  the full mesh since their edits are made by name.
+    const CMeshImpl& GetDrawMeshImpl();
+    // Returns whether the level changed, nothing is regenerated either way
+    bool SetLODLevel(int level);
+    int GetLODLevel() const { return LODLevel; }
+    bool IsSmooth() const { return MeshGenerator->IsSmooth(); }
+
+    // Local space box around everything PickVertices and PickFaces can hit
+    tc::BoundingBox GetPickingBounds() const;
+    // Hits sorted by distance along the ray, named vertices and faces only
     std::vector<std::pair<float, std::string>> PickVertices(const tc::Ray& localRay);
     std::vector<std::pair<float, std::string>> PickFaces(const tc::Ray& localRay); // Randy added on 10/10 to pick faces
     void MarkAsSelected(const std::set<std::string>& vertNames, bool bSel);
     void DeselectAll();
+    // Forgets face deletions and the selection, back to exactly what the nom file says
+    void DiscardEdits();
 
 private:
+    const CMeshData& GetData() const;
+    // Makes a private copy of the generator's mesh on the first edit
+    CMeshData& EditData();
+    // Deletes the face whose vertices are exactly the given vertex paths of this instance
+    void DeleteFaceWithVerts(const std::vector<std::string>& vertPaths);
+
     TAutoPtr<CMesh> MeshGenerator;
     /// A weak pointer to the owning scene tree node
     CSceneTreeNode* SceneTreeNode;
 
     unsigned int TransformChangeConnection;
 
-    CMeshImpl Mesh;
-    std::map<std::string, CMeshImpl::VertexHandle> NameToVert;
-    std::map<std::string, CMeshImpl::FaceHandle> NameToFace;
-    std::map<CMeshImpl::FaceHandle, std::string> FaceToName; // Randy added
-    std::map<std::vector<CMeshImpl::VertexHandle>, CMeshImpl::FaceHandle>
-        FaceVertsToFace; // Randy added
+    // Read-only mesh shared with the generator and its other instances
+    std::shared_ptr<const CMeshData> SharedData;
+    // Only exists once this instance deleted faces or colored its vertices
+    std::unique_ptr<CMeshData> OwnData;
+    int LODLevel = 0;
+    std::shared_ptr<const CMeshData> LODData;
     bool AllVertSelected; // Randy added. Useful for knowing when the face has been selected
     // Instance specific data
     std::set<std::string> FacesToDelete;
+    // Selectors unregister themselves when the last reader lets go of them
+    std::map<std::pair<std::string, std::string>, CVertexSelector*> VertexSelectors;
 
     // std::map<std::string, std::pair<CMeshInstancePoint*, uint32_t>> PickingVerts; Randy commented out on 10/10 . I dont think it does anything???
     std::set<std::string> CurrSelectedVerts; // unique verts
@@ -170,11 +291,16 @@ public:
     {
         VI.Name = resultName;
     }
+    ~CVertexSelector() override;
 
     std::string GetPath() const;
 
 private:
+    friend class CMeshInstance;
+
     std::string TargetName;
+    // The instance listing this selector, it stays alive for as long as MeshInstance is connected
+    CMeshInstance* Instance = nullptr;
 
     CVertexInfo VI;
 };
@@ -0,0 +1,145 @@
+#include "MeshExporter.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+bool CMeshExporter::Export(const CMeshImpl& mesh, const std::string& path)
+{
+    auto dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+    for (auto& c : ext)
+        c = static_cast<char>(tolower(c));
+
+    if (ext == "obj")
+        return WriteObj(mesh, path);
+    if (ext == "ply")
+        return WritePly(mesh, path);
+    if (ext == "stl")
+        return WriteStl(mesh, path);
+    printf("Unknown export format for %s, expected .obj, .ply or .stl\n", path.c_str());
+    return false;
+}
+
+bool CMeshExporter::WriteObj(const CMeshImpl& mesh, const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    // Enough digits that reading the text back gives the same floats
+    file << std::setprecision(std::numeric_limits<float>::max_digits10);
+
+    file << "# Exported by Nome\n";
+    for (auto v : mesh.vertices())
+    {
+        const auto& p = mesh.point(v);
+        file << "v " << p[0] << " " << p[1] << " " << p[2] << "\n";
+    }
+    // Vertex indices are 1-based and must skip deleted vertices, like the loop above
+    std::vector<int> objIndex(mesh.n_vertices(), 0);
+    int next = 1;
+    for (auto v : mesh.vertices())
+        objIndex[v.idx()] = next++;
+    for (auto f : mesh.faces())
+    {
+        file << "f";
+        for (auto v : mesh.fv_range(f))
+            file << " " << objIndex[v.idx()];
+        file << "\n";
+    }
+    return file.good();
+}
+
+bool CMeshExporter::WritePly(const CMeshImpl& mesh, const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    // Enough digits that reading the text back gives the same floats
+    file << std::setprecision(std::numeric_limits<float>::max_digits10);
+
+    std::vector<int> plyIndex(mesh.n_vertices(), 0);
+    int numVerts = 0;
+    for (auto v : mesh.vertices())
+        plyIndex[v.idx()] = numVerts++;
+    auto numFaces = std::distance(mesh.faces_sbegin(), mesh.faces_end());
+
+    file << "ply\nformat ascii 1.0\ncomment Exported by Nome\n";
+    file << "element vertex " << numVerts << "\n";
+    file << "property float x\nproperty float y\nproperty float z\n";
+    file << "element face " << numFaces << "\n";
+    file << "property list uchar int vertex_indices\nend_header\n";
+    for (auto v : mesh.vertices())
+    {
+        const auto& p = mesh.point(v);
+        file << p[0] << " " << p[1] << " " << p[2] << "\n";
+    }
+    for (auto f : mesh.faces())
+    {
+        file << mesh.valence(f);
+        for (auto v : mesh.fv_range(f))
+            file << " " << plyIndex[v.idx()];
+        file << "\n";
+    }
+    return file.good();
+}
+
+bool CMeshExporter::WriteStl(const CMeshImpl& mesh, const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    // Fixed layout of a binary STL triangle record: normal, three corners, attribute count
+    struct CTriangle
+    {
+        float Data[12];
+    };
+    std::vector<CTriangle> triangles;
+    std::vector<CMeshImpl::Point> corners;
+    for (auto f : mesh.faces())
+    {
+        corners.clear();
+        for (auto v : mesh.fv_range(f))
+            corners.push_back(mesh.point(v));
+        for (size_t i = 2; i < corners.size(); i++)
+        {
+            const auto& a = corners[0];
+            const auto& b = corners[i - 1];
+            const auto& c = corners[i];
+            auto normal = (b - a) % (c - a);
+            auto length = normal.length();
+            if (length > 0.0f)
+                normal /= length;
+
+            CTriangle tri {};
+            const CMeshImpl::Point* points[] = { &normal, &a, &b, &c };
+            for (int j = 0; j < 4; j++)
+                for (int k = 0; k < 3; k++)
+                    tri.Data[j * 3 + k] = (*points[j])[k];
+            triangles.push_back(tri);
+        }
+    }
+
+    char header[80] = "Exported by Nome";
+    file.write(header, sizeof(header));
+    auto count = static_cast<uint32_t>(triangles.size());
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    const uint16_t attributes = 0;
+    for (const auto& tri : triangles)
+    {
+        file.write(reinterpret_cast<const char*>(tri.Data), sizeof(tri.Data));
+        file.write(reinterpret_cast<const char*>(&attributes), sizeof(attributes));
+    }
+    return file.good();
+}
+
+}
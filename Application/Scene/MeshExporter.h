@@ -0,0 +1,21 @@
+#pragma once
+#include "Mesh.h"
+
+namespace Nome::Scene
+{
+
+// Writes polygon meshes to common interchange formats
+class CMeshExporter
+{
+public:
+    // Picks the format from the extension of path: .obj, .ply or .stl
+    static bool Export(const CMeshImpl& mesh, const std::string& path);
+
+    static bool WriteObj(const CMeshImpl& mesh, const std::string& path);
+    // ASCII PLY, faces stay polygons
+    static bool WritePly(const CMeshImpl& mesh, const std::string& path);
+    // Binary STL, faces are fan triangulated
+    static bool WriteStl(const CMeshImpl& mesh, const std::string& path);
+};
+
+}
@@ -1,5 +1,7 @@
 #include "MeshMerger.h"
+#include "Subdivision.h"
 
+#include <cmath>
 #include <unordered_map>
 
 namespace Nome::Scene
@@ -7,6 +9,8 @@ namespace Nome::Scene
 
 inline static const float Epsilon = 0.01f;
 
+static int ToGridCell(float coord) { return static_cast<int>(std::floor(coord / Epsilon)); }
+
 void CMeshMerger::UpdateEntity()
 {
     if (!IsDirty())
@@ -20,14 +24,11 @@ void CMeshMerger::UpdateEntity()
 
 void CMeshMerger::Catmull(const CMeshInstance& meshInstance)
 {
-
-    OpenMesh::Subdivider::Uniform::CatmullClarkT<CMeshImpl> catmull; // https://www.graphics.rwth-aachen.de/media/openmesh_static/Documentations/OpenMesh-4.0-Documentation/a00020.html
     // Execute 2 subdivision steps
     CMeshImpl otherMesh = meshInstance.GetMeshImpl();
-    catmull.attach(otherMesh);
-    std::cout << "Apply catmullclark subdivision, may take a few minutes or so" << std::endl;
-    catmull(2);
-    catmull.detach();
+    auto& data = EditData();
+    CCatmullClark subdivider;
+    CSubdivision::Subdivide(otherMesh, 2, subdivider);
     auto tf = meshInstance.GetSceneTreeNode()->L2WTransform.GetValue(tc::Matrix3x4::IDENTITY); // The transformation matrix is the identity matrix by default
     // Copy over all the vertices and check for overlapping
     std::unordered_map<CMeshImpl::VertexHandle, CMeshImpl::VertexHandle> vertMap;
@@ -35,7 +36,6 @@ void CMeshMerger::Catmull(const CMeshInstance& meshInstance)
     float minY = std::numeric_limits<double>::infinity();
     for (auto vi = otherMesh.vertices_begin(); vi != otherMesh.vertices_end(); ++vi)
     {
-        std::cout << vi->idx() << std::endl;
         const auto& posArray = otherMesh.point(*vi);
         Vector3 localPos = Vector3(posArray[0], posArray[1], posArray[2]);
         Vector3 worldPos = tf * localPos;
@@ -46,7 +46,6 @@ void CMeshMerger::Catmull(const CMeshInstance& meshInstance)
          ++vi) // Iterate through all the vertices in the mesh (the non-merger mesh, aka the one
                // you're trying copy vertices from)
     {
-        std::cout << vi->idx() << std::endl;
         const auto& posArray = otherMesh.point(*vi);
         Vector3 localPos = Vector3(posArray[0], posArray[1],
                                    posArray[2]);
@@ -59,10 +58,9 @@ void CMeshMerger::Catmull(const CMeshInstance& meshInstance)
             vertMap[*vi] = closestVert;
         }*/
         //else
-        auto vnew = Mesh.add_vertex({ worldPos.x, worldPos.y + (maxY - minY) + 10, worldPos.z}); 
+        auto vnew = AddMergedVertex({ worldPos.x, worldPos.y + (maxY - minY) + 10, worldPos.z });
         vertMap[*vi] = vnew;
-        std::string vName = "v" + std::to_string(VertCount); 
-        NameToVert.insert({ vName, vnew }); 
+        data.VertNames.Add(CGridName("v", VertCount), vnew.idx());
         ++VertCount;
         
     }
@@ -71,17 +69,14 @@ void CMeshMerger::Catmull(const CMeshInstance& meshInstance)
     for (auto fi = otherMesh.faces_begin(); fi != otherMesh.faces_end();
          ++fi) 
     {
-        std::cout << fi->idx() << std::endl;
         std::vector<CMeshImpl::VertexHandle> verts;
         for (auto vert : otherMesh.fv_range(*fi))
             verts.emplace_back(vertMap[vert]); 
                                             
         auto fnew =
-            Mesh.add_face(verts); 
-        std::string fName = "v" + std::to_string(FaceCount);
-        NameToFace.insert(
-            { fName,
-              fnew }); 
+            data.Mesh.add_face(verts); 
+        if (fnew.is_valid())
+            data.FaceNames.Add(CGridName("v", FaceCount), fnew.idx());
         FaceCount++;
     }
 }
@@ -89,6 +84,7 @@ void CMeshMerger::Catmull(const CMeshInstance& meshInstance)
 void CMeshMerger::MergeIn(const CMeshInstance& meshInstance)
 {
     auto tf = meshInstance.GetSceneTreeNode()->L2WTransform.GetValue(tc::Matrix3x4::IDENTITY); // The transformation matrix is the identity matrix by default
+    auto& data = EditData();
     const auto& otherMesh = meshInstance.GetMeshImpl(); // Getting OpeshMesh implementation of a mesh. This allows us to traverse the mesh's vertices/faces
 
     // Copy over all the vertices and check for overlapping
@@ -106,10 +102,9 @@ void CMeshMerger::MergeIn(const CMeshInstance& meshInstance)
         }
         else // Else, we haven't added a vertex at this location yet. So lets add_vertex to the merger mesh.
         {
-            auto vnew = Mesh.add_vertex({ worldPos.x, worldPos.y, worldPos.z }); // This adds a new vertex. Notice, we are passing in coordinates here, but it actually returns a vertex handle (essentially, a pointer to this vertex.
+            auto vnew = AddMergedVertex(worldPos); // This adds a new vertex. Notice, we are passing in coordinates here, but it actually returns a vertex handle (essentially, a pointer to this vertex.
             vertMap[*vi] = vnew; // Map actual mesh vertex to merged vertex.This dictionary is useful for add face later.
-            std::string vName = "v" + std::to_string(VertCount); // we of course need a name for this new vertex handle       
-            NameToVert.insert({ vName, vnew }); // Add new merged vertex into NameToVert. This is if there wa sa floating point error above so we need to add an entirely new vertex + position ?
+            data.VertNames.Add(CGridName("v", VertCount), vnew.idx()); // we of course need a name for this new vertex handle. Named "v<VertCount>", resolved arithmetically
             ++VertCount; // VertCount is an attribute for this merger mesh. Starts at 0.
         }
     }
@@ -120,9 +115,9 @@ void CMeshMerger::MergeIn(const CMeshInstance& meshInstance)
         std::vector<CMeshImpl::VertexHandle> verts;
         for (auto vert : otherMesh.fv_range(*fi)) // iterate through all the vertices on this face 
             verts.emplace_back(vertMap[vert]); // Add the vertice handles from above. In most cases, it will match the actual mesh's? Unless there is a floating point precision error?
-        auto fnew = Mesh.add_face(verts); // add_face processes the merger vertex handles and adds the face into the merger mesh (Mesh refers to the merger mesh here)
-        std::string fName = "v" + std::to_string(FaceCount);
-        NameToFace.insert({ fName, fnew }); // We add a new face in the same location as the actual mesh's face. This means if we adjust the actual mesh's parameters using a slider, you'll see the merger mesh in the actual mesh's original location
+        auto fnew = data.Mesh.add_face(verts); // add_face processes the merger vertex handles and adds the face into the merger mesh (Mesh refers to the merger mesh here)
+        if (fnew.is_valid()) // We add a new face in the same location as the actual mesh's face. This means if we adjust the actual mesh's parameters using a slider, you'll see the merger mesh in the actual mesh's original location
+            data.FaceNames.Add(CGridName("v", FaceCount), fnew.idx());
         FaceCount++;
     }
 }
@@ -132,19 +127,43 @@ std::pair<CMeshImpl::VertexHandle, float> CMeshMerger::FindClosestVertex(const t
 {
     CMeshImpl::VertexHandle result;
     float minDist = std::numeric_limits<float>::max();
-    // TODO: linear search for the time being
-    for (const auto& v : Mesh.vertices())
-    {
-        const auto& point = Mesh.point(v);
-        Vector3 pp = Vector3(point[0], point[1], point[2]);
-        float dist = pos.DistanceToPoint(pp);
-        if (dist < minDist)
-        {
-            minDist = dist;
-            result = v;
-        }
-    }
+    // Cells are epsilon wide, so any vertex within epsilon sits in one of the 27 surrounding cells
+    const auto& mesh = GetData().Mesh;
+    int cx = ToGridCell(pos.x), cy = ToGridCell(pos.y), cz = ToGridCell(pos.z);
+    for (int x = cx - 1; x <= cx + 1; x++)
+        for (int y = cy - 1; y <= cy + 1; y++)
+            for (int z = cz - 1; z <= cz + 1; z++)
+            {
+                auto cell = VertexGrid.find(GridKey(x, y, z));
+                if (cell == VertexGrid.end())
+                    continue;
+                for (const auto& v : cell->second)
+                {
+                    const auto& point = mesh.point(v);
+                    Vector3 pp = Vector3(point[0], point[1], point[2]);
+                    float dist = pos.DistanceToPoint(pp);
+                    if (dist < minDist)
+                    {
+                        minDist = dist;
+                        result = v;
+                    }
+                }
+            }
     return { result, minDist };
 }
 
+CMeshImpl::VertexHandle CMeshMerger::AddMergedVertex(const tc::Vector3& pos)
+{
+    auto vnew = EditData().Mesh.add_vertex({ pos.x, pos.y, pos.z });
+    VertexGrid[GridKey(ToGridCell(pos.x), ToGridCell(pos.y), ToGridCell(pos.z))].push_back(vnew);
+    return vnew;
+}
+
+uint64_t CMeshMerger::GridKey(int x, int y, int z)
+{
+    // 21 bits per axis, far away cells may alias but the distance check above sorts that out
+    const uint64_t mask = (1u << 21) - 1;
+    return ((uint64_t(x) & mask) << 42) | ((uint64_t(y) & mask) << 21) | (uint64_t(z) & mask);
+}
+
 }
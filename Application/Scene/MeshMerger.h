@@ -1,7 +1,8 @@
 #pragma once
 #include "Mesh.h"
 #include <LangUtils.h>
-#include <OpenMesh/Tools/Subdivider/Uniform/CatmullClarkT.hh>
+#include <unordered_map>
+#include <vector>
 namespace Nome::Scene
 {
 
@@ -20,14 +21,25 @@ public:
     // No update yet, please just use one time
     void MergeIn(const CMeshInstance& meshInstance);
 
-    // Buggy, preset to 3 subdivision steps
+    // Preset to 2 subdivision steps
     void Catmull(const CMeshInstance& meshInstance);
 
+    // The merged mesh in world space, e.g. for exporting
+    const CMeshImpl& GetMeshImpl() const { return GetData().Mesh; }
+
 private:
+    // Only looks at the grid cells around pos, so anything farther than the merge epsilon may be
+    //  missed. Returns an invalid handle and float max if nothing is close.
     std::pair<CMeshImpl::VertexHandle, float> FindClosestVertex(const tc::Vector3& pos);
+    CMeshImpl::VertexHandle AddMergedVertex(const tc::Vector3& pos);
+
+    static uint64_t GridKey(int x, int y, int z);
 
     unsigned int VertCount = 0;
     unsigned int FaceCount = 0;
+
+    // Spatial hash over the merged vertices, cells are one epsilon wide
+    std::unordered_map<uint64_t, std::vector<CMeshImpl::VertexHandle>> VertexGrid;
 };
 
 }
@@ -21,9 +21,15 @@ void CMobiusStrip::UpdateEntity()
         return;
 
     Super::UpdateEntity();
+    GenerateMesh();
+}
 
+void CMobiusStrip::GenerateMesh()
+{
     // load in arguments to Mobius Strip generator
     float n = (float)N.GetValue(100.0f); // number of individual points on each band
+    if (GetLODLevel() > 0) // the center line is a unit circle, n points cover half of it
+        n = (float)GetLODSegments((int)n, 1.0f, (float)tc::M_PI);
     float radius = (float)Radius.GetValue(1.0f); // total radius
     int numTwists = (int)ceil(NumTwists.GetValue(1.0f)); // number of twists
     int numCuts = (int)ceil(NumCuts.GetValue(0.0f)); // number of times surface is cut
@@ -40,7 +46,7 @@ void CMobiusStrip::UpdateEntity()
             float x = (1+(v/2.0f)*cosf((numTwists*u)/2.0f))*cosf(u);
             float y = (1+(v/2.0f)*cosf((numTwists*u)/2.0f))*sinf(u);
             float z = (v/2.0f)*sinf((numTwists*u)/2.0f);
-            AddVertex("v_" + std::to_string(uCounter) + "_" + std::to_string(vCounter), // name ex. "v_0_5"
+            AddVertex(CGridName("v_", uCounter, "_", vCounter), // name ex. "v_0_5"
                       { x, y, z } );
             vCounter++;
         }
@@ -52,14 +58,14 @@ void CMobiusStrip::UpdateEntity()
     {
         for (int cut = 0; cut <= numCuts; cut++)
         {
-            std::vector<std::string> face;
+            std::vector<CGridName> face;
 
-            face.push_back("v_" + std::to_string(uFaceCounter) + "_" + std::to_string(2*cut)); //2*cut
-            face.push_back("v_" + std::to_string(uFaceCounter + 1) + "_" + std::to_string(2*cut));
-            face.push_back("v_" + std::to_string(uFaceCounter + 1) + "_" + std::to_string(2*cut+1)); //2*cut+1
-            face.push_back("v_" + std::to_string(uFaceCounter) + "_" + std::to_string(2*cut+1));
+            face.push_back(CGridName("v_", uFaceCounter, "_", 2*cut)); //2*cut
+            face.push_back(CGridName("v_", uFaceCounter + 1, "_", 2*cut));
+            face.push_back(CGridName("v_", uFaceCounter + 1, "_", 2*cut+1)); //2*cut+1
+            face.push_back(CGridName("v_", uFaceCounter, "_", 2*cut+1));
 
-            AddFace("f1_" + std::to_string(uFaceCounter) + "_" + std::to_string(cut), face);
+            AddFace(CGridName("f1_", uFaceCounter, "_", cut), face);
         }
     }
 }
@@ -20,6 +20,10 @@ public:
     }
 
     void UpdateEntity() override;
+    bool HasLODs() const override { return true; }
+
+protected:
+    void GenerateMesh() override;
 
 private:
     // ...
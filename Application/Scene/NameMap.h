@@ -0,0 +1,235 @@
+#pragma once
+#include <CompileTimeHash.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+// Maps names to values through an open addressing hash table. Every name is given an id that
+//  stays the same for as long as it is in the map. Operations on all names starting with some
+//  prefix go through a list of ids sorted by name, which is only re-sorted when something was
+//  added since the last such operation.
+template <typename TValue> class TNameMap
+{
+public:
+    static constexpr uint32_t InvalidId = UINT32_MAX;
+
+    // Same as the _hash literal, so names known at compile time can be hashed there
+    static uint32_t Hash(std::string_view name)
+    {
+        uint32_t hash = 0;
+        for (char c : name)
+            hash = tc::SDBMHashChar(hash, static_cast<unsigned char>(c));
+        return hash;
+    }
+
+    [[nodiscard]] uint32_t Find(std::string_view name) const
+    {
+        if (Slots.empty())
+            return InvalidId;
+        uint32_t hash = Hash(name);
+        for (size_t slot = GetHome(hash);; slot = (slot + 1) & (Slots.size() - 1))
+        {
+            uint32_t id = Slots[slot];
+            if (id == EmptySlot)
+                return InvalidId;
+            if (id != DeletedSlot && Entries[id].Hash == hash && Entries[id].Name == name)
+                return id;
+        }
+    }
+
+    // Null if there is no such name
+    [[nodiscard]] const TValue* FindValue(std::string_view name) const
+    {
+        uint32_t id = Find(name);
+        return id == InvalidId ? nullptr : &Entries[id].Value;
+    }
+
+    // Replaces the value if name is already there, its id stays the same then
+    uint32_t Insert(std::string name, TValue value)
+    {
+        uint32_t id = Find(name);
+        if (id != InvalidId)
+        {
+            Entries[id].Value = std::move(value);
+            return id;
+        }
+        if (FreeIds.empty())
+        {
+            id = static_cast<uint32_t>(Entries.size());
+            Entries.emplace_back();
+        }
+        else
+        {
+            // Still in the sorted list under its old name
+            id = FreeIds.back();
+            FreeIds.pop_back();
+            bSortedDirty = true;
+        }
+        auto& entry = Entries[id];
+        entry.Name = std::move(name);
+        entry.Hash = Hash(entry.Name);
+        entry.Value = std::move(value);
+        entry.bAlive = true;
+        AddToSlots(id);
+        // Names added in order keep the list sorted, otherwise it is rebuilt when next needed
+        if (!bSortedDirty && !SortedIds.empty() && Entries[SortedIds.back()].Name >= entry.Name)
+            bSortedDirty = true;
+        if (!bSortedDirty)
+            SortedIds.push_back(id);
+        return id;
+    }
+
+    bool Erase(std::string_view name)
+    {
+        uint32_t id = Find(name);
+        if (id == InvalidId)
+            return false;
+        EraseId(id);
+        return true;
+    }
+
+    void EraseId(uint32_t id)
+    {
+        RemoveFromSlots(id);
+        // The name stays, it is still where the sorted list has the id
+        Entries[id].Value = TValue();
+        Entries[id].bAlive = false;
+        FreeIds.push_back(id);
+    }
+
+    // Fails if newName is taken
+    bool Rename(uint32_t id, std::string newName)
+    {
+        if (Find(newName) != InvalidId)
+            return false;
+        RemoveFromSlots(id);
+        Entries[id].Name = std::move(newName);
+        Entries[id].Hash = Hash(Entries[id].Name);
+        AddToSlots(id);
+        bSortedDirty = true;
+        return true;
+    }
+
+    [[nodiscard]] const std::string& GetName(uint32_t id) const { return Entries[id].Name; }
+    [[nodiscard]] const TValue& GetValue(uint32_t id) const { return Entries[id].Value; }
+    [[nodiscard]] size_t GetSize() const { return Entries.size() - FreeIds.size(); }
+
+    // Ids of every name starting with prefix, in name order
+    [[nodiscard]] std::vector<uint32_t> FindWithPrefix(std::string_view prefix) const
+    {
+        SortIds();
+        auto iter = std::lower_bound(
+            SortedIds.begin(), SortedIds.end(), prefix,
+            [this](uint32_t id, std::string_view name) { return Entries[id].Name < name; });
+        std::vector<uint32_t> result;
+        for (; iter != SortedIds.end(); ++iter)
+        {
+            const auto& entry = Entries[*iter];
+            if (entry.Name.compare(0, prefix.size(), prefix) != 0)
+                break;
+            if (entry.bAlive)
+                result.push_back(*iter);
+        }
+        return result;
+    }
+
+    // In no particular order, func must not change the map
+    template <typename TFunc> void ForEach(const TFunc& func) const
+    {
+        for (const auto& entry : Entries)
+            if (entry.bAlive)
+                func(entry.Name, entry.Value);
+    }
+
+private:
+    static constexpr uint32_t EmptySlot = UINT32_MAX;
+    static constexpr uint32_t DeletedSlot = UINT32_MAX - 1;
+
+    struct CEntry
+    {
+        std::string Name;
+        uint32_t Hash = 0;
+        bool bAlive = false;
+        TValue Value {};
+    };
+
+    size_t GetHome(uint32_t hash) const
+    {
+        // SDBM leaves the low bits poorly mixed, take the high ones of a Fibonacci product
+        uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed >> 32) & (Slots.size() - 1);
+    }
+
+    void AddToSlots(uint32_t id)
+    {
+        // At most 70 percent full, deleted slots included
+        if ((NumUsedSlots + 1) * 10 > Slots.size() * 7)
+        {
+            // Places every live entry, this one included
+            Rehash();
+            return;
+        }
+        size_t slot = GetHome(Entries[id].Hash);
+        while (Slots[slot] != EmptySlot && Slots[slot] != DeletedSlot)
+            slot = (slot + 1) & (Slots.size() - 1);
+        if (Slots[slot] == EmptySlot)
+            NumUsedSlots++;
+        Slots[slot] = id;
+    }
+
+    void RemoveFromSlots(uint32_t id)
+    {
+        size_t slot = GetHome(Entries[id].Hash);
+        while (Slots[slot] != id)
+            slot = (slot + 1) & (Slots.size() - 1);
+        Slots[slot] = DeletedSlot;
+    }
+
+    void Rehash()
+    {
+        size_t capacity = 16;
+        while (GetSize() * 10 >= capacity * 4)
+            capacity *= 2;
+        Slots.assign(capacity, EmptySlot);
+        NumUsedSlots = 0;
+        for (uint32_t id = 0; id < Entries.size(); id++)
+        {
+            if (!Entries[id].bAlive)
+                continue;
+            size_t slot = GetHome(Entries[id].Hash);
+            while (Slots[slot] != EmptySlot)
+                slot = (slot + 1) & (Slots.size() - 1);
+            Slots[slot] = id;
+            NumUsedSlots++;
+        }
+    }
+
+    void SortIds() const
+    {
+        if (!bSortedDirty)
+            return;
+        SortedIds.clear();
+        for (uint32_t id = 0; id < Entries.size(); id++)
+            if (Entries[id].bAlive)
+                SortedIds.push_back(id);
+        std::sort(SortedIds.begin(), SortedIds.end(), [this](uint32_t lhs, uint32_t rhs) {
+            return Entries[lhs].Name < Entries[rhs].Name;
+        });
+        bSortedDirty = false;
+    }
+
+    std::vector<CEntry> Entries;
+    std::vector<uint32_t> FreeIds;
+    std::vector<uint32_t> Slots;
+    size_t NumUsedSlots = 0;
+    mutable std::vector<uint32_t> SortedIds;
+    mutable bool bSortedDirty = false;
+};
+
+}
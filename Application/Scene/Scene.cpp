@@ -1,4 +1,5 @@
 #include "Scene.h"
+#include "EntityUpdateGraph.h"
 #include "InteractivePoint.h"
 #include "Mesh.h"
 #include <StringUtils.h>
@@ -6,6 +7,23 @@
 namespace Nome::Scene
 {
 
+namespace
+{
+
+// If the node has only 1 child, it might be a group instance
+CSceneTreeNode* SkipGroupInstance(CSceneTreeNode* node)
+{
+    if (node->GetChildren().size() == 1)
+    {
+        CSceneTreeNode* onlyChild = *node->GetChildren().begin();
+        if (onlyChild->GetOwner()->IsGroup())
+            return onlyChild;
+    }
+    return node;
+}
+
+}
+
 CScene::CScene()
 {
     RootNode = new CSceneNode(this, "root", true);
@@ -21,84 +39,77 @@ TAutoPtr<CSceneTreeNode> CScene::GetRootTreeNode() const
 
 void CScene::AddEntity(TAutoPtr<CEntity> entity)
 {
-    auto iter = EntityLibrary.find(entity->GetName());
-    if (iter != EntityLibrary.end())
-        EntityLibrary.erase(iter);
-    EntityLibrary.insert(std::make_pair(entity->GetName(), std::move(entity)));
+    auto name = entity->GetName();
+    EntityLibrary.Insert(std::move(name), std::move(entity));
 }
 
 void CScene::RemoveEntity(const std::string& name, bool bAlsoRemoveChildren)
 {
-    auto iter = EntityLibrary.find(name);
-    if (iter != EntityLibrary.end())
-    {
-        if (bAlsoRemoveChildren)
-            while (tc::FStringUtils::StartsWith(iter->first, name))
-                EntityLibrary.erase(iter++);
-        else
-            EntityLibrary.erase(iter);
-    }
+    if (EntityLibrary.Find(name) == EntityLibrary.InvalidId)
+        return;
+    if (bAlsoRemoveChildren)
+        for (uint32_t id : EntityLibrary.FindWithPrefix(name))
+            EntityLibrary.EraseId(id);
+    else
+        EntityLibrary.Erase(name);
 }
 
 bool CScene::RenameEntity(const std::string& oldName, const std::string& newName)
 {
     // New name already exists
-    if (EntityLibrary.find(newName) != EntityLibrary.end())
+    if (EntityLibrary.Find(newName) != EntityLibrary.InvalidId)
         return false;
 
     // If entity with oldName not found
-    auto iter = EntityLibrary.find(oldName);
-    if (iter == EntityLibrary.end())
+    if (EntityLibrary.Find(oldName) == EntityLibrary.InvalidId)
         return false;
 
-    while (tc::FStringUtils::StartsWith(iter->first, oldName))
+    for (uint32_t id : EntityLibrary.FindWithPrefix(oldName))
     {
-        auto nh = EntityLibrary.extract(iter++);
-        nh.key() = newName + nh.key().substr(oldName.length());
-        nh.mapped()->SetName(nh.key());
-        EntityLibrary.insert(std::move(nh));
+        auto renamed = newName + EntityLibrary.GetName(id).substr(oldName.length());
+        if (EntityLibrary.Rename(id, renamed))
+            EntityLibrary.GetValue(id)->SetName(renamed);
     }
     return true;
 }
 
 TAutoPtr<CEntity> CScene::FindEntity(const std::string& name) const
 {
-    auto iter = EntityLibrary.find(name);
-    if (iter != EntityLibrary.end())
-        return iter->second;
-    return nullptr;
+    const auto* entity = EntityLibrary.FindValue(name);
+    return entity ? *entity : nullptr;
 }
 
 TAutoPtr<CSceneNode> CScene::CreateGroup(const std::string& name)
 {
-    if (Groups.find(name) != Groups.end())
+    if (Groups.Find(name) != Groups.InvalidId)
         return {};
 
     auto* node = new CSceneNode(this, name, false, true);
-    Groups[name] = node;
+    Groups.Insert(name, node);
     return node;
 }
 
 TAutoPtr<CSceneNode> CScene::FindGroup(const std::string& name) const
 {
-    auto iter = Groups.find(name);
-    if (iter != Groups.end())
-        return iter->second;
-    return nullptr;
+    const auto* group = Groups.FindValue(name);
+    return group ? *group : nullptr;
 }
 
 Flow::TOutput<CVertexInfo*>* CScene::FindPointOutput(const std::string& id) const
 {
-    auto iter = EntityLibrary.find(id);
-    if (iter != EntityLibrary.end())
-    {
-        TAutoPtr<CEntity> ent = iter->second;
-        TAutoPtr<CPoint> point = dynamic_cast<CPoint*>(ent.Get());
-        if (point)
-        {
+    if (const auto* entity = EntityLibrary.FindValue(id))
+        if (auto* point = dynamic_cast<CPoint*>(entity->Get()))
             return &point->Point;
-        }
+
+    if (ResolvedVersion != StructureVersion)
+    {
+        ResolvedPoints.clear();
+        ResolvedTreeNodes.clear();
+        ResolvedVersion = StructureVersion;
     }
+    auto resolved = ResolvedPoints.find(id);
+    if (resolved != ResolvedPoints.end())
+        return resolved->second.Output;
 
     size_t charsToIgnore = 0;
     if (id[0] == '.')
@@ -111,8 +122,19 @@ Flow::TOutput<CVertexInfo*>* CScene::FindPointOutput(const std::string& id) cons
         size_t nextDot = id.find('.', charsToIgnore);
         if (nextDot != std::string::npos)
         {
-            std::string nextSeg = id.substr(charsToIgnore, nextDot - charsToIgnore);
-            nextNode = currNode->FindChild(nextSeg);
+            auto key = id.substr(0, nextDot);
+            auto iter = ResolvedTreeNodes.find(key);
+            if (iter == ResolvedTreeNodes.end())
+            {
+                // All children at once, references tend to go to many siblings. The first child
+                //  of a name wins, as with FindChild.
+                auto parentPrefix = id.substr(0, charsToIgnore);
+                for (CSceneTreeNode* child : currNode->GetChildren())
+                    ResolvedTreeNodes.try_emplace(parentPrefix + child->GetOwner()->GetName(),
+                                                  SkipGroupInstance(child));
+                iter = ResolvedTreeNodes.try_emplace(std::move(key), nullptr).first;
+            }
+            nextNode = iter->second;
         }
 
         if (!nextNode)
@@ -123,22 +145,15 @@ Flow::TOutput<CVertexInfo*>* CScene::FindPointOutput(const std::string& id) cons
                 std::replace(idTurnedVertName.begin(), idTurnedVertName.end(), '.', '_');
                 auto* point =
                     meshInstance->CreateVertexSelector(id.substr(charsToIgnore), idTurnedVertName);
-                if (point)
-                    return &point->Point;
-                else
+                if (!point)
                     return nullptr;
+                ResolvedPoints.emplace(id, CResolvedPoint { point, &point->Point });
+                return &point->Point;
             }
             else
                 return nullptr;
         }
         currNode = nextNode;
-        // If the current node has only 1 child, it might be a group instance
-        if (currNode->GetChildren().size() == 1)
-        {
-            CSceneTreeNode* onlyChild = *currNode->GetChildren().begin();
-            if (onlyChild->GetOwner()->IsGroup())
-                currNode = onlyChild;
-        }
         charsToIgnore = nextDot + 1;
     }
     return nullptr;
@@ -169,27 +184,49 @@ std::pair<CSceneTreeNode*, std::string> CScene::WalkPath(const std::string& path
     return { currNode, tc::FStringUtils::Combine(iter, pathComps.end(), ".") };
 }
 
-void DFSTreeNodeUpdate(CSceneTreeNode* treeNode)
+void CScene::EnqueueDirtyTreeNode(CSceneTreeNode* treeNode)
 {
-    treeNode->L2WTransform.Update();
-
-    const auto& childNodes = treeNode->GetChildren();
-    for (CSceneTreeNode* child : childNodes)
-        DFSTreeNodeUpdate(child);
-
-    if (auto* ent = treeNode->GetEntity())
-    {
-        // Update the instance entity
-        if (ent->IsDirty())
-            treeNode->SetEntityUpdated(true);
-        ent->UpdateEntity();
-    }
+    std::lock_guard<std::mutex> lock(DirtyTreeNodesLock);
+    if (treeNode->bQueuedForUpdate)
+        return;
+    treeNode->bQueuedForUpdate = true;
+    DirtyTreeNodes.emplace_back(treeNode);
 }
 
 void CScene::Update()
 {
-    // Called every frame to make sure everything is up to date
-    DFSTreeNodeUpdate(GetRootTreeNode());
+    // Called every frame, only the queued tree nodes are visited. Nodes dirtied while updating
+    // are picked up next frame.
+    std::vector<TAutoPtr<CSceneTreeNode>> queued;
+    {
+        std::lock_guard<std::mutex> lock(DirtyTreeNodesLock);
+        queued.swap(DirtyTreeNodes);
+        for (auto& treeNode : queued)
+            treeNode->bQueuedForUpdate = false;
+    }
+    UpdatedTreeNodes.clear();
+    for (auto& treeNode : queued)
+    {
+        // Skip nodes removed from the tree since they were queued
+        if (treeNode->IsValid())
+            UpdatedTreeNodes.push_back(std::move(treeNode));
+    }
+
+    // An entity can be shared by several tree nodes, so record dirtiness before updating any
+    for (auto& treeNode : UpdatedTreeNodes)
+        if (auto* ent = treeNode->GetEntity())
+            if (ent->IsDirty())
+                treeNode->bEntityUpdated = true;
+
+    // Transforms are cheap, entity regeneration is farmed out to the thread pool
+    CEntityUpdateGraph updateGraph;
+    for (auto& treeNode : UpdatedTreeNodes)
+    {
+        treeNode->L2WTransform.Update();
+        if (auto* ent = treeNode->GetEntity())
+            updateGraph.AddEntity(ent);
+    }
+    updateGraph.Run(tc::FThreadPool::Get());
 }
 
 std::vector<CSceneTreeNode*> CScene::GetSelectedNodes() const
@@ -1,10 +1,13 @@
 #pragma once
 #include "BankAndSet.h"
 #include "Entity.h"
+#include "NameMap.h"
 #include "Point.h"
 #include "SceneGraph.h"
 #include <Color.h>
+#include <mutex>
 #include <queue>
+#include <unordered_map>
 #include <utility>
 
 namespace Nome
@@ -33,19 +36,41 @@ public:
     // Finds an entity by its name
     TAutoPtr<CEntity> FindEntity(const std::string& name) const;
 
+    template <typename TFunc> void ForEachEntity(const TFunc& func) const
+    {
+        EntityLibrary.ForEach([&](const std::string& name, const TAutoPtr<CEntity>& entity) {
+            func(name, entity.Get());
+        });
+    }
+
     // Creates a group that is represented by a scene node with the specified name
     TAutoPtr<CSceneNode> CreateGroup(const std::string& name);
     // Finds a group by its name
     TAutoPtr<CSceneNode> FindGroup(const std::string& name) const;
+    void RemoveGroup(const std::string& name) { Groups.Erase(name); }
 
-    // Locate in the scene a point output (could be a point or a mesh vertex) by its path
+    // Locate in the scene a point output (could be a point or a mesh vertex) by its path. Paths
+    //  into the scene tree are remembered until its structure changes.
     Flow::TOutput<CVertexInfo*>* FindPointOutput(const std::string& id) const;
 
     /// Walks the scene tree along a path, return the last matching node and the rest of path
     std::pair<CSceneTreeNode*, std::string> WalkPath(const std::string& path) const;
 
+    // Brings every queued tree node up to date, called once per frame
     void Update();
 
+    /// Tree nodes whose transform or entity was refreshed by the last Update()
+    const std::vector<TAutoPtr<CSceneTreeNode>>& GetUpdatedTreeNodes() const
+    {
+        return UpdatedTreeNodes;
+    }
+    /// Bumped whenever tree nodes are created, removed or change entity
+    uint64_t GetStructureVersion() const { return StructureVersion; }
+
+    // Used by the scene graph, use CSceneTreeNode::MarkForUpdate instead
+    void EnqueueDirtyTreeNode(CSceneTreeNode* treeNode);
+    void BumpStructureVersion() { ++StructureVersion; }
+
     template <typename TFunc> void ForEachSceneTreeNode(const TFunc& func) const
     {
         std::queue<CSceneTreeNode*> q;
@@ -87,8 +112,27 @@ private:
     Flow::CFloatNumber* frame = new Flow::CFloatNumber(0.0f);
     // Every generator or group in the nom file is declared with a name
     // The following two maps enable looking up objects by their names
-    std::map<std::string, TAutoPtr<CEntity>> EntityLibrary;
-    std::map<std::string, TAutoPtr<CSceneNode>> Groups;
+    TNameMap<TAutoPtr<CEntity>> EntityLibrary;
+    TNameMap<TAutoPtr<CSceneNode>> Groups;
+
+    // Tree nodes waiting for the next Update(), instead of walking the whole tree every frame
+    // Entities may be marked dirty from worker threads while updating, hence the lock
+    std::mutex DirtyTreeNodesLock;
+    std::vector<TAutoPtr<CSceneTreeNode>> DirtyTreeNodes;
+    std::vector<TAutoPtr<CSceneTreeNode>> UpdatedTreeNodes;
+    uint64_t StructureVersion = 0;
+
+    // What FindPointOutput resolved paths to, valid for the structure version they were made in.
+    //  The selector owning each output is kept alive along with it.
+    struct CResolvedPoint
+    {
+        TAutoPtr<Flow::CFlowNode> Owner;
+        Flow::TOutput<CVertexInfo*>* Output;
+    };
+    mutable std::unordered_map<std::string, CResolvedPoint> ResolvedPoints;
+    // Tree nodes by the path prefix leading to them, shared by every vertex below
+    mutable std::unordered_map<std::string, CSceneTreeNode*> ResolvedTreeNodes;
+    mutable uint64_t ResolvedVersion = 0;
 };
 
 }
\ No newline at end of file
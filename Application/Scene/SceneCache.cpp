@@ -0,0 +1,114 @@
+#include "SceneCache.h"
+#include "Mesh.h"
+#include <Parsing/BinaryStream.h>
+#include <iostream>
+
+namespace Nome::Scene
+{
+
+namespace
+{
+
+constexpr uint32_t MeshSectionTag = CCacheFile::MakeTag("MESH");
+// Bump whenever a generator places its vertices or faces differently, e.g. a new tessellation.
+//  Cached meshes from another version are regenerated.
+constexpr uint32_t GeneratorVersion = 1;
+
+// Pure generators, whose whole output is the mesh. Entities with outputs of their own, such as
+//  sweep paths, compute those while updating and cannot skip it.
+CMesh* GetCachableMesh(CEntity* entity)
+{
+    auto* mesh = dynamic_cast<CMesh*>(entity);
+    if (!mesh || !mesh->GetOutputSlots().empty())
+        return nullptr;
+    return mesh;
+}
+
+void WriteInputs(CBinaryWriter& out, CScene& scene)
+{
+    out.Write(scene.GetTime()->GetNumber());
+    out.Write(scene.GetFrame()->GetNumber());
+    uint32_t numSliders = 0;
+    scene.GetBankAndSet().ForEachSlider([&](const std::string&, const CSlider&) { numSliders++; });
+    out.Write(numSliders);
+    scene.GetBankAndSet().ForEachSlider([&](const std::string& name, const CSlider& slider) {
+        out.WriteString(name);
+        out.Write(slider.GetValue());
+    });
+}
+
+bool MatchInputs(CBinaryReader& in, CScene& scene)
+{
+    bool bMatch = in.Read<float>() == scene.GetTime()->GetNumber();
+    bMatch = in.Read<float>() == scene.GetFrame()->GetNumber() && bMatch;
+    auto numSliders = in.Read<uint32_t>();
+    uint32_t numCurrent = 0;
+    scene.GetBankAndSet().ForEachSlider([&](const std::string&, const CSlider&) { numCurrent++; });
+    bMatch = numSliders == numCurrent && bMatch;
+    for (uint32_t i = 0; i < numSliders; i++)
+    {
+        auto name = in.ReadString();
+        auto value = in.Read<float>();
+        auto* slider = scene.GetBankAndSet().GetSlider(std::string(name));
+        bMatch = slider && slider->GetValue() == value && bMatch;
+    }
+    return bMatch;
+}
+
+}
+
+size_t CSceneCache::RestoreMeshes(const CSourceManager& sourceMgr, CScene& scene)
+{
+    auto section = sourceMgr.GetCache().FindSection(MeshSectionTag);
+    if (!section)
+        return 0;
+
+    size_t numRestored = 0;
+    try
+    {
+        CBinaryReader in(*section);
+        if (in.Read<uint32_t>() != GeneratorVersion || !MatchInputs(in, scene))
+            return 0;
+        auto numMeshes = in.Read<uint32_t>();
+        for (uint32_t i = 0; i < numMeshes; i++)
+        {
+            auto name = std::string(in.ReadString());
+            CBinaryReader meshIn(in.ReadString());
+            auto* mesh = GetCachableMesh(scene.FindEntity(name).Get());
+            if (!mesh || !mesh->IsDirty())
+                continue;
+            mesh->RestoreGenerated(meshIn);
+            numRestored++;
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        // Whatever was not restored yet is still dirty and simply regenerates
+        std::cout << "Stopped restoring cached meshes: " << e.what() << std::endl;
+    }
+    return numRestored;
+}
+
+bool CSceneCache::Save(const CSourceManager& sourceMgr, CScene& scene)
+{
+    CBinaryWriter out;
+    out.Write(GeneratorVersion);
+    WriteInputs(out, scene);
+    std::vector<std::pair<std::string, CMesh*>> meshes;
+    scene.ForEachEntity([&](const std::string& name, CEntity* entity) {
+        auto* mesh = GetCachableMesh(entity);
+        if (mesh && !mesh->IsDirty())
+            meshes.emplace_back(name, mesh);
+    });
+    out.Write(static_cast<uint32_t>(meshes.size()));
+    for (const auto& [name, mesh] : meshes)
+    {
+        out.WriteString(name);
+        CBinaryWriter meshOut;
+        mesh->WriteGenerated(meshOut);
+        out.WriteString(meshOut.GetBuffer());
+    }
+    return sourceMgr.SaveCache({ { MeshSectionTag, out.TakeBuffer() } });
+}
+
+}
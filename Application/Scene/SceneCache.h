@@ -0,0 +1,22 @@
+#pragma once
+#include "Scene.h"
+#include <Parsing/SourceManager.h>
+#include <string>
+
+namespace Nome::Scene
+{
+
+// Caches what the generators of a scene produced, in the CCacheFile of the source manager. Meshes
+//  are only restored if every slider, the time and the frame are where they were when saved, and
+//  the generators have not changed since.
+class CSceneCache
+{
+public:
+    // Call after the AST was adapted into scene but before it is updated. Returns the number of
+    //  generators that will not have to run.
+    static size_t RestoreMeshes(const CSourceManager& sourceMgr, CScene& scene);
+    // Call once scene is updated, writes the cache file along with the AST
+    static bool Save(const CSourceManager& sourceMgr, CScene& scene);
+};
+
+}
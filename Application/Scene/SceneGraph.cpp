@@ -1,6 +1,7 @@
 #include "SceneGraph.h"
 #include "ASTSceneAdapter.h"
 #include "Entity.h"
+#include "Scene.h"
 #include <Parsing/ASTContext.h>
 
 namespace Nome::Scene
@@ -24,6 +25,19 @@ CEntity* CSceneTreeNode::GetEntity() const
     return GetOwner()->GetEntity();
 }
 
+void CSceneTreeNode::SetEntityUpdated(bool value)
+{
+    bEntityUpdated = value;
+    if (value)
+        MarkForUpdate();
+}
+
+void CSceneTreeNode::MarkForUpdate()
+{
+    if (Owner)
+        Owner->GetScene()->EnqueueDirtyTreeNode(this);
+}
+
 CSceneTreeNode* CSceneTreeNode::FindChildOfOwner(CSceneNode* owner) const
 {
     for (auto* child : Children)
@@ -57,6 +71,12 @@ CSceneTreeNode::CSceneTreeNode(CSceneNode* owner)
 {
 }
 
+CSceneTreeNode::~CSceneTreeNode()
+{
+    if (WatchedEntity)
+        WatchedEntity->OnMarkedDirty.Disconnect(WatchedEntityConnection);
+}
+
 CSceneTreeNode* CSceneTreeNode::CreateTree(CSceneNode* dagNode)
 {
     CSceneTreeNode* treeNode = new CSceneTreeNode(dagNode);
@@ -70,22 +90,35 @@ CSceneTreeNode* CSceneTreeNode::CreateTree(CSceneNode* dagNode)
     // Tell the owner, and instantiate
     treeNode->Owner->TreeNodes.insert(treeNode);
     if (treeNode->Owner->Entity && treeNode->Owner->Entity->IsInstantiable())
-        treeNode->InstanceEntity = treeNode->Owner->Entity->Instantiate(treeNode);
+        treeNode->SetInstanceEntity(treeNode->Owner->Entity->Instantiate(treeNode));
+    else
+        treeNode->WatchEntity();
+    treeNode->MarkForUpdate();
+    dagNode->Scene->BumpStructureVersion();
     return treeNode;
 }
 
 void CSceneTreeNode::RemoveTree()
 {
     for (CSceneTreeNode* child : Children)
+    {
+        // We drop all the children at once below, so they need not unlink themselves
+        child->Parent = nullptr;
         child->RemoveTree();
+    }
 
     // Note: the tree node may still be referenced after deletion, thus we reset all relavant info
+    if (Parent)
+        Parent->Children.erase(this);
     Parent = nullptr;
     Children.clear();
+    Owner->Scene->BumpStructureVersion();
+    // Erasing may drop the last reference to this node, keep it alive until we are done
+    TAutoPtr<CSceneTreeNode> self = this;
     auto iter = Owner->TreeNodes.find(this);
     Owner->TreeNodes.erase(iter);
     Owner = nullptr;
-    InstanceEntity = nullptr;
+    SetInstanceEntity(nullptr);
 }
 
 void CSceneTreeNode::MarkTreeL2WDirty()
@@ -95,6 +128,26 @@ void CSceneTreeNode::MarkTreeL2WDirty()
 
     L2WTransform.MarkDirty();
     OnTransformChange();
+    MarkForUpdate();
+}
+
+void CSceneTreeNode::SetInstanceEntity(CEntity* entity)
+{
+    InstanceEntity = entity;
+    WatchEntity();
+}
+
+void CSceneTreeNode::WatchEntity()
+{
+    CEntity* entity = IsValid() ? GetEntity() : nullptr;
+    if (entity == WatchedEntity)
+        return;
+    if (WatchedEntity)
+        WatchedEntity->OnMarkedDirty.Disconnect(WatchedEntityConnection);
+    WatchedEntity = entity;
+    if (WatchedEntity)
+        WatchedEntityConnection =
+            WatchedEntity->OnMarkedDirty.Connect([this]() { MarkForUpdate(); });
 }
 
 void CSceneNode::TransformMarkedDirty()
@@ -114,6 +167,7 @@ CSceneNode::CSceneNode(CScene* owningScene, std::string name, bool isRoot, bool
     {
         auto* treeNode = new CSceneTreeNode(this);
         TreeNodes.insert(treeNode);
+        treeNode->MarkForUpdate();
     }
 }
 
@@ -167,6 +221,19 @@ void CSceneNode::RemoveParent(CSceneNode* parent)
     }
 }
 
+void CSceneNode::Detach()
+{
+    // Our parents may hold the last reference
+    TAutoPtr<CSceneNode> self = this;
+    while (!Children.empty())
+    {
+        TAutoPtr<CSceneNode> child = *Children.begin();
+        child->RemoveParent(this);
+    }
+    while (!Parents.empty())
+        RemoveParent(*Parents.begin());
+}
+
 CSceneNode* CSceneNode::CreateChildNode(const std::string& name)
 {
     auto* child = new CSceneNode(Scene, name);
@@ -208,10 +275,12 @@ void CSceneNode::SetEntity(CEntity* ent)
             // Uninstantiate
             for (CSceneTreeNode* treeNode : TreeNodes)
             {
-                treeNode->InstanceEntity = nullptr;
+                treeNode->SetInstanceEntity(nullptr);
             }
         }
         Entity = nullptr;
+        for (CSceneTreeNode* treeNode : TreeNodes)
+            treeNode->WatchEntity();
     }
     else
     {
@@ -220,10 +289,22 @@ void CSceneNode::SetEntity(CEntity* ent)
         {
             for (CSceneTreeNode* treeNode : TreeNodes)
             {
-                treeNode->InstanceEntity = Entity->Instantiate(treeNode);
+                treeNode->SetInstanceEntity(Entity->Instantiate(treeNode));
             }
         }
+        else
+        {
+            // Drop instances left over from a previous instantiable entity
+            for (CSceneTreeNode* treeNode : TreeNodes)
+                treeNode->SetInstanceEntity(nullptr);
+        }
+        for (CSceneTreeNode* treeNode : TreeNodes)
+        {
+            treeNode->WatchEntity();
+            treeNode->MarkForUpdate();
+        }
     }
+    Scene->BumpStructureVersion();
 }
 
 void CSceneNode::NotifySurfaceDirty() const
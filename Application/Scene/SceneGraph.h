@@ -32,7 +32,10 @@ public:
     CEntity* GetEntity() const;
     /// Returns whether the associated entity was changed or updated in the last frame
     bool WasEntityUpdated() const { return bEntityUpdated; }
-    void SetEntityUpdated(bool value) { bEntityUpdated = value; }
+    /// Setting this to true also queues the node for the next scene update
+    void SetEntityUpdated(bool value);
+    /// Puts this node on the scene's dirty list, no-op if it is already there
+    void MarkForUpdate();
 
     // Note: linear time is prob too slow
     CSceneTreeNode* FindChildOfOwner(CSceneNode* owner) const;
@@ -46,12 +49,18 @@ public:
 private:
     // Only CSceneNode manages the tree nodes
     friend class CSceneNode;
+    // The scene drains the dirty list and resets the queued flag
+    friend class CScene;
 
     explicit CSceneTreeNode(CSceneNode* owner);
+    ~CSceneTreeNode() override;
 
     static CSceneTreeNode* CreateTree(CSceneNode* dagNode);
     void RemoveTree();
     void MarkTreeL2WDirty();
+    void SetInstanceEntity(CEntity* entity);
+    // Subscribes to the dirty signal of whatever entity this node currently displays
+    void WatchEntity();
 
     // Private fields, accessible to CSceneNode though
     CSceneNode* Owner;
@@ -61,6 +70,10 @@ private:
     // This is non-null if the entity is instantiable
     TAutoPtr<CEntity> InstanceEntity;
     bool bEntityUpdated = false;
+    bool bQueuedForUpdate = false;
+
+    TAutoPtr<CEntity> WatchedEntity;
+    unsigned int WatchedEntityConnection = 0;
 };
 
 // A scene node, which represents either a group or an instance call in Nom file
@@ -80,6 +93,8 @@ public:
     // Hierarchy management
     void AddParent(CSceneNode* newParent);
     void RemoveParent(CSceneNode* parent);
+    // Cuts all edges to parents and children, e.g. when the command behind this node is gone
+    void Detach();
     CSceneNode* CreateChildNode(const std::string& name);
     CSceneNode* FindChildNode(const std::string& name);
     CSceneNode* FindOrCreateChildNode(const std::string& name);
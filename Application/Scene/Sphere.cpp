@@ -21,7 +21,11 @@ void CSphere::UpdateEntity()
         return;
 
     Super::UpdateEntity();
+    GenerateMesh();
+}
 
+void CSphere::GenerateMesh()
+{
     int n = (int)PhiSegs.GetValue(6.0f);
     float radius = Radius.GetValue(1.0f);
     int numCrossSections = (int)ThetaSegs.GetValue(6.0f);
@@ -30,20 +34,24 @@ void CSphere::UpdateEntity()
     int maxPhi = (int)PhiMax.GetValue(6.0f) + 90;
 
     float startPhi = minPhi / 180.f * (float)tc::M_PI;
+    float phiRange = (maxPhi - minPhi) / 180.f * (float)tc::M_PI;
+    float thetaRange = maxTheta / 180.f * (float)tc::M_PI;
+    n = GetLODSegments(n, radius, phiRange);
+    numCrossSections = GetLODSegments(numCrossSections, radius, thetaRange);
+    auto phiTable = CTessellation::GetTrigTable(n, startPhi, phiRange / n);
+    auto thetaTable = CTessellation::GetTrigTable(numCrossSections, 0.0f,
+                                                  thetaRange / numCrossSections);
 
     float width = 0;
 
     for (int j = 0; j < numCrossSections; j++) {
-      float rotationTheta = (float)j / numCrossSections * (maxTheta / 360.f) * 2.f * (float)tc::M_PI;
       for (int i = 0; i < n; i++) {
-          float phi = startPhi + ((float)i / n * ((maxPhi - minPhi) / 180.f) * (float)tc::M_PI);
-          float x = radius * cosf(phi);
-          float y = radius * sinf(phi);
-          float z = 0;
+          float x = radius * phiTable->Cos[i];
+          float y = radius * phiTable->Sin[i];
           float rotatedX = x;
-          float rotatedY = y * cosf(rotationTheta);
-          float rotatedZ = y * sinf(rotationTheta);
-          AddVertex("v" + std::to_string(j) + "-" + std::to_string(i),
+          float rotatedY = y * thetaTable->Cos[j];
+          float rotatedZ = y * thetaTable->Sin[j];
+          AddVertex(CGridName("v", j, "-", i),
                                     { rotatedX, rotatedY, rotatedZ });
           if (j == 0 && i == 0) {
             width += rotatedX;
@@ -61,19 +69,19 @@ void CSphere::UpdateEntity()
             // CCW winding
             int next_k = (k + 1) % numCrossSections;
             int next_c = (c + 1) % n;
-            std::vector<std::string> upperFace = {
+            std::vector<CGridName> upperFace = {
                 // CCW
-                "v" + std::to_string(next_k) + "-" + std::to_string(next_c),
-                "v" + std::to_string(next_k) + "-" + std::to_string(c),
-                "v" + std::to_string(k) + "-" + std::to_string(c),
-                "v" + std::to_string(k) + "-" + std::to_string(next_c),
+                CGridName("v", next_k, "-", next_c),
+                CGridName("v", next_k, "-", c),
+                CGridName("v", k, "-", c),
+                CGridName("v", k, "-", next_c),
             };
             if (k == numCrossSections - 1) {
               if (maxTheta == 360) {
-                AddFace("f" + std::to_string(k) + "-" + std::to_string(c), upperFace);
+                AddFace(CGridName("f", k, "-", c), upperFace);
               }
             } else {
-              AddFace("f" + std::to_string(k) + "-" + std::to_string(c), upperFace);
+              AddFace(CGridName("f", k, "-", c), upperFace);
             }
         }
     }
@@ -22,6 +22,11 @@ public:
     }
 
     void UpdateEntity() override;
+    bool HasLODs() const override { return true; }
+    bool IsSmooth() const override { return true; }
+
+protected:
+    void GenerateMesh() override;
 };
 
 }
@@ -0,0 +1,80 @@
+#include "Subdivision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Nome::Scene
+{
+
+DEFINE_META_OBJECT(CSubdivision)
+{
+    BindNamedArgument(&CSubdivision::Type, "type", 0);
+    BindNamedArgument(&CSubdivision::Level, "subdivisions", 0);
+}
+
+void CSubdivision::UpdateEntity()
+{
+    if (!IsDirty())
+        return;
+
+    // Builds the control mesh out of the faces
+    Super::UpdateEntity();
+
+    if (Type != "catmullclark")
+    {
+        printf("Subdivision %s: unknown type %s, left unsubdivided\n", GetName().c_str(),
+               Type.c_str());
+        return;
+    }
+    int numLevels = std::clamp(static_cast<int>(std::lround(Level.GetValue(0.0f))), 0, MaxLevel);
+    if (numLevels == 0)
+        return;
+
+    auto& data = EditData();
+    Subdivide(data.Mesh, numLevels, Subdivider);
+    // Vertex points come first, so only the face names went stale
+    data.NameToFace.clear();
+    data.FaceToName.clear();
+    data.FaceNames.Clear();
+}
+
+void CSubdivision::Subdivide(CMeshImpl& mesh, int numLevels, CCatmullClark& subdivider)
+{
+    CPolygonTopology base;
+    base.NumVerts = static_cast<uint32_t>(mesh.n_vertices());
+    std::vector<uint32_t> faceVerts;
+    for (auto face : mesh.faces())
+    {
+        faceVerts.clear();
+        for (auto vertex : mesh.fv_range(face))
+            faceVerts.push_back(static_cast<uint32_t>(vertex.idx()));
+        base.AddFace(faceVerts.data(), faceVerts.size());
+    }
+    std::vector<tc::Vector3> positions;
+    positions.reserve(base.NumVerts);
+    for (auto vertex : mesh.vertices())
+    {
+        const auto& pos = mesh.point(vertex);
+        positions.emplace_back(pos[0], pos[1], pos[2]);
+    }
+
+    if (!subdivider.IsBuiltFor(base, numLevels))
+        subdivider.Build(base, numLevels);
+    auto points = subdivider.Apply(positions, tc::FThreadPool::Get());
+
+    const auto& result = subdivider.GetResultTopology();
+    CMeshImpl subdivided;
+    subdivided.reserve(points.size(), points.size() + result.GetNumFaces(), result.GetNumFaces());
+    for (const auto& point : points)
+        subdivided.add_vertex(CMeshImpl::Point(point.x, point.y, point.z));
+    std::vector<CMeshImpl::VertexHandle> handles;
+    for (size_t face = 0; face < result.GetNumFaces(); face++)
+    {
+        handles.clear();
+        for (uint32_t i = result.FaceStarts[face]; i < result.FaceStarts[face + 1]; i++)
+            handles.emplace_back(static_cast<int>(result.FaceVerts[i]));
+        subdivided.add_face(handles);
+    }
+    mesh = std::move(subdivided);
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "CatmullClark.h"
+#include "Mesh.h"
+
+namespace Nome::Scene
+{
+
+// The `subdivision` command: a mesh built from its faces like `mesh`, then Catmull-Clark
+//  subdivided Level times. The stencils are kept until the faces or the level change, so moving
+//  a point only reruns them. Vertices keep their names, the new faces are unnamed.
+class CSubdivision : public CMesh
+{
+    DEFINE_INPUT(float, Level) { MarkDirty(); }
+
+public:
+    DECLARE_META_CLASS(CSubdivision, CMesh);
+
+    // Anything deeper grows the mesh past what is reasonable to draw
+    static constexpr int MaxLevel = 6;
+
+    CSubdivision() = default;
+    explicit CSubdivision(const std::string& name)
+        : CMesh(std::move(name))
+    {
+    }
+
+    void UpdateEntity() override;
+
+    // Replaces mesh with its subdivision, subdivider is reused if it was built for the same faces
+    static void Subdivide(CMeshImpl& mesh, int numLevels, CCatmullClark& subdivider);
+
+private:
+    std::string Type = "catmullclark";
+    CCatmullClark Subdivider;
+};
+
+}
@@ -43,7 +43,7 @@ void CSweep::drawCrossSection(std::vector<Vector3> crossSection,
         // add offset
         Vector3 curVertex = center + transformVector;
 
-        AddVertex("v" + std::to_string(index) + "_" + std::to_string(i), { curVertex.x, curVertex.y, curVertex.z });
+        AddVertex(CGridName("v", index, "_", i), { curVertex.x, curVertex.y, curVertex.z });
     }
 }
 
@@ -283,13 +283,13 @@ void CSweep::UpdateEntity()
             // v2_next v2_i
             int next = (i + 1) % crossSection.size();
             int next_k = (k + 1) % segmentCount;
-            std::vector<std::string> upperFace = {
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(next),
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(next),
+            std::vector<CGridName> upperFace = {
+                    CGridName("v", next_k + 1, "_", next),
+                    CGridName("v", next_k + 1, "_", i),
+                    CGridName("v", k + 1, "_", i),
+                    CGridName("v", k + 1, "_", next),
             };
-            AddFace("f" + std::to_string(k) + "_" + std::to_string(i), upperFace);
+            AddFace(CGridName("f", k, "_", i), upperFace);
         }
     }
 
@@ -41,6 +41,23 @@ void CTemporaryMeshManager::ResetTemporaryMesh()
 }*/
 
 
+void CTemporaryMeshManager::DiscardChanges()
+{
+    for (auto* node : addedSceneNodes)
+        node->Detach();
+    // Names first, removing one placeholder by prefix can free another one as well. The prefix
+    //  also takes the face a placeholder mesh was made from.
+    std::vector<std::string> names;
+    for (auto* mesh : addedMeshes)
+        names.push_back(mesh->GetName());
+    for (const auto& name : names)
+        Scene->RemoveEntity(name, true);
+    addedSceneNodes.clear();
+    addedMeshes.clear();
+    FaceCounter = 0;
+    num_polylines = 0;
+}
+
 void CTemporaryMeshManager::RemoveFace(const std::vector<std::string>& facePoints)
 {
     // create a set containing all the facepoint locations: CMeshImpl::Point(pos.x, pos.y, pos.z) aftrer finding the points 
@@ -24,6 +24,8 @@ public:
     ~CTemporaryMeshManager() = default;
 
     //void ResetTemporaryMesh(); Randy note: after 10/1, not used anymore as it's equivalent to reloading a file
+    // Takes the uncommitted faces and polylines back out of the scene
+    void DiscardChanges();
 
     void RemoveFace(const std::vector<std::string>& facePoints); // Randy added this. Not sure if TemporaryMeshManager is best place for it, but putting it here for now.
 
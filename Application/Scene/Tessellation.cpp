@@ -0,0 +1,92 @@
+#include "Tessellation.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace Nome::Scene
+{
+
+namespace
+{
+
+// Dragging a slider makes a new sweep per frame, so old tables are dropped past this many
+constexpr size_t MaxCachedTables = 256;
+
+}
+
+int CTessellation::SegmentsForChordError(float radius, float angle, float chordError)
+{
+    radius = std::abs(radius);
+    angle = std::abs(angle);
+    if (radius <= chordError || angle <= 0.0f)
+        return 1;
+    // An arc over a segment of angle a bulges out from its chord by r * (1 - cos(a / 2))
+    float maxAngle = 2.0f * std::acos(1.0f - chordError / radius);
+    return std::max(1, static_cast<int>(std::ceil(angle / maxAngle)));
+}
+
+float CTessellation::GetChordError(int level)
+{
+    if (level <= 0)
+        return 0.0f;
+    return std::ldexp(BaseChordError, level - 1);
+}
+
+int CTessellation::GetLODSegments(int userSegs, float radius, float angle, int level, int minSegs)
+{
+    if (level <= 0 || userSegs <= minSegs)
+        return userSegs;
+    int segs = SegmentsForChordError(radius, angle, GetChordError(level));
+    return std::clamp(segs, minSegs, userSegs);
+}
+
+float CTessellation::GetPixelSize(float distance, float fovY, float viewportHeight)
+{
+    if (viewportHeight <= 0.0f)
+        return 0.0f;
+    float halfFov = fovY * 0.5f * 3.14159265f / 180.0f;
+    return 2.0f * std::abs(distance) * std::tan(halfFov) / viewportHeight;
+}
+
+int CTessellation::PickLevel(float allowedError)
+{
+    int level = 0;
+    while (level < MaxLODLevel && GetChordError(level + 1) <= allowedError)
+        level++;
+    return level;
+}
+
+std::shared_ptr<const CTrigTable> CTessellation::GetTrigTable(int count, float begin, float step)
+{
+    static std::mutex cacheLock;
+    static std::map<std::tuple<int, float, float>, std::shared_ptr<const CTrigTable>> cache;
+
+    count = std::max(count, 0);
+    std::lock_guard<std::mutex> lock(cacheLock);
+    auto& table = cache[{ count, begin, step }];
+    if (!table)
+    {
+        auto newTable = std::make_shared<CTrigTable>();
+        newTable->Begin = begin;
+        newTable->Step = step;
+        newTable->Sin.resize(count + 1);
+        newTable->Cos.resize(count + 1);
+        for (int i = 0; i <= count; i++)
+        {
+            float angle = begin + static_cast<float>(i) * step;
+            newTable->Sin[i] = std::sin(angle);
+            newTable->Cos[i] = std::cos(angle);
+        }
+        if (cache.size() > MaxCachedTables)
+        {
+            cache.clear();
+            return newTable;
+        }
+        table = std::move(newTable);
+    }
+    return table;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+namespace Nome::Scene
+{
+
+// Sines and cosines of Begin + i * Step for i in 0 up to and including Count
+struct CTrigTable
+{
+    float Begin = 0.0f;
+    float Step = 0.0f;
+    std::vector<float> Sin;
+    std::vector<float> Cos;
+};
+
+// Segment counts and trig tables for the curved generators. Level of detail 0 is exactly what
+//  the nom file asks for, every coarser level allows twice the chordal error of the one before,
+//  and the viewer picks the coarsest level whose error still stays under a pixel.
+class CTessellation
+{
+public:
+    static constexpr int MaxLODLevel = 4;
+    // Allowed chordal error of level 1 in local units
+    static constexpr float BaseChordError = 0.002f;
+
+    // Fewest segments an arc of the radius and angle in radians needs to stay within chordError
+    static int SegmentsForChordError(float radius, float angle, float chordError);
+    static float GetChordError(int level);
+    // Never more than the nom file asks for, and never below minSegs unless it asks for less
+    static int GetLODSegments(int userSegs, float radius, float angle, int level, int minSegs = 3);
+
+    // World size of a pixel at the distance, fovY in degrees
+    static float GetPixelSize(float distance, float fovY, float viewportHeight);
+    // Coarsest level whose chordal error is at most allowedError
+    static int PickLevel(float allowedError);
+
+    // Tables are shared between all generators asking for the same sweep and are never modified
+    static std::shared_ptr<const CTrigTable> GetTrigTable(int count, float begin, float step);
+};
+
+}
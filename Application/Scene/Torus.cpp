@@ -32,7 +32,11 @@ void CTorus::UpdateEntity()
 
     // Clear mesh
     Super::UpdateEntity();
+    GenerateMesh();
+}
 
+void CTorus::GenerateMesh()
+{
     // Initialize torus parameters from document 
     float majorRadius = maj_rad.GetValue(1.0f);
     float minorRadius = min_rad.GetValue(1.0f);
@@ -42,26 +46,32 @@ void CTorus::UpdateEntity()
     // number of circles or cross sections
     int thetaSegs = static_cast<int>(theta_segs.GetValue(1.0f)); 
     int phiSegs = static_cast<int>(phi_segs.GetValue(5.0f));
+    thetaSegs = GetLODSegments(thetaSegs, majorRadius + minorRadius,
+                               thetaMax * (float)tc::M_PI / 180.0f);
+    phiSegs = GetLODSegments(phiSegs, minorRadius, (phiMax - phiMin) * (float)tc::M_PI / 180.0f);
 
     const float epsilon = 1e-4;
     const float dt = (thetaMax * (float)tc::M_PI/180.0f) / (thetaSegs);
     const float du = ((phiMax-phiMin) * (float)tc::M_PI / 180.0f) / phiSegs; // convert phiMax to radians then divide by # of segs on circle
     const float du_offset = (phiMin * (float)tc::M_PI / 180.0f); // convert phiMin to radians. This will be used to offset so it starts at phiMin instead of 0 . DOESNT WORK
+    auto thetaTable = CTessellation::GetTrigTable(thetaSegs, 0.0f, dt);
+    auto phiTable = CTessellation::GetTrigTable(phiSegs, du_offset, du);
+    const float cosEpsilon = cosf(epsilon);
+    const float sinEpsilon = sinf(epsilon);
 
     // Create torus, creating one cross section at each iteration
     for (int i = 0; i < thetaSegs + 1; i++) // thetaSegs + 1; for some reason thetaSegs was outputting an off by one torus...
     {
-        float t0 = i * dt;
+        float cosT0 = thetaTable->Cos[i];
+        float sinT0 = thetaTable->Sin[i];
 
-        Point p0 = {majorRadius*cos(t0), majorRadius*sinf(t0), 0}; 
+        Point p0 = { majorRadius * cosT0, majorRadius * sinT0, 0 };
 
         // Below, we'll work on approximating the Frenet frame { T, N, B } for the curve at the current point
 
-        float t1 = t0 + epsilon;
-
-        // p1 is p0 advanced infinitesimally along the curve
-
-        Point p1 = {majorRadius*cos(t1), majorRadius*sinf(t1), 0 }; //uncomment this to do torus instead 
+        // p1 is p0 advanced infinitesimally along the curve, by epsilon through the angle sum
+        Point p1 = { majorRadius * (cosT0 * cosEpsilon - sinT0 * sinEpsilon),
+                     majorRadius * (sinT0 * cosEpsilon + cosT0 * sinEpsilon), 0 };
 
         // compute approximate tangent as vector connecting p0 to p1
         Point T = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
@@ -93,11 +103,9 @@ void CTorus::UpdateEntity()
         // generate points in a circle perpendicular to the curve at the current point
         for (int j = 0; j < phiSegs; ++j)
         {
-            float u = j * (du) + du_offset; // du_offset is needed for the phiMin adjustment
-
-            // compute position of circle point
-            float x = minorRadius * cosf(u); // u is the angle 
-            float y = minorRadius * sinf(u);
+            // compute position of circle point at angle j * du + du_offset
+            float x = minorRadius * phiTable->Cos[j];
+            float y = minorRadius * phiTable->Sin[j];
 
             Point p2 = { x * N.x + y * B.x, x * N.y + y * B.y, x * N.z + y * B.z };
 
@@ -106,7 +114,7 @@ void CTorus::UpdateEntity()
             curr_vertex.y = p0.y + p2.y;
             curr_vertex.z = p0.z + p2.z;
 
-            AddVertex("v" + std::to_string(i + 1) + "_" + std::to_string(j),
+            AddVertex(CGridName("v", i + 1, "_", j),
                       { curr_vertex.x, curr_vertex.y, curr_vertex.z });
         }
     }
@@ -120,7 +128,7 @@ void CTorus::UpdateEntity()
                 // CCW winding
                 int next = (i + 1) % phiSegs;
                 int next_k = (k + 1) % thetaSegs;
-                std::vector<std::string> upperFace = {
+                std::vector<CGridName> upperFace = {
                     /* Old method was incorrectly CW (back face was showing in the front)
                     "v" + std::to_string(k + 1) + "_" + std::to_string(next),
                     "v" + std::to_string(k + 1) + "_" + std::to_string(i),
@@ -128,12 +136,12 @@ void CTorus::UpdateEntity()
                     "v" + std::to_string(next_k + 1) + "_" + std::to_string(next)*/
 
                     // CCW 
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(next),
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(next),
+                    CGridName("v", next_k + 1, "_", next),
+                    CGridName("v", next_k + 1, "_", i),
+                    CGridName("v", k + 1, "_", i),
+                    CGridName("v", k + 1, "_", next),
                 };
-                AddFace("f1_" + std::to_string(i), upperFace);
+                AddFace(CGridName("f1_", i), upperFace);
             }
         }
     }
@@ -146,13 +154,13 @@ void CTorus::UpdateEntity()
                 // CCW winding
                 int next = (i + 1) % phiSegs;
                 int next_k = (k + 1) % (thetaSegs + 1);
-                std::vector<std::string> upperFace = {
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(next),
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(next)
+                std::vector<CGridName> upperFace = {
+                    CGridName("v", next_k + 1, "_", next),
+                    CGridName("v", next_k + 1, "_", i),
+                    CGridName("v", k + 1, "_", i),
+                    CGridName("v", k + 1, "_", next)
                 };
-                AddFace("f1_" + std::to_string(i), upperFace);
+                AddFace(CGridName("f1_", i), upperFace);
             }
         }
     }
@@ -1,4 +1,5 @@
 #include "TorusKnot.h"
+#include <algorithm>
 #include <cmath>
 
 #undef M_PI
@@ -40,7 +41,11 @@ void CTorusKnot::UpdateEntity()
 
     // Clear mesh
     Super::UpdateEntity();
+    GenerateMesh();
+}
 
+void CTorusKnot::GenerateMesh()
+{
     // Initialize torus knot parameters from document 
     int _p = P_Val.GetValue(1.0f);
     int _q = Q_Val.GetValue(1.0f);
@@ -49,10 +54,15 @@ void CTorusKnot::UpdateEntity()
     float majorRadius = MajorRadius.GetValue(1.0f);
     float tubeRadius = TubeRadius.GetValue(1.0f);
     int numSegments = Segments.GetValue(0.0f); // number of circles basically
+    // The knot winds max(p, q) times around circles no tighter than the minor radius
+    float windings = (float)std::max(std::abs(_p), std::abs(_q));
+    numSegments = GetLODSegments(numSegments, minorRadius, 2.0f * (float)tc::M_PI * windings);
+    numPhi = GetLODSegments(numPhi, tubeRadius, 2.0f * (float)tc::M_PI);
 
     const float epsilon = 1e-4;
     const float dt = (2.0f * (float)tc::M_PI) / (numSegments);
     const float du = (2.0f * (float)tc::M_PI) / numPhi;
+    auto ringTable = CTessellation::GetTrigTable(numPhi, 0.0f, du);
     
     // Special case where tubeRadius == 0, create a polyline that can be used for Sweeps
     std::vector<CMeshImpl::VertexHandle> vertArray;
@@ -108,11 +118,9 @@ void CTorusKnot::UpdateEntity()
             // generate points in a circle perpendicular to the curve at the current point
             for (int j = 0; j <= numPhi; ++j)
             {
-                float u = j * du;
-
-                // compute position of circle point
-                float x = tubeRadius * cosf(u);
-                float y = tubeRadius * sinf(u);
+                // compute position of circle point at angle j * du
+                float x = tubeRadius * ringTable->Cos[j];
+                float y = tubeRadius * ringTable->Sin[j];
 
                 Point p2 = { x * N.x + y * B.x, x * N.y + y * B.y, x * N.z + y * B.z };
                 Point curr_vertex;
@@ -120,14 +128,14 @@ void CTorusKnot::UpdateEntity()
                 curr_vertex.y = p0.y + p2.y;
                 curr_vertex.z = p0.z + p2.z;
 
-                AddVertex("v" + std::to_string(i + 1) + "_" + std::to_string(j),
+                AddVertex(CGridName("v", i + 1, "_", j),
                           { curr_vertex.x, curr_vertex.y, curr_vertex.z });
             }
         }
         else
         {
             auto p0vec3 = Vector3(p0.x, p0.y, p0.z);
-            auto vertHandle = AddVertex("knotpoint" + std::to_string(i), p0vec3);
+            auto vertHandle = AddVertex(CGridName("knotpoint", i), p0vec3);
             vertArray.push_back(vertHandle);
             CVertexInfo point;
             point.Position =p0vec3;
@@ -145,18 +153,18 @@ void CTorusKnot::UpdateEntity()
                 // CCW winding
                 int next = (i + 1) % numPhi;
                 int next_k = (k + 1) % numSegments;
-                std::vector<std::string> upperFace = {
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(next),
-                    "v" + std::to_string(next_k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(i),
-                    "v" + std::to_string(k + 1) + "_" + std::to_string(next)
+                std::vector<CGridName> upperFace = {
+                    CGridName("v", next_k + 1, "_", next),
+                    CGridName("v", next_k + 1, "_", i),
+                    CGridName("v", k + 1, "_", i),
+                    CGridName("v", k + 1, "_", next)
 
                 };
-                AddFace("f1_" + std::to_string(i), upperFace);
+                AddFace(CGridName("f1_", i), upperFace);
             }
         }
     }
-    else
+    else if (GetLODLevel() == 0)
     {
         AddLineStrip("torusknotline", vertArray);
 
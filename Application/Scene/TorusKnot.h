@@ -26,6 +26,11 @@ public:
 
     void UpdateEntity() override;
     void MarkDirty() override; // Check with Zachary
+    bool HasLODs() const override { return true; }
+    bool IsSmooth() const override { return true; }
+
+protected:
+    void GenerateMesh() override;
 };
 
 }
\ No newline at end of file
@@ -30,17 +30,17 @@ void CTunnel::UpdateEntity()
     for (int i = 0; i < n; i++)
     {
         float theta = (float)i / n * 2.f * (float)tc::M_PI;
-        AddVertex("v2_" + std::to_string(i), { radius * cosf(theta), radius * sinf(theta), 0.f });
+        AddVertex(CGridName("v2_", i), { radius * cosf(theta), radius * sinf(theta), 0.f });
     }
     for (int i = 0; i < n; i++)
     {
         float theta = (float)i / n * 2.f * (float)tc::M_PI;
-        AddVertex("v1_" + std::to_string(i), { ri * cosf(theta), ri * sinf(theta), height });
+        AddVertex(CGridName("v1_", i), { ri * cosf(theta), ri * sinf(theta), height });
     }
     for (int i = 0; i < n; i++)
     {
         float theta = (float)i / n * 2.f * (float)tc::M_PI;
-        AddVertex("v3_" + std::to_string(i), { ri * cosf(theta), ri * sinf(theta), -height });
+        AddVertex(CGridName("v3_", i), { ri * cosf(theta), ri * sinf(theta), -height });
     }
 
     // Create faces
@@ -51,14 +51,12 @@ void CTunnel::UpdateEntity()
         // v2_i v2_next
         // v3_i v3_next
         int next = (i + 1) % n;
-        std::vector<std::string> upperFace = { "v1_" + std::to_string(i), "v2_" + std::to_string(i),
-                                               "v2_" + std::to_string(next),
-                                               "v1_" + std::to_string(next) };
-        AddFace("f1_" + std::to_string(i), upperFace);
-        std::vector<std::string> lowerFace = { "v2_" + std::to_string(i), "v3_" + std::to_string(i),
-                                               "v3_" + std::to_string(next),
-                                               "v2_" + std::to_string(next) };
-        AddFace("f2_" + std::to_string(i), lowerFace);
+        std::vector<CGridName> upperFace = { CGridName("v1_", i), CGridName("v2_", i),
+                                             CGridName("v2_", next), CGridName("v1_", next) };
+        AddFace(CGridName("f1_", i), upperFace);
+        std::vector<CGridName> lowerFace = { CGridName("v2_", i), CGridName("v3_", i),
+                                             CGridName("v3_", next), CGridName("v2_", next) };
+        AddFace(CGridName("f2_", i), lowerFace);
     }
     // Two caps
     // std::vector<std::string> upperCap, lowerCap;
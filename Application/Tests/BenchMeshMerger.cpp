@@ -0,0 +1,72 @@
+#include "Scene/MeshMerger.h"
+#include "Scene/Scene.h"
+
+#include "catch.hpp"
+
+#include <chrono>
+
+namespace
+{
+
+using namespace Nome::Scene;
+
+// A flat grid of quads, Side * Side vertices
+class CGridMesh : public CMesh
+{
+public:
+    static constexpr int Side = 1000;
+
+    void UpdateEntity() override
+    {
+        if (!IsDirty())
+            return;
+        CMesh::UpdateEntity();
+
+        std::vector<CMeshImpl::VertexHandle> verts;
+        verts.reserve(Side * Side);
+        for (int i = 0; i < Side; i++)
+            for (int j = 0; j < Side; j++)
+                verts.push_back(
+                    AddVertex(CGridName("v", i * Side + j), { i * 0.05f, j * 0.05f, 0.0f }));
+        for (int i = 0; i + 1 < Side; i++)
+            for (int j = 0; j + 1 < Side; j++)
+            {
+                int v = i * Side + j;
+                AddFace(CGridName("f", v),
+                        std::vector<CMeshImpl::VertexHandle> { verts[v], verts[v + Side],
+                                                               verts[v + Side + 1], verts[v + 1] });
+            }
+    }
+};
+
+}
+
+// Run explicitly with: Nome3_test "[benchmark]"
+TEST_CASE("Merge two overlapping 1M vertex instances", "[.][benchmark]")
+{
+    using tc::TAutoPtr;
+
+    TAutoPtr<CScene> scene = new CScene();
+    TAutoPtr<CGridMesh> grid = new CGridMesh();
+    scene->GetRootNode()->CreateChildNode("a")->SetEntity(grid);
+    scene->GetRootNode()->CreateChildNode("b")->SetEntity(grid);
+    scene->Update();
+
+    std::vector<CMeshInstance*> instances;
+    for (CSceneTreeNode* child : scene->GetRootTreeNode()->GetChildren())
+        instances.push_back(dynamic_cast<CMeshInstance*>(child->GetInstanceEntity()));
+    REQUIRE(instances.size() == 2);
+
+    TAutoPtr<CMeshMerger> merger = new CMeshMerger("merger");
+    auto start = std::chrono::steady_clock::now();
+    for (auto* instance : instances)
+        merger->MergeIn(*instance);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    printf("Merged 2 x %d vertices in %.3f s\n", CGridMesh::Side * CGridMesh::Side,
+           elapsed.count());
+
+    // The second instance lies exactly on top of the first, so every vertex gets welded
+    const int numVerts = CGridMesh::Side * CGridMesh::Side;
+    REQUIRE(merger->HasVertex("v" + std::to_string(numVerts - 1)));
+    REQUIRE(!merger->HasVertex("v" + std::to_string(numVerts)));
+}
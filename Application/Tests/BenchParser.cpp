@@ -0,0 +1,59 @@
+#include "Parsing/SourceManager.h"
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+using namespace Nome;
+
+// Seconds from the start of parsing to a finished AST, file loading left out
+double TimeParse(const std::string& path, EParserKind kind)
+{
+    CSourceManager sourceMgr(path);
+    sourceMgr.SetPrintAST(false);
+    sourceMgr.SetParserKind(kind);
+    std::chrono::steady_clock::time_point start;
+    double seconds = 0.0;
+    sourceMgr.SetStageCallback([&](const char* stage) {
+        if (std::string(stage) == "parse")
+            start = std::chrono::steady_clock::now();
+        else if (std::string(stage) == "done")
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                          .count();
+    });
+    REQUIRE(sourceMgr.ParseMainSource());
+    return seconds;
+}
+
+}
+
+// Run explicitly with: Nome3_test "[benchmark]"
+TEST_CASE("Parser throughput on a large point sheet", "[.][benchmark]")
+{
+    const int side = 300;
+    std::ostringstream ss;
+    for (int i = 0; i < side; i++)
+        for (int j = 0; j < side; j++)
+            ss << "point p" << i << "_" << j << " (" << i << " -" << j << "*0.5 {expr $s.h}) "
+               << "endpoint\n";
+    ss << "bank s set h 1 -5 5 0.1 endbank\n";
+    std::string source = ss.str();
+    std::string path = "bench_parser.nom";
+    std::ofstream(path) << source;
+
+    double megabytes = source.size() / (1024.0 * 1024.0);
+    double antlr = TimeParse(path, EParserKind::Antlr);
+    double fast = TimeParse(path, EParserKind::Fast);
+    double parallel = TimeParse(path, EParserKind::Parallel);
+    printf("Parsed %.1f MB: ANTLR %.3f s (%.1f MB/s), fast %.3f s (%.1f MB/s), "
+           "parallel %.3f s (%.1f MB/s)\n",
+           megabytes, antlr, megabytes / antlr, fast, megabytes / fast, parallel,
+           megabytes / parallel);
+    std::remove(path.c_str());
+}
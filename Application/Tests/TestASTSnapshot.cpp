@@ -0,0 +1,70 @@
+#include "Parsing/ASTSnapshot.h"
+#include "Parsing/CacheFile.h"
+#include "Parsing/FastParser.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+
+using namespace Nome;
+
+std::string Dump(AST::AFile* file)
+{
+    std::ostringstream ss;
+    ss << *file;
+    for (auto* command : file->GetCommands())
+    {
+        std::vector<AST::CToken*> tokenList;
+        command->CollectTokens(tokenList);
+        for (auto* token : tokenList)
+            ss << token->GetText() << "@" << token->GetLocation().Start << " ";
+    }
+    return ss.str();
+}
+
+}
+
+TEST_CASE("AST snapshots read back the same tree")
+{
+    AST::CASTContext ctx;
+    auto source = ctx.CopyString("point a (0 -1 {expr $s.h*2}) endpoint\n"
+                                 "bank s set h 1 -5 5 0.1 endbank\n"
+                                 "mesh m face f (a b c) endface endmesh\n"
+                                 "instance i m surface red rotate (0 0 1) (-45) endinstance\n");
+    CFastParser parser(ctx, source);
+    parser.Tokenize();
+    auto* file = parser.ParseFile();
+    // Tokens added after parsing do not view the source
+    auto* hidden = ctx.Make<AST::ANamedArgument>(ctx.MakeToken("hidden"));
+    file->GetCommands()[0]->AddNamedArgument(hidden);
+    std::string data = CASTSnapshot::Write(*file, source);
+
+    AST::CASTContext readCtx;
+    REQUIRE(Dump(CASTSnapshot::Read(data, readCtx, source)) == Dump(file));
+
+    for (size_t cut = 0; cut < data.size(); cut++)
+    {
+        AST::CASTContext damagedCtx;
+        REQUIRE_THROWS_AS(CASTSnapshot::Read(data.substr(0, cut), damagedCtx, source),
+                          std::runtime_error);
+    }
+}
+
+TEST_CASE("Cache files only load for the source they were written for")
+{
+    std::string path = "test_cache_file.nomcache";
+    auto hash = CCacheFile::HashSource("point a (0 0 0) endpoint");
+    REQUIRE(CCacheFile::Save(path, hash, { { CCacheFile::MakeTag("TEST"), "payload" } }));
+
+    CCacheFile cache;
+    REQUIRE(!cache.Load(path, CCacheFile::HashSource("point a (0 0 1) endpoint")));
+    REQUIRE(cache.Load(path, hash));
+    REQUIRE(cache.FindSection(CCacheFile::MakeTag("TEST")) == "payload");
+    REQUIRE(!cache.FindSection(CCacheFile::MakeTag("NONE")));
+    std::remove(path.c_str());
+}
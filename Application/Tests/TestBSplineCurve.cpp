@@ -0,0 +1,88 @@
+#include "Scene/BSplineCurve.h"
+
+#include "catch.hpp"
+
+#include <cmath>
+
+namespace
+{
+
+// Textbook Cox-de Boor recursion over the same uniform knots, order k, 0-based basis index i
+float Basis(int i, int k, float t)
+{
+    if (k == 1)
+        return i <= t && t < i + 1 ? 1.0f : 0.0f;
+    return (t - i) / (k - 1) * Basis(i, k - 1, t) + (i + k - t) / (k - 1) * Basis(i + 1, k - 1, t);
+}
+
+}
+
+TEST_CASE("B-spline evaluation agrees with the Cox-de Boor recursion")
+{
+    using namespace Nome::Scene;
+
+    std::vector<tc::Vector3> controlPoints;
+    for (int i = 0; i < 9; i++)
+        controlPoints.emplace_back(std::cos(i * 0.7f) * 3.0f, std::sin(i * 1.3f), i * 0.25f);
+
+    for (int order : { 2, 3, 4, 6 })
+    {
+        CBSplineCurve curve;
+        curve.Build(controlPoints, order);
+        REQUIRE(curve.GetBegin() == order - 1.0f);
+        REQUIRE(curve.GetEnd() == 9.0f);
+
+        std::vector<float> params;
+        for (int i = 0; i < 3000; i++)
+            params.push_back(curve.GetBegin() + (curve.GetEnd() - curve.GetBegin()) * i / 3000.0f);
+        std::vector<tc::Vector3> batch;
+        curve.Evaluate(params, batch);
+        REQUIRE(batch.size() == params.size());
+        for (size_t i = 0; i < params.size(); i += 37)
+        {
+            tc::Vector3 expected = tc::Vector3::ZERO;
+            for (int j = 0; j < 9; j++)
+                expected += Basis(j, order, params[i]) * controlPoints[j];
+            INFO("order " << order << " t " << params[i]);
+            REQUIRE((batch[i] - expected).Length() < 1e-4f);
+            REQUIRE((curve.Evaluate(params[i]) - batch[i]).Length() < 1e-6f);
+        }
+
+        // Derivatives against central differences
+        const float h = 1e-2f;
+        for (float t = curve.GetBegin() + 0.13f; t < curve.GetEnd() - 0.1f; t += 0.61f)
+        {
+            auto slope = (curve.Evaluate(t + h) - curve.Evaluate(t - h)) / (2.0f * h);
+            REQUIRE((curve.Evaluate(t, 1) - slope).Length() < 1e-2f * (1.0f + slope.Length()));
+            if (order >= 4)
+            {
+                auto bend = (curve.Evaluate(t + h, 1) - curve.Evaluate(t - h, 1)) / (2.0f * h);
+                REQUIRE((curve.Evaluate(t, 2) - bend).Length() < 2e-2f * (1.0f + bend.Length()));
+            }
+        }
+    }
+}
+
+TEST_CASE("B-spline Frenet frames are orthonormal and follow the tangent")
+{
+    using namespace Nome::Scene;
+
+    // The last four points are on a line, so the frame there has to make up a normal
+    std::vector<tc::Vector3> controlPoints = { { 0, 0, 0 }, { 1, 2, 0 }, { 3, 2, 1 }, { 4, 0, 2 },
+                                               { 5, 0, 2 }, { 6, 0, 2 }, { 7, 0, 2 } };
+    CBSplineCurve curve;
+    curve.Build(controlPoints, 4);
+    for (float t = curve.GetBegin(); t <= curve.GetEnd(); t += 0.25f)
+    {
+        auto frame = curve.FrenetFrameAt(t);
+        tc::Vector3 tangent = frame.Column(0);
+        tc::Vector3 normal = frame.Column(1);
+        tc::Vector3 binormal = frame.Column(2);
+        INFO("t " << t);
+        REQUIRE(std::abs(tangent.Length() - 1.0f) < 1e-4f);
+        REQUIRE(std::abs(normal.Length() - 1.0f) < 1e-4f);
+        REQUIRE(std::abs(tangent.DotProduct(normal)) < 1e-4f);
+        REQUIRE((tangent.CrossProduct(normal) - binormal).Length() < 1e-4f);
+        REQUIRE(tangent.DotProduct(curve.Evaluate(t, 1).Normalized()) > 0.9999f);
+    }
+}
@@ -0,0 +1,53 @@
+#include "Scene/BVH.h"
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+
+TEST_CASE("BVH ray queries find the same boxes as testing every box")
+{
+    using namespace Nome::Scene;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> extent(0.0f, 1.0f);
+    auto randomBox = [&]() {
+        tc::Vector3 min { coord(rng), coord(rng), coord(rng) };
+        return tc::BoundingBox(min, min + tc::Vector3 { extent(rng), extent(rng), extent(rng) });
+    };
+    std::vector<tc::BoundingBox> boxes;
+    for (int i = 0; i < 1000; i++)
+        boxes.push_back(randomBox());
+    // Empty items never get hit
+    boxes.emplace_back();
+
+    CBVH bvh;
+    bvh.Build(boxes);
+    REQUIRE(bvh.GetNumItems() == boxes.size());
+
+    auto requireSameHits = [&]() {
+        for (int i = 0; i < 200; i++)
+        {
+            tc::Ray ray({ coord(rng), coord(rng), coord(rng) },
+                        { coord(rng), coord(rng), coord(rng) });
+            std::vector<uint32_t> expected;
+            for (uint32_t item = 0; item < boxes.size(); item++)
+                if (ray.HitDistance(boxes[item]) < tc::M_INFINITY)
+                    expected.push_back(item);
+            std::vector<uint32_t> found;
+            bvh.QueryRay(ray, [&](uint32_t item) { found.push_back(item); });
+            std::sort(found.begin(), found.end());
+            REQUIRE(found == expected);
+        }
+    };
+    requireSameHits();
+
+    // Moving items around keeps the old tree shape but must not lose them
+    for (uint32_t item = 0; item < boxes.size(); item += 3)
+    {
+        boxes[item] = randomBox();
+        bvh.Refit(item, boxes[item]);
+    }
+    requireSameHits();
+}
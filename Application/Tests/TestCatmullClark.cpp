@@ -0,0 +1,88 @@
+#include "Scene/CatmullClark.h"
+
+#include "catch.hpp"
+
+namespace
+{
+
+using namespace Nome::Scene;
+
+// [-1, 1]^3 with outward facing quads
+CPolygonTopology MakeCube(std::vector<tc::Vector3>& positions)
+{
+    positions.clear();
+    for (int i = 0; i < 8; i++)
+        positions.emplace_back(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+    const uint32_t quads[6][4] = { { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 },
+                                   { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+    CPolygonTopology cube;
+    cube.NumVerts = 8;
+    for (const auto& quad : quads)
+        cube.AddFace(quad, 4);
+    return cube;
+}
+
+void RequireNear(const tc::Vector3& lhs, const tc::Vector3& rhs)
+{
+    INFO(lhs.ToString() << " vs " << rhs.ToString());
+    REQUIRE((lhs - rhs).Length() < 1e-5f);
+}
+
+}
+
+TEST_CASE("Catmull-Clark stencils reproduce the subdivision rules")
+{
+    tc::FThreadPool pool(2);
+    std::vector<tc::Vector3> positions;
+    auto cube = MakeCube(positions);
+
+    CCatmullClark subdivider;
+    subdivider.Build(cube, 1);
+    REQUIRE(subdivider.IsBuiltFor(cube, 1));
+    const auto& result = subdivider.GetResultTopology();
+    REQUIRE(result.NumVerts == 8 + 6 + 12);
+    REQUIRE(result.GetNumFaces() == 24);
+
+    auto points = subdivider.Apply(positions, pool);
+    REQUIRE(points.size() == result.NumVerts);
+    // Corners keep their index and move to (F + 2R) / 3
+    RequireNear(points[7], { 5.0f / 9.0f, 5.0f / 9.0f, 5.0f / 9.0f });
+    // Face points are face centers, the first face is z = -1
+    RequireNear(points[8], { 0.0f, 0.0f, -1.0f });
+    // Edge points average the edge ends and the two face points
+    RequireNear(points[14], { -0.75f, 0.0f, -0.75f });
+
+    // Two levels make a smooth surface, each level is applied on top of the last
+    subdivider.Build(cube, 2);
+    REQUIRE(subdivider.GetResultTopology().GetNumFaces() == 96);
+    auto twice = subdivider.Apply(positions, pool);
+    for (const auto& point : twice)
+        REQUIRE(point.Length() < 1.74f);
+
+    // Moving points only needs the stencils again
+    for (auto& pos : positions)
+        pos *= 2.0f;
+    auto scaled = subdivider.Apply(positions, pool);
+    for (size_t i = 0; i < twice.size(); i++)
+        RequireNear(scaled[i], twice[i] * 2.0f);
+}
+
+TEST_CASE("Catmull-Clark keeps open boundaries and corners in place")
+{
+    tc::FThreadPool pool(2);
+    // A single quad: every vertex is a corner with two boundary edges
+    CPolygonTopology quad;
+    quad.NumVerts = 4;
+    const uint32_t verts[] = { 0, 1, 2, 3 };
+    quad.AddFace(verts, 4);
+    std::vector<tc::Vector3> positions = { { 0, 0, 0 }, { 4, 0, 0 }, { 4, 4, 0 }, { 0, 4, 0 } };
+
+    CCatmullClark subdivider;
+    subdivider.Build(quad, 1);
+    auto points = subdivider.Apply(positions, pool);
+    REQUIRE(points.size() == 9);
+    RequireNear(points[0], { 0.0f, 0.0f, 0.0f });
+    RequireNear(points[4], { 2.0f, 2.0f, 0.0f });
+    // Boundary edges split at their midpoints
+    RequireNear(points[5], { 2.0f, 0.0f, 0.0f });
+}
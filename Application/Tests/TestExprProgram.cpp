@@ -0,0 +1,33 @@
+#include "Scene/ExprEval.h"
+
+#include "catch.hpp"
+
+TEST_CASE("Compiled expressions fold constants and follow their sliders")
+{
+    using namespace Nome::Scene;
+    using EOp = CExprProgram::EOp;
+
+    // 2 * sin(x) - -(3 + 4) ^ 2
+    CExprProgram program;
+    program.PushConst(2.0f);
+    program.PushVar(0);
+    program.PushOp(EOp::Sin);
+    program.PushOp(EOp::Mul);
+    program.PushConst(3.0f);
+    program.PushConst(4.0f);
+    program.PushOp(EOp::Add);
+    program.PushConst(2.0f);
+    program.PushOp(EOp::Pow);
+    program.PushOp(EOp::Neg);
+    program.PushOp(EOp::Sub);
+    REQUIRE(program.GetNumInstructions() == 6);
+
+    tc::TAutoPtr<CSlider> slider = new CSlider(nullptr, 0.5f, 0.0f, 1.0f, 0.1f);
+    tc::TAutoPtr<CExprNode> expr = new CExprNode(program, { slider.Get() });
+    REQUIRE(expr->Result.GetValue(0.0f) == Approx(2.0f * std::sin(0.5f) + 49.0f));
+
+    // Changing the slider evaluates the expression right away
+    slider->SetValue(1.0f);
+    REQUIRE(!expr->Result.IsDirty());
+    REQUIRE(expr->Result.GetValue(0.0f) == Approx(2.0f * std::sin(1.0f) + 49.0f));
+}
@@ -0,0 +1,125 @@
+#include "Parsing/SourceManager.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+using namespace Nome;
+
+// Everything the two parsers produce for a file: the AST dump plus every token and its location
+struct CParseOutput
+{
+    bool bSucceeded;
+    std::string Dump;
+    std::string Tokens;
+};
+
+CParseOutput Parse(const std::string& path, EParserKind kind)
+{
+    CSourceManager sourceMgr(path);
+    sourceMgr.SetPrintAST(false);
+    sourceMgr.SetParserKind(kind);
+    CParseOutput output;
+    output.bSucceeded = sourceMgr.ParseMainSource();
+
+    auto* file = sourceMgr.GetASTContext().GetAstRoot();
+    std::ostringstream dump;
+    dump << *file;
+    output.Dump = dump.str();
+    std::ostringstream tokens;
+    for (auto* command : file->GetCommands())
+    {
+        std::vector<AST::CToken*> tokenList;
+        command->CollectTokens(tokenList);
+        for (auto* token : tokenList)
+            tokens << token->GetText() << "@" << token->GetLocation().Start << " ";
+        tokens << "\n";
+    }
+    output.Tokens = tokens.str();
+    return output;
+}
+
+// Examples with syntax errors. ANTLR repairs the failed command in place while the fast parser
+//  drops it, see CSourceManager::SetParserKind, so only the failure itself has to agree.
+const std::set<std::string> ExamplesWithErrors = { "bank_sphere.nom", "hw1.nom",
+                                                   "olympictorus.nom", "torusknot.nom" };
+
+void RequireSameParse(const std::string& path, bool bHasErrors = false)
+{
+    INFO(path);
+    auto antlr = Parse(path, EParserKind::Antlr);
+    auto fast = Parse(path, EParserKind::Fast);
+    REQUIRE(antlr.bSucceeded == !bHasErrors);
+    REQUIRE(fast.bSucceeded == antlr.bSucceeded);
+    if (!bHasErrors)
+    {
+        REQUIRE(fast.Dump == antlr.Dump);
+        REQUIRE(fast.Tokens == antlr.Tokens);
+    }
+}
+
+}
+
+TEST_CASE("Fast parser matches the ANTLR parser on the examples")
+{
+    int numFiles = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(NOME_EXAMPLE_DIR))
+    {
+        if (entry.path().extension() != ".nom")
+            continue;
+        auto fileName = entry.path().filename().string();
+        RequireSameParse(entry.path().string(), ExamplesWithErrors.count(fileName) > 0);
+        numFiles++;
+    }
+    REQUIRE(numFiles > static_cast<int>(ExamplesWithErrors.size()));
+}
+
+TEST_CASE("Fast parser settles ambiguous lists like ANTLR")
+{
+    const char* source = "point a (0 -1 0) endpoint\n"
+                         "point b (x -y (z) -w) endpoint\n"
+                         "point c (-x+y 2^3^2 sin(1)) endpoint\n"
+                         "bank s set a 1 -5 5 1 set b 2 0 1 0.1 endbank\n"
+                         "instance i a rotate (0 0 1) (-45) translate (1 -2 3) endinstance\n";
+    std::string path = "test_fast_parser.nom";
+    std::ofstream(path) << source;
+    RequireSameParse(path);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Parallel parsing builds the same AST as the fast parser")
+{
+    std::ostringstream ss;
+    ss << "bank s set h 1 -5 5 0.1 endbank\n";
+    for (int i = 0; i < 1000; i++)
+        ss << "point p" << i << " (" << i << " -" << i << "*0.5 {expr $s.h}) endpoint\n"
+           << "mesh m" << i << " face f (p0 p1 p2) surface red endface face g (a b c) endface "
+           << "endmesh\n"
+           << "group g" << i << " instance i m" << i << " surface red endinstance "
+           << "group h instance j m0 endinstance endgroup endgroup\n"
+           << "(* " << i << " *) delete face a.f endface enddelete # comment\n";
+    std::string source = ss.str();
+    // An error anywhere makes it parse serially
+    std::string broken = source;
+    broken.insert(broken.size() / 2, " point oops ( endpoint\n");
+
+    for (const auto& text : { source, broken })
+    {
+        std::string path = "test_parallel_parser.nom";
+        std::ofstream(path) << text;
+        auto fast = Parse(path, EParserKind::Fast);
+        auto parallel = Parse(path, EParserKind::Parallel);
+        std::remove(path.c_str());
+        REQUIRE(parallel.bSucceeded == fast.bSucceeded);
+        REQUIRE(parallel.Dump == fast.Dump);
+        REQUIRE(parallel.Tokens == fast.Tokens);
+    }
+}
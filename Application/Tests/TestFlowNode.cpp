@@ -1,3 +1,4 @@
+#include "Flow/Arithmetics.h"
 #include "Flow/FlowNode.h"
 
 #include "catch.hpp"
@@ -31,3 +32,62 @@ TEST_CASE("FlowNode specializations")
 
     REQUIRE(target);
 }
+
+TEST_CASE("FlowNode disconnecting keeps the other connections")
+{
+    using namespace Flow;
+    using tc::TAutoPtr;
+
+    int notified[3] = {};
+    TAutoPtr<CFlowNode> flowNode = new CFlowNode();
+    TOutput<void> Signal(flowNode, {});
+    Signal.SetUpdateRoutine([&]() { Signal.UnmarkDirty(); });
+    TInput<void> Slot0(flowNode, [&]() { notified[0]++; });
+    TInput<void> Slot1(flowNode, [&]() { notified[1]++; });
+    TInput<void> Slot2(flowNode, [&]() { notified[2]++; });
+    Signal.Connect(Slot0);
+    Signal.Connect(Slot1);
+    Signal.Connect(Slot2);
+
+    Slot0.Disconnect();
+    REQUIRE(Signal.CountConnections() == 2);
+
+    Signal.Update();
+    Signal.MarkDirty();
+    REQUIRE(notified[0] == 1);
+    REQUIRE(notified[1] == 2);
+    REQUIRE(notified[2] == 2);
+}
+
+TEST_CASE("FlowNode dirty propagation down a long chain")
+{
+    using namespace Flow;
+    using tc::TAutoPtr;
+
+    // Deep enough to overflow the stack if each node recursed into the next
+    const int length = 100000;
+    TAutoPtr<CFloatNumber> source = new CFloatNumber(1.0f);
+    std::vector<TAutoPtr<CFloatNeg>> chain;
+    TOutput<float>* prev = &source->Value;
+    for (int i = 0; i < length; i++)
+    {
+        chain.push_back(new CFloatNeg());
+        prev->Connect(chain.back()->Operand0);
+        prev = &chain.back()->Result;
+    }
+
+    // Pulling values is still recursive, so evaluate front to back
+    for (auto& node : chain)
+        node->Result.GetValue(0.0f);
+    REQUIRE(!chain.back()->Result.IsDirty());
+
+    source->SetNumber(2.0f);
+    REQUIRE(chain.back()->Result.IsDirty());
+    for (auto& node : chain)
+        node->Result.GetValue(0.0f);
+    REQUIRE(chain.back()->Result.GetValue(0.0f) == 2.0f);
+
+    // Each node holds a reference to the one before, release back to front for the same reason
+    while (!chain.empty())
+        chain.pop_back();
+}
@@ -0,0 +1,100 @@
+#include "Parsing/SourceManager.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+
+const char* Source = "point a (0 0 0) endpoint\n"
+                     "point b (1 0 0) endpoint\n"
+                     "(* point c (2 0 0) endpoint *)\n"
+                     "polyline line (a b) endpolyline\n";
+
+std::string ReplaceFirst(std::string text, const std::string& from, const std::string& to)
+{
+    text.replace(text.find(from), from.size(), to);
+    return text;
+}
+
+}
+
+TEST_CASE("Incremental reparse only touches the edited command")
+{
+    using namespace Nome;
+
+    std::string path = "test_incremental_parse.nom";
+    std::ofstream(path) << Source;
+    CSourceManager sourceMgr(path);
+    sourceMgr.SetPrintAST(false);
+    REQUIRE(sourceMgr.ParseMainSource());
+    auto* file = sourceMgr.GetASTContext().GetAstRoot();
+    auto before = file->GetCommands();
+    REQUIRE(before.size() == 3);
+
+    SECTION("Edit inside a command")
+    {
+        std::string newText = ReplaceFirst(Source, "(1 0 0)", "(1 2 0)");
+        auto result = sourceMgr.ReparseText(newText);
+        REQUIRE(result);
+        REQUIRE(result->RemovedCommands.size() == 1);
+        REQUIRE(result->RemovedCommands[0] == before[1]);
+        REQUIRE(result->AddedCommands.size() == 1);
+        REQUIRE(result->AddedCommands[0]->GetName() == "b");
+        REQUIRE(file->GetCommands()[0] == before[0]);
+        REQUIRE(file->GetCommands()[2] == before[2]);
+        REQUIRE(sourceMgr.CollectText() == newText);
+
+        // Tokens of the new command must point at the new text
+        auto* token = result->AddedCommands[0]->GetCloseToken();
+        auto loc = token->GetLocation();
+        auto offset = sourceMgr.BufOffsetToGlobal(loc.BufId, loc.Start);
+        REQUIRE(offset);
+        REQUIRE(newText.substr(*offset, token->ToString().size()) == "endpoint");
+    }
+
+    SECTION("Uncommenting brings a command back")
+    {
+        std::string newText = ReplaceFirst(ReplaceFirst(Source, "(* ", ""), " *)", "");
+        auto result = sourceMgr.ReparseText(newText);
+        REQUIRE(result);
+        REQUIRE(result->RemovedCommands.empty());
+        REQUIRE(result->AddedCommands.size() == 1);
+        REQUIRE(result->AddedCommands[0]->GetName() == "c");
+        REQUIRE(file->GetCommands().size() == 4);
+    }
+
+    SECTION("Broken edits change nothing")
+    {
+        std::string newText = ReplaceFirst(Source, "endpolyline", "endpoly");
+        REQUIRE(!sourceMgr.ReparseText(newText));
+        REQUIRE(sourceMgr.CollectText() == Source);
+        REQUIRE(file->GetCommands() == before);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Token text views the source across non-ASCII text")
+{
+    using namespace Nome;
+
+    std::string text = "(* caf\xc3\xa9 *)\npoint a (0 0 0) endpoint\n";
+    std::string path = "test_arena_parse.nom";
+    std::ofstream(path) << text;
+    CSourceManager sourceMgr(path);
+    sourceMgr.SetPrintAST(false);
+    REQUIRE(sourceMgr.ParseMainSource());
+    auto* cmd = sourceMgr.GetASTContext().GetAstRoot()->GetCommands()[0];
+    REQUIRE(cmd->GetName() == "a");
+    auto* token = cmd->GetCloseToken();
+    REQUIRE(token->GetText() == "endpoint");
+    REQUIRE(text.substr(token->GetLocation().Start, 8) == "endpoint");
+
+    // Parsing again releases the old AST wholesale and starts over
+    REQUIRE(sourceMgr.ParseMainSource());
+    REQUIRE(sourceMgr.GetASTContext().GetAstRoot()->GetCommands().size() == 1);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,60 @@
+#include "QtFrontend/MeshToQGeometry.h"
+
+#include "catch.hpp"
+
+#include <Qt3DCore/QNode>
+#include <Qt3DRender/QBuffer>
+
+namespace
+{
+
+Nome::CMeshImpl MakeQuad(float size)
+{
+    Nome::CMeshImpl mesh;
+    mesh.request_vertex_colors();
+    std::vector<Nome::CMeshImpl::VertexHandle> verts = {
+        mesh.add_vertex({ 0.0f, 0.0f, 0.0f }), mesh.add_vertex({ size, 0.0f, 0.0f }),
+        mesh.add_vertex({ size, size, 0.0f }), mesh.add_vertex({ 0.0f, size, 0.0f })
+    };
+    mesh.add_face(verts);
+    for (auto vH : verts)
+        mesh.set_color(vH, { 255, 255, 255 });
+    return mesh;
+}
+
+QByteArray GetVertexData(Qt3DRender::QGeometry* geometry)
+{
+    for (auto* attr : geometry->attributes())
+        if (attr->attributeType() == Qt3DRender::QAttribute::VertexAttribute)
+            return attr->buffer()->data();
+    return {};
+}
+
+}
+
+TEST_CASE("Geometry updates in place without the converter making geometry of its own")
+{
+    using namespace Nome;
+
+    // Owns the geometries like the viewer's entities do, and outlives the converter
+    Qt3DCore::QNode owner;
+    auto small = MakeQuad(1.0f);
+    CMeshToQGeometry first(small, true);
+    auto* geometry = first.GetGeometry();
+    auto* pointGeometry = first.GetPointGeometry();
+    geometry->setParent(&owner);
+    pointGeometry->setParent(&owner);
+    auto before = GetVertexData(geometry);
+
+    {
+        // Never asked for geometry, so its destructor has nothing of its own to delete
+        auto large = MakeQuad(2.0f);
+        CMeshToQGeometry second(large, true);
+        second.UpdateGeometry(geometry);
+        second.UpdatePointGeometry(pointGeometry);
+    }
+
+    auto after = GetVertexData(geometry);
+    REQUIRE(after.size() == before.size());
+    REQUIRE(after != before);
+}
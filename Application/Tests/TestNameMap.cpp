@@ -0,0 +1,40 @@
+#include "Scene/NameMap.h"
+
+#include "catch.hpp"
+
+#include <string>
+
+TEST_CASE("Name maps find names by hash and ranges by prefix")
+{
+    using namespace Nome::Scene;
+    TNameMap<int> map;
+    for (int i = 0; i < 100000; i++)
+        map.Insert("e" + std::to_string(i), i);
+    map.Insert("m", -1);
+    map.Insert("m.f1", -2);
+    map.Insert("m.f2", -3);
+    REQUIRE(map.GetSize() == 100003);
+    REQUIRE(*map.FindValue("e12345") == 12345);
+    REQUIRE(!map.FindValue("e100000"));
+    REQUIRE(TNameMap<int>::Hash("m.f1") == "m.f1"_hash);
+
+    auto children = map.FindWithPrefix("m");
+    REQUIRE(children.size() == 3);
+    REQUIRE(map.GetName(children[1]) == "m.f1");
+
+    // Ids stay put through renames, and freed ones are handed out again
+    uint32_t id = map.Find("m.f1");
+    REQUIRE(map.Rename(id, "n.f1"));
+    REQUIRE(!map.Rename(id, "m.f2"));
+    REQUIRE(map.Find("n.f1") == id);
+    REQUIRE(map.FindWithPrefix("m").size() == 2);
+    for (uint32_t erased : map.FindWithPrefix("e1"))
+        map.EraseId(erased);
+    REQUIRE(map.GetSize() == 100003 - 11111);
+    REQUIRE(!map.FindValue("e1"));
+    REQUIRE(*map.FindValue("e2") == 2);
+    map.Insert("e1", 1);
+    REQUIRE(map.FindWithPrefix("e1").size() == 1);
+    REQUIRE(map.Insert("e1", 10) == map.Find("e1"));
+    REQUIRE(*map.FindValue("e1") == 10);
+}
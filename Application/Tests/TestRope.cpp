@@ -0,0 +1,44 @@
+#include "Parsing/Rope.h"
+
+#include "catch.hpp"
+
+#include <string>
+
+TEST_CASE("Rope edits, lines and anchors")
+{
+    using namespace Nome;
+
+    // Large enough to span several levels of the tree
+    std::string text;
+    for (int i = 0; i < 20000; i++)
+        text += "point p" + std::to_string(i) + " (0 0 0) endpoint\n";
+    CRope rope(text);
+    REQUIRE(rope.GetSize() == text.size());
+    REQUIRE(rope.GetLineCount() == 20001);
+
+    size_t line = 12345;
+    size_t lineStart = rope.LineToOffset(line);
+    REQUIRE(text.compare(lineStart, 13, "point p12345 ") == 0);
+    REQUIRE(rope.OffsetToLine(lineStart) == line);
+    REQUIRE(rope.OffsetToLine(lineStart - 1) == line - 1);
+
+    auto before = rope.CreateAnchor(lineStart - 1);
+    auto at = rope.CreateAnchor(lineStart);
+    auto erased = rope.CreateAnchor(lineStart + 8);
+
+    rope.Insert(lineStart, "(* note *)\n");
+    text.insert(lineStart, "(* note *)\n");
+    rope.Erase(lineStart + 11, 13);
+    text.erase(lineStart + 11, 13);
+
+    REQUIRE(rope.Assemble() == text);
+    REQUIRE(rope.GetLineCount() == 20002);
+    REQUIRE(rope.GetAnchorOffset(before) == lineStart - 1);
+    REQUIRE(rope.GetAnchorOffset(at) == lineStart + 11);
+    REQUIRE(rope.GetAnchorOffset(erased) == lineStart + 11);
+    REQUIRE(rope.Substr(rope.GetAnchorOffset(at), 7) == "(0 0 0)");
+
+    rope.Erase(0, rope.GetSize());
+    REQUIRE(rope.GetSize() == 0);
+    REQUIRE(rope.GetAnchorOffset(before) == 0);
+}
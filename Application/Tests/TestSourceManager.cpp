@@ -0,0 +1,51 @@
+#include "Parsing/SourceManager.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+TEST_CASE("Appending 100k commands keeps the piece table consistent")
+{
+    using namespace Nome;
+
+    std::string path = "test_source_manager.nom";
+    std::ofstream(path) << "point origin (0 0 0) endpoint\n";
+    CSourceManager sourceMgr(path);
+    sourceMgr.SetPrintAST(false);
+    REQUIRE(sourceMgr.ParseMainSource());
+    auto& ctx = sourceMgr.GetASTContext();
+
+    const size_t count = 100000;
+    AST::CToken* middleToken = nullptr;
+    for (size_t i = 0; i < count; i++)
+    {
+        auto* cmd = ctx.Make<AST::ACommand>(ctx.MakeToken("point"), ctx.MakeToken("endpoint"));
+        cmd->PushPositionalArgument(ctx.MakeIdent("p" + std::to_string(i)));
+        REQUIRE(sourceMgr.AppendCmdEndOfFile(cmd));
+        if (i == count / 2)
+            middleToken = cmd->GetCloseToken();
+    }
+
+    std::string text = sourceMgr.CollectText();
+    REQUIRE(sourceMgr.GetASTContext().GetAstRoot()->GetCommands().size() == count + 1);
+    REQUIRE(text.substr(text.size() - 23) == "\npoint p99999 endpoint\n");
+
+    auto loc = middleToken->GetLocation();
+    auto offset = sourceMgr.BufOffsetToGlobal(loc.BufId, loc.Start);
+    REQUIRE(offset);
+    REQUIRE(text.substr(*offset - 7, 15) == "p50000 endpoint");
+    auto bufOffset = sourceMgr.GlobalToBufOffset(*offset);
+    REQUIRE(bufOffset.first == CSourceManager::AddBuf);
+    REQUIRE(bufOffset.second == loc.Start);
+
+    // Cutting a command out of the middle shifts everything after it
+    size_t cmdBegin = text.find("\npoint p50000");
+    sourceMgr.RemoveText(cmdBegin, 22);
+    text.erase(cmdBegin, 22);
+    REQUIRE(!sourceMgr.BufOffsetToGlobal(loc.BufId, loc.Start));
+    REQUIRE(sourceMgr.CollectText() == text);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,45 @@
+#include "Scene/Tessellation.h"
+
+#include "catch.hpp"
+
+#include <cmath>
+
+TEST_CASE("Tessellation keeps the chordal error and never refines past the nom file")
+{
+    using namespace Nome::Scene;
+
+    const float twoPi = 6.2831853f;
+    int segs = CTessellation::SegmentsForChordError(1.0f, twoPi, 0.01f);
+    // The bulge of one segment stays within the error, one segment fewer would not
+    REQUIRE(1.0f - std::cos(twoPi / static_cast<float>(segs) / 2.0f) <= 0.01f);
+    REQUIRE(1.0f - std::cos(twoPi / static_cast<float>(segs - 1) / 2.0f) > 0.01f);
+
+    REQUIRE(CTessellation::GetLODSegments(64, 1.0f, twoPi, 0) == 64);
+    REQUIRE(CTessellation::GetLODSegments(8, 1.0f, twoPi, 1) == 8);
+    int previous = 1000;
+    for (int level = 1; level <= CTessellation::MaxLODLevel; level++)
+    {
+        int lodSegs = CTessellation::GetLODSegments(1000, 1.0f, twoPi, level);
+        REQUIRE(lodSegs < previous);
+        REQUIRE(lodSegs >= 3);
+        previous = lodSegs;
+    }
+
+    REQUIRE(CTessellation::PickLevel(0.0f) == 0);
+    REQUIRE(CTessellation::PickLevel(CTessellation::GetChordError(2)) == 2);
+    REQUIRE(CTessellation::PickLevel(1.0e6f) == CTessellation::MaxLODLevel);
+    // Farther away a pixel covers more
+    REQUIRE(CTessellation::GetPixelSize(10.0f, 45.0f, 720.0f)
+            > CTessellation::GetPixelSize(1.0f, 45.0f, 720.0f));
+}
+
+TEST_CASE("Trig tables are shared per sweep")
+{
+    using namespace Nome::Scene;
+
+    auto table = CTessellation::GetTrigTable(16, 0.5f, 0.25f);
+    REQUIRE(table->Sin.size() == 17);
+    REQUIRE(std::abs(table->Cos[4] - std::cos(1.5f)) < 1e-6f);
+    REQUIRE(table == CTessellation::GetTrigTable(16, 0.5f, 0.25f));
+    REQUIRE(table != CTessellation::GetTrigTable(16, 0.5f, 0.5f));
+}
@@ -0,0 +1,183 @@
+#include "ThreadPool.h"
+#include "ThreadName.h"
+#include <algorithm>
+#include <string>
+
+namespace tc
+{
+
+// Index of the queue owned by the current thread, 0 for threads outside the pool
+static thread_local size_t CurrentQueueIndex = 0;
+static thread_local const FThreadPool* CurrentPool = nullptr;
+
+FThreadPool::FThreadPool(unsigned int numWorkers)
+{
+    if (numWorkers == 0)
+    {
+        unsigned int hw = std::thread::hardware_concurrency();
+        numWorkers = hw > 1 ? hw - 1 : 1;
+    }
+
+    for (unsigned int i = 0; i <= numWorkers; i++)
+        Queues.emplace_back(new FTaskQueue);
+    for (unsigned int i = 0; i < numWorkers; i++)
+        Workers.emplace_back([this, i]() { WorkerMain(i + 1); });
+}
+
+FThreadPool::~FThreadPool()
+{
+    WaitIdle();
+    {
+        std::lock_guard<std::mutex> lock(WakeMutex);
+        bStopping = true;
+    }
+    WakeCondition.notify_all();
+    for (auto& worker : Workers)
+        worker.join();
+}
+
+void FThreadPool::Submit(std::function<void()> task)
+{
+    size_t index = CurrentPool == this
+        ? CurrentQueueIndex
+        : ExternalSubmitCount.fetch_add(1, std::memory_order_relaxed) % Queues.size();
+    PendingTasks.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<FSpinLock> lock(Queues[index]->Lock);
+        Queues[index]->Tasks.push_back(std::move(task));
+    }
+    // Taking the mutex orders the push against a worker about to sleep
+    {
+        std::lock_guard<std::mutex> lock(WakeMutex);
+    }
+    WakeCondition.notify_one();
+}
+
+void FThreadPool::WaitIdle()
+{
+    std::function<void()> task;
+    while (PendingTasks.load(std::memory_order_acquire) != 0)
+    {
+        if (PopOrSteal(CurrentPool == this ? CurrentQueueIndex : 0, task))
+            RunTask(task);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void FThreadPool::ParallelFor(size_t numItems, size_t grainSize,
+                              const std::function<void(size_t, size_t)>& func)
+{
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t numChunks = (numItems + grainSize - 1) / grainSize;
+    if (numChunks <= 1 || Workers.empty())
+    {
+        if (numItems > 0)
+            func(0, numItems);
+        return;
+    }
+
+    // Helpers may start after the loop is over, they only look at func once they got a range
+    struct FLoop
+    {
+        std::atomic<size_t> NextChunk { 0 };
+        std::atomic<size_t> DoneChunks { 0 };
+        size_t NumItems;
+        size_t GrainSize;
+        size_t NumChunks;
+        const std::function<void(size_t, size_t)>* Func;
+    };
+    auto loop = std::make_shared<FLoop>();
+    loop->NumItems = numItems;
+    loop->GrainSize = grainSize;
+    loop->NumChunks = numChunks;
+    loop->Func = &func;
+    auto runChunks = [](FLoop& state) {
+        size_t chunk;
+        while ((chunk = state.NextChunk.fetch_add(1, std::memory_order_relaxed)) < state.NumChunks)
+        {
+            size_t begin = chunk * state.GrainSize;
+            (*state.Func)(begin, std::min(begin + state.GrainSize, state.NumItems));
+            state.DoneChunks.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    size_t numHelpers = std::min<size_t>(numChunks - 1, Workers.size());
+    for (size_t i = 0; i < numHelpers; i++)
+        Submit([loop, runChunks]() { runChunks(*loop); });
+    runChunks(*loop);
+    while (loop->DoneChunks.load(std::memory_order_acquire) != numChunks)
+        std::this_thread::yield();
+}
+
+FThreadPool& FThreadPool::Get()
+{
+    static FThreadPool pool;
+    return pool;
+}
+
+bool FThreadPool::PopOrSteal(size_t home, std::function<void()>& task)
+{
+    {
+        FTaskQueue& own = *Queues[home];
+        std::lock_guard<FSpinLock> lock(own.Lock);
+        if (!own.Tasks.empty())
+        {
+            task = std::move(own.Tasks.back());
+            own.Tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < Queues.size(); i++)
+    {
+        FTaskQueue& victim = *Queues[(home + i) % Queues.size()];
+        std::lock_guard<FSpinLock> lock(victim.Lock);
+        if (!victim.Tasks.empty())
+        {
+            task = std::move(victim.Tasks.front());
+            victim.Tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void FThreadPool::RunTask(std::function<void()>& task)
+{
+    task();
+    task = nullptr;
+    PendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void FThreadPool::WorkerMain(size_t index)
+{
+    CurrentQueueIndex = index;
+    CurrentPool = this;
+    SetThreadName(("Worker" + std::to_string(index)).c_str());
+
+    std::function<void()> task;
+    while (true)
+    {
+        if (PopOrSteal(index, task))
+        {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(WakeMutex);
+        if (bStopping)
+            return;
+        // Recheck under the mutex so that a concurrent Submit cannot be missed
+        bool bHasWork = false;
+        for (const auto& queue : Queues)
+        {
+            std::lock_guard<FSpinLock> queueLock(queue->Lock);
+            bHasWork = bHasWork || !queue->Tasks.empty();
+        }
+        if (!bHasWork)
+            WakeCondition.wait(lock);
+    }
+}
+
+}
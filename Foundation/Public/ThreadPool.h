@@ -0,0 +1,67 @@
+#pragma once
+#include "FoundationAPI.h"
+#include "SpinLock.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tc
+{
+
+// A work-stealing thread pool. Every worker owns a deque: it pops its own work from the back and
+// steals from the front of the others when it runs dry.
+class FOUNDATION_API FThreadPool
+{
+public:
+    // Zero means one worker per hardware thread, minus the caller who helps in WaitIdle
+    explicit FThreadPool(unsigned int numWorkers = 0);
+    ~FThreadPool();
+
+    FThreadPool(const FThreadPool&) = delete;
+    FThreadPool& operator=(const FThreadPool&) = delete;
+
+    // Tasks submitted from a worker go onto that worker's own deque
+    void Submit(std::function<void()> task);
+
+    // Runs tasks on the calling thread until every submitted task has finished
+    void WaitIdle();
+
+    // Calls func on consecutive ranges of at most grainSize items until all are covered. The
+    //  caller takes ranges too and only waits for the ranges others are running, so unlike
+    //  WaitIdle this is safe from inside a task.
+    void ParallelFor(size_t numItems, size_t grainSize,
+                     const std::function<void(size_t, size_t)>& func);
+
+    unsigned int GetNumWorkers() const { return static_cast<unsigned int>(Workers.size()); }
+
+    // A process-wide pool shared by whoever needs one
+    static FThreadPool& Get();
+
+private:
+    struct FTaskQueue
+    {
+        FSpinLock Lock;
+        std::deque<std::function<void()>> Tasks;
+    };
+
+    bool PopOrSteal(size_t home, std::function<void()>& task);
+    void RunTask(std::function<void()>& task);
+    void WorkerMain(size_t index);
+
+    // Queue 0 is fed by non-worker threads, queue i + 1 belongs to worker i
+    std::vector<std::unique_ptr<FTaskQueue>> Queues;
+    std::vector<std::thread> Workers;
+
+    std::atomic<size_t> PendingTasks { 0 };
+    std::atomic<size_t> ExternalSubmitCount { 0 };
+    std::mutex WakeMutex;
+    std::condition_variable WakeCondition;
+    bool bStopping = false;
+};
+
+}